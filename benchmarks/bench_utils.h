@@ -0,0 +1,46 @@
+#ifndef LIBTENSOR_BENCH_UTILS_H
+#define LIBTENSOR_BENCH_UTILS_H
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/** \brief Wall clock stopwatch for benchmarks
+ **/
+class bench_timer {
+private:
+    std::chrono::steady_clock::time_point m_start;
+
+public:
+    bench_timer() : m_start(std::chrono::steady_clock::now()) { }
+
+    /** \brief Returns the number of seconds since construction
+     **/
+    double elapsed() const {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - m_start).count();
+    }
+};
+
+
+/** \brief Returns the integer command line argument i or the default
+ **/
+inline size_t bench_arg(int argc, char **argv, int i, size_t def) {
+    return argc > i ? size_t(atol(argv[i])) : def;
+}
+
+
+/** \brief Prints one line of benchmark results
+ **/
+inline void bench_report(const std::string &name, double t,
+    const std::string &extra = std::string()) {
+
+    std::cout << std::left << std::setw(48) << name << std::right
+        << std::setw(12) << std::fixed << std::setprecision(4) << t << " s";
+    if(!extra.empty()) std::cout << "  " << extra;
+    std::cout << std::endl;
+}
+
+#endif // LIBTENSOR_BENCH_UTILS_H
@@ -23,6 +23,18 @@ int main() {
 }
 " HAVE_PTHREADS_ADAPTIVE_MUTEX)
 
+check_cxx_source_compiles("
+#include <pthread.h>
+#include <sched.h>
+int main() {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if(sched_getaffinity(0, sizeof(mask), &mask) != 0) return 1;
+    CPU_SET(0, &mask);
+    return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+}
+" HAVE_PTHREAD_SETAFFINITY_NP)
+
 #
 #   Test built-in thread-local storage
 #
@@ -48,6 +48,19 @@ public:
     virtual const block_index_space<N> &get_bis() const;
     //@}
 
+    /** \brief Sets the compression policy for blocks created from now on
+            (\sa block_compression)
+     **/
+    void set_compression(const block_compression_policy &p) {
+        m_bt.set_compression(p);
+    }
+
+    /** \brief Returns the compression policy
+     **/
+    const block_compression_policy &get_compression() const {
+        return m_bt.get_compression();
+    }
+
 protected:
     //!    \name Implementation of libtensor::block_tensor_i<N, T>
     //@{
@@ -59,6 +72,8 @@ protected:
     virtual void on_ret_block(const index<N> &idx);
     virtual bool on_req_is_zero_block(const index<N> &idx);
     virtual void on_req_nonzero_blocks(std::vector<size_t> &nzlst);
+    virtual block_metadata<T> on_req_block_metadata(const index<N> &idx);
+    virtual size_t on_req_structure_version();
     virtual void on_req_zero_block(const index<N> &idx);
     virtual void on_req_zero_all_blocks();
     //@}
@@ -88,6 +103,7 @@ block_tensor<N, T, Alloc>::block_tensor(const block_tensor<N, T, Alloc> &bt) :
 
     m_bt(bt.get_bis()), m_ctrl(m_bt) {
 
+    m_bt.set_compression(bt.get_compression());
 }
 
 
@@ -164,6 +180,21 @@ void block_tensor<N, T, Alloc>::on_req_nonzero_blocks(
 }
 
 
+template<size_t N, typename T, typename Alloc>
+block_metadata<T> block_tensor<N, T, Alloc>::on_req_block_metadata(
+    const index<N> &idx) {
+
+    return m_ctrl.req_block_metadata(idx);
+}
+
+
+template<size_t N, typename T, typename Alloc>
+size_t block_tensor<N, T, Alloc>::on_req_structure_version() {
+
+    return m_ctrl.req_structure_version();
+}
+
+
 template<size_t N, typename T, typename Alloc>
 void block_tensor<N, T, Alloc>::on_req_zero_block(const index<N> &idx) {
 
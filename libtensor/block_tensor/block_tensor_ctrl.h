@@ -63,6 +63,8 @@ public:
     dense_tensor_rd_i<N, T> &req_const_block(const index<N> &idx);
     void ret_const_block(const index<N> &idx);
     bool req_is_zero_block(const index<N> &idx);
+    block_metadata<T> req_block_metadata(const index<N> &idx);
+    size_t req_structure_version();
     //@}
 
 };
@@ -197,6 +199,19 @@ inline bool block_tensor_rd_ctrl<N, T>::req_is_zero_block(const index<N> &idx) {
     return m_bt.on_req_is_zero_block(idx);
 }
 
+template<size_t N, typename T>
+inline block_metadata<T> block_tensor_rd_ctrl<N, T>::req_block_metadata(
+    const index<N> &idx) {
+
+    return m_bt.on_req_block_metadata(idx);
+}
+
+template<size_t N, typename T>
+inline size_t block_tensor_rd_ctrl<N, T>::req_structure_version() {
+
+    return m_bt.on_req_structure_version();
+}
+
 template<size_t N, typename T>
 inline dense_tensor_wr_i<N, T> &block_tensor_wr_ctrl<N, T>::req_block(
     const index<N> &idx) {
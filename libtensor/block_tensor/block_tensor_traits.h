@@ -2,6 +2,7 @@
 #define LIBTENSOR_BLOCK_TENSOR_TRAITS_H
 
 #include <libtensor/dense_tensor/dense_tensor.h>
+#include <libtensor/dense_tensor/tod_norm.h>
 #include "block_factory.h"
 #include "block_tensor_i_traits.h"
 
@@ -44,6 +45,12 @@ struct block_tensor_traits {
         typedef block_factory<N, T, typename block_type<N>::type> type;
     };
 
+    //! Type of operation that computes block metadata
+    template<size_t N>
+    struct block_norm_type {
+        typedef tod_norm<N> type;
+    };
+
 };
 
 
@@ -16,11 +16,47 @@ struct btod_contract2_clazz {
 };
 
 
+/** \brief Plan of the contraction of two block tensors
+    \tparam N Order of first tensor less degree of contraction.
+    \tparam M Order of second tensor less degree of contraction.
+    \tparam K Order of contraction.
+
+    \sa gen_bto_contract2_plan, btod_contract2
+
+    \ingroup libtensor_block_tensor_btod
+ **/
+template<size_t N, size_t M, size_t K>
+class btod_contract2_plan :
+    public gen_bto_contract2_plan<N, M, K, btod_traits> {
+
+public:
+    /** \brief Initializes an empty plan
+        \param keep_clst Whether to keep the lists of block contractions.
+     **/
+    btod_contract2_plan(bool keep_clst = true) :
+        gen_bto_contract2_plan<N, M, K, btod_traits>(keep_clst)
+    { }
+
+};
+
+
 /** \brief Computes the contraction of two block tensors
     \tparam N Order of first tensor less degree of contraction.
     \tparam M Order of second tensor less degree of contraction.
     \tparam K Order of contraction.
 
+    Contractions repeated with arguments of the same block structure, as in
+    iterative solvers, can share a plan (btod_contract2_plan) to skip
+    the symmetry and scheduling work after the first time.
+
+    \code
+    btod_contract2_plan<2, 2, 2> plan;
+    for(size_t iter = 0; iter < maxiter; iter++) {
+        btod_contract2<2, 2, 2>(contr, t2, ints, plan).perform(r2);
+        // ...
+    }
+    \endcode
+
     \sa gen_bto_contract2
 
     \ingroup libtensor_block_tensor_btod
@@ -73,6 +109,37 @@ public:
         double kb,
         double kc);
 
+    /** \brief Initializes the contraction operation using a plan
+        \param contr Contraction.
+        \param bta Block %tensor A (first argument).
+        \param btb Block %tensor B (second argument).
+        \param plan Plan of the contraction, reused if valid.
+    **/
+    btod_contract2(
+        const contraction2<N, M, K> &contr,
+        block_tensor_rd_i<NA, double> &bta,
+        block_tensor_rd_i<NB, double> &btb,
+        btod_contract2_plan<N, M, K> &plan);
+
+    /** \brief Initializes the contraction operation with scaling coefficients
+            using a plan
+        \param contr Contraction.
+        \param bta Block tensor A (first argument).
+        \param ka Scalar for A.
+        \param btb Block tensor B (second argument).
+        \param kb Scalar for B.
+        \param kc Scalar for result.
+        \param plan Plan of the contraction, reused if valid.
+    **/
+    btod_contract2(
+        const contraction2<N, M, K> &contr,
+        block_tensor_rd_i<NA, double> &bta,
+        double ka,
+        block_tensor_rd_i<NB, double> &btb,
+        double kb,
+        double kc,
+        btod_contract2_plan<N, M, K> &plan);
+
     /** \brief Virtual destructor
      **/
     virtual ~btod_contract2() { }
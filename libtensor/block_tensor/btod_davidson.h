@@ -0,0 +1,173 @@
+#ifndef LIBTENSOR_BTOD_DAVIDSON_H
+#define LIBTENSOR_BTOD_DAVIDSON_H
+
+#include <vector>
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/symmetry.h>
+#include "block_tensor_i.h"
+#include "btod_traits.h"
+
+namespace libtensor {
+
+
+/** \brief Davidson eigensolver for symmetric operators on block tensors
+    \tparam N Tensor order.
+
+    Finds the lowest eigenvalues and eigenvectors of a symmetric linear
+    operator \f$ A \f$ acting on block tensors. The product \f$ y = A x \f$
+    is supplied by the user as a callback (matvec_i), the correction vectors
+    are obtained from the residuals by a pluggable preconditioner
+    (precond_i, for example diag_precond).
+
+    The subspace vectors and their products are kept as block tensors with
+    the symmetry of the first guess vector. All vector operations of one
+    iteration that read the same vectors are fused: the projections of
+    a product onto all the subspace vectors are computed in one pass over
+    the blocks (btod_multi_dotprod), the residuals and Ritz vectors of all
+    the roots are formed in one pass over the subspace (btod_multi_axpy),
+    and new vectors are orthogonalized in place.
+
+    The product supplied by the callback must have the symmetry of the
+    vector or a subgroup of it. When the subspace exceeds its maximum size,
+    it is collapsed to the current Ritz vectors.
+
+    \ingroup libtensor_block_tensor_btod
+ **/
+template<size_t N>
+class btod_davidson :
+    public timings< btod_davidson<N> >,
+    public noncopyable {
+
+public:
+    static const char k_clazz[]; //!< Class name
+
+public:
+    typedef typename btod_traits::template temp_block_tensor_type<N>::type
+        vector_type;
+
+    /** \brief Matrix-vector product
+     **/
+    class matvec_i {
+    public:
+        virtual ~matvec_i() { }
+
+        /** \brief Computes \f$ y = A x \f$
+         **/
+        virtual void perform(block_tensor_rd_i<N, double> &x,
+            block_tensor_i<N, double> &y) = 0;
+    };
+
+    /** \brief Preconditioner
+     **/
+    class precond_i {
+    public:
+        virtual ~precond_i() { }
+
+        /** \brief Turns a residual into a correction vector in place
+            \param e Current eigenvalue estimate.
+            \param r Residual on input, correction on output.
+         **/
+        virtual void perform(double e, block_tensor_i<N, double> &r) = 0;
+    };
+
+    /** \brief Diagonal (Davidson) preconditioner
+            \f$ r_i \leftarrow r_i / (e - d_i) \f$
+
+        Denominators smaller in magnitude than the threshold are replaced
+        with the threshold of the same sign. The diagonal needs to have
+        the symmetry of the residual or a subgroup of it.
+     **/
+    class diag_precond : public precond_i {
+    private:
+        block_tensor_rd_i<N, double> &m_diag; //!< Diagonal of operator
+        double m_thresh; //!< Smallest denominator
+
+    public:
+        diag_precond(block_tensor_rd_i<N, double> &diag,
+            double thresh = 1e-4) :
+            m_diag(diag), m_thresh(thresh)
+        { }
+
+        virtual ~diag_precond() { }
+
+        virtual void perform(double e, block_tensor_i<N, double> &r);
+    };
+
+private:
+    matvec_i &m_a; //!< Matrix-vector product
+    precond_i &m_prec; //!< Preconditioner
+    size_t m_nroots; //!< Number of roots
+    size_t m_maxsub; //!< Maximum size of subspace
+    double m_tol; //!< Convergence threshold for residual norms
+    size_t m_maxiter; //!< Maximum number of iterations
+    std::vector<double> m_e; //!< Eigenvalues
+    std::vector<double> m_rnorm; //!< Residual norms
+    size_t m_niter; //!< Number of iterations done
+
+public:
+    /** \brief Initializes the solver
+        \param a Matrix-vector product.
+        \param prec Preconditioner.
+        \param nroots Number of lowest roots to find.
+        \param maxsub Maximum size of subspace (at least 2 * nroots).
+        \param tol Convergence threshold for the norms of residuals.
+        \param maxiter Maximum number of iterations.
+     **/
+    btod_davidson(matvec_i &a, precond_i &prec, size_t nroots,
+        size_t maxsub = 0, double tol = 1e-6, size_t maxiter = 100);
+
+    /** \brief Runs the iterations
+        \param x Guess vectors on input (at least nroots), eigenvectors on
+            output.
+        \return True if all the roots converged.
+     **/
+    bool solve(const std::vector<block_tensor_i<N, double>*> &x);
+
+    /** \brief Returns an eigenvalue
+     **/
+    double get_eigenvalue(size_t i) const {
+        return m_e.at(i);
+    }
+
+    /** \brief Returns the norm of the residual of a root
+     **/
+    double get_residual_norm(size_t i) const {
+        return m_rnorm.at(i);
+    }
+
+    /** \brief Returns the number of iterations done
+     **/
+    size_t get_niter() const {
+        return m_niter;
+    }
+
+private:
+    /** \brief Computes \f$ d_i = \langle v_i | w \rangle \f$ in one pass
+     **/
+    void dotprod(block_tensor_rd_i<N, double> &w,
+        const std::vector<block_tensor_rd_i<N, double>*> &v,
+        std::vector<double> &d);
+
+    /** \brief Computes \f$ y_k = \sum_j c_{kj} v_j \f$ (or adds it to
+            \f$ y_k \f$) in one pass
+     **/
+    void lincomb(const std::vector<block_tensor_rd_i<N, double>*> &v,
+        const std::vector<double> &c,
+        const std::vector<block_tensor_i<N, double>*> &y, bool add);
+
+    /** \brief Orthogonalizes w against orthonormal vectors in place and
+            normalizes it, returns the norm before normalization
+     **/
+    double orthonormalize(block_tensor_i<N, double> &w,
+        const std::vector<block_tensor_rd_i<N, double>*> &v);
+
+    vector_type *make_vector(const block_index_space<N> &bis,
+        const symmetry<N, double> &sym);
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_DAVIDSON_H
@@ -0,0 +1,163 @@
+#ifndef LIBTENSOR_BTOD_DENOM_DIV_H
+#define LIBTENSOR_BTOD_DENOM_DIV_H
+
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/scalar_transf_double.h>
+#include <libtensor/core/sequence.h>
+#include <libtensor/core/symmetry.h>
+#include <libtensor/block_tensor/btod_traits.h>
+#include <libtensor/gen_block_tensor/additive_gen_bto.h>
+#include <libtensor/gen_block_tensor/assignment_schedule.h>
+#include "block_tensor_i.h"
+
+namespace libtensor {
+
+
+/** \brief Divides a block tensor by an energy denominator formed from
+        vectors
+    \tparam N Tensor order.
+
+    Computes
+    \f[
+        b_{i_1 \ldots i_N} = \frac{\mathcal{T} a_{i_1 \ldots i_N}}
+            {c_1 d^{(1)}_{i_1} + \cdots + c_N d^{(N)}_{i_N} + s}
+    \f]
+    where \f$ \mathcal{T} \f$ is a tensor transformation of A and
+    \f$ d^{(k)} \f$ are one-index block tensors, one for each dimension of
+    the result, with coefficients. A typical use is the update of
+    amplitudes with orbital energies,
+    \f$ t_{ijab} = r_{ijab} / (e_i + e_j - e_a - e_b) \f$, with the vectors
+    (e_o, e_o, e_v, e_v) and the coefficients (1, 1, -1, -1).
+
+    The denominator is formed for each block on the fly, so unlike the
+    division by a tensor made by btod_dirsum (\sa btod_mult) no tensor of
+    the size of A is needed and the elements are visited only once.
+
+    The block index space of each vector has to agree with the respective
+    dimension of the result. The result has the symmetry of the transformed
+    A, so the denominator needs to be invariant under it (e.g. the same
+    vector for indexes that are permuted). Zero blocks of the vectors are
+    treated as vectors of zeros.
+
+    \ingroup libtensor_block_tensor_btod
+ **/
+template<size_t N>
+class btod_denom_div :
+    public additive_gen_bto<N, btod_traits::bti_traits>,
+    public timings< btod_denom_div<N> >,
+    public noncopyable {
+
+public:
+    static const char k_clazz[]; //!< Class name
+
+public:
+    typedef typename btod_traits::bti_traits bti_traits;
+
+private:
+    block_tensor_rd_i<N, double> &m_bta; //!< Argument (A)
+    tensor_transf<N, double> m_tra; //!< Transformation of A
+    sequence<N, block_tensor_rd_i<1, double>*> m_btd; //!< Vectors
+    sequence<N, double> m_cd; //!< Coefficients of vectors
+    double m_shift; //!< Shift of denominator
+    block_index_space<N> m_bisb; //!< Block index space of result
+    symmetry<N, double> m_symb; //!< Symmetry of result
+    assignment_schedule<N, double> m_sch; //!< Assignment schedule
+
+public:
+    /** \brief Initializes the operation
+        \param bta Argument A.
+        \param tra Transformation of A.
+        \param btd Vectors for each dimension of the result.
+        \param cd Coefficients of the vectors.
+        \param shift Shift of the denominator.
+     **/
+    btod_denom_div(
+        block_tensor_rd_i<N, double> &bta,
+        const tensor_transf<N, double> &tra,
+        const sequence<N, block_tensor_rd_i<1, double>*> &btd,
+        const sequence<N, double> &cd,
+        double shift = 0.0);
+
+    /** \brief Initializes the operation
+        \param bta Argument A.
+        \param btd Vectors for each dimension of the result.
+        \param cd Coefficients of the vectors.
+        \param shift Shift of the denominator.
+     **/
+    btod_denom_div(
+        block_tensor_rd_i<N, double> &bta,
+        const sequence<N, block_tensor_rd_i<1, double>*> &btd,
+        const sequence<N, double> &cd,
+        double shift = 0.0);
+
+    /** \brief Virtual destructor
+     **/
+    virtual ~btod_denom_div() { }
+
+    //! \name Implementation of libtensor::direct_gen_bto<N, bti_traits>
+    //@{
+
+    virtual const block_index_space<N> &get_bis() const {
+        return m_bisb;
+    }
+
+    virtual const symmetry<N, double> &get_symmetry() const {
+        return m_symb;
+    }
+
+    virtual const assignment_schedule<N, double> &get_schedule() const {
+        return m_sch;
+    }
+
+    virtual void perform(gen_block_stream_i<N, bti_traits> &out);
+
+    //@}
+
+    //! \name Implementation of libtensor::additive_gen_bto<N, bti_traits>
+    //@{
+
+    virtual void perform(gen_block_tensor_i<N, bti_traits> &btb);
+
+    virtual void perform(gen_block_tensor_i<N, bti_traits> &btb,
+        const scalar_transf<double> &c);
+
+    virtual void compute_block(
+        bool zero,
+        const index<N> &ib,
+        const tensor_transf<N, double> &trb,
+        dense_tensor_wr_i<N, double> &blkb);
+
+    virtual void compute_block(
+        const index<N> &ib,
+        dense_tensor_wr_i<N, double> &blkb) {
+
+        compute_block(true, ib, tensor_transf<N, double>(), blkb);
+    }
+
+    //@}
+
+    /** \brief Performs the operation
+        \param btb Result tensor.
+        \param c Coefficient of addition.
+     **/
+    void perform(block_tensor_i<N, double> &btb, double c);
+
+    /** \brief Computes one block of the result (without timers)
+     **/
+    void compute_block_untimed(
+        bool zero,
+        const index<N> &ib,
+        const tensor_transf<N, double> &trb,
+        dense_tensor_wr_i<N, double> &blkb);
+
+private:
+    void check_bis();
+    void make_schedule();
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_DENOM_DIV_H
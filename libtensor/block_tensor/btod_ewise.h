@@ -0,0 +1,159 @@
+#ifndef LIBTENSOR_BTOD_EWISE_H
+#define LIBTENSOR_BTOD_EWISE_H
+
+#include <vector>
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/scalar_transf_double.h>
+#include <libtensor/core/symmetry.h>
+#include <libtensor/block_tensor/btod_traits.h>
+#include <libtensor/gen_block_tensor/additive_gen_bto.h>
+#include <libtensor/gen_block_tensor/assignment_schedule.h>
+#include "block_tensor_i.h"
+
+namespace libtensor {
+
+
+/** \brief Evaluates a chain of element-wise operations in one pass
+    \tparam N Tensor order.
+
+    The operation computes an element-wise expression of several block
+    tensors, such as \f$ c = (a_1 + a_2) a_3 / a_4 \f$, block by block
+    without forming intermediate block tensors. The expression is given as
+    a program in postfix notation: k_arg pushes the next argument (in the
+    order given), k_add, k_mul and k_div replace the two topmost entries
+    of the stack with their sum, product or quotient. Each argument comes
+    with a tensor transformation that brings it to the index order of the
+    result; all the arguments need to have the same block index space after
+    the transformation.
+
+    For each block of the result every argument block is read once and the
+    result block is written once. The expression is evaluated over chunks of
+    elements that stay in cache, so the intermediate values never go to
+    memory. Arguments whose blocks need a permutation are first copied to
+    a temporary block.
+
+    The symmetry of the result is obtained from the symmetries of the
+    arguments following the operations, like in btod_add and btod_mult.
+    Zero blocks propagate through products and quotients. A zero block in
+    a denominator is an error.
+
+    \sa btod_add, btod_mult
+
+    \ingroup libtensor_block_tensor_btod
+ **/
+template<size_t N>
+class btod_ewise :
+    public additive_gen_bto<N, btod_traits::bti_traits>,
+    public timings< btod_ewise<N> >,
+    public noncopyable {
+
+public:
+    static const char k_clazz[]; //!< Class name
+
+    //! Instructions
+    enum {
+        k_arg, //!< Push next argument
+        k_add, //!< Add two topmost entries
+        k_mul, //!< Multiply two topmost entries
+        k_div //!< Divide second topmost by topmost entry
+    };
+
+public:
+    typedef typename btod_traits::bti_traits bti_traits;
+
+private:
+    std::vector<int> m_prog; //!< Program
+    std::vector<block_tensor_rd_i<N, double>*> m_bt; //!< Arguments
+    std::vector< tensor_transf<N, double> > m_tr; //!< Transformations
+    scalar_transf<double> m_c; //!< Scalar transformation of result
+    size_t m_depth; //!< Maximum depth of stack
+    block_index_space<N> m_bisb; //!< Block index space of result
+    symmetry<N, double> m_symb; //!< Symmetry of result
+    assignment_schedule<N, double> m_sch; //!< Assignment schedule
+
+public:
+    /** \brief Initializes the operation
+        \param prog Program in postfix notation.
+        \param bt Arguments in the order of k_arg instructions.
+        \param tr Transformations of the arguments.
+        \param c Scalar transformation of the result.
+     **/
+    btod_ewise(
+        const std::vector<int> &prog,
+        const std::vector<block_tensor_rd_i<N, double>*> &bt,
+        const std::vector< tensor_transf<N, double> > &tr,
+        const scalar_transf<double> &c = scalar_transf<double>());
+
+    /** \brief Virtual destructor
+     **/
+    virtual ~btod_ewise() { }
+
+    //! \name Implementation of libtensor::direct_gen_bto<N, bti_traits>
+    //@{
+
+    virtual const block_index_space<N> &get_bis() const {
+        return m_bisb;
+    }
+
+    virtual const symmetry<N, double> &get_symmetry() const {
+        return m_symb;
+    }
+
+    virtual const assignment_schedule<N, double> &get_schedule() const {
+        return m_sch;
+    }
+
+    virtual void perform(gen_block_stream_i<N, bti_traits> &out);
+
+    //@}
+
+    //! \name Implementation of libtensor::additive_gen_bto<N, bti_traits>
+    //@{
+
+    virtual void perform(gen_block_tensor_i<N, bti_traits> &btb);
+
+    virtual void perform(gen_block_tensor_i<N, bti_traits> &btb,
+        const scalar_transf<double> &c);
+
+    virtual void compute_block(
+        bool zero,
+        const index<N> &ib,
+        const tensor_transf<N, double> &trb,
+        dense_tensor_wr_i<N, double> &blkb);
+
+    virtual void compute_block(
+        const index<N> &ib,
+        dense_tensor_wr_i<N, double> &blkb) {
+
+        compute_block(true, ib, tensor_transf<N, double>(), blkb);
+    }
+
+    //@}
+
+    /** \brief Performs the operation
+        \param btb Result tensor.
+        \param c Coefficient of addition.
+     **/
+    void perform(block_tensor_i<N, double> &btb, double c);
+
+    /** \brief Computes one block of the result (without timers)
+     **/
+    void compute_block_untimed(
+        bool zero,
+        const index<N> &ib,
+        const tensor_transf<N, double> &trb,
+        dense_tensor_wr_i<N, double> &blkb);
+
+private:
+    void check_prog();
+    void check_bis();
+    void make_symmetry();
+    void make_schedule();
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_EWISE_H
@@ -0,0 +1,81 @@
+#ifndef LIBTENSOR_BTOD_MULTI_AXPY_H
+#define LIBTENSOR_BTOD_MULTI_AXPY_H
+
+#include <vector>
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include "block_tensor_i.h"
+
+namespace libtensor {
+
+
+/** \brief Forms many linear combinations of the same block tensors
+    \tparam N Tensor order.
+
+    Computes
+    \f[ y_k = \sum_j c_{kj} v_j \f]
+    for a series of results \f$ y_k \f$ with the coefficients given as
+    a row-major matrix, one row for each result. Each canonical block of
+    the arguments is read once and used for all the results, instead of
+    once per result as with a series of btod_add. The blocks are processed
+    in parallel.
+
+    The results get the symmetry of the first argument. All the tensors
+    need to have the same block index space, the arguments need to have
+    the same symmetry, and in the additive mode the results need to have
+    it too. The results may not be among the arguments.
+
+    \sa btod_multi_dotprod
+
+    \ingroup libtensor_block_tensor_btod
+ **/
+template<size_t N>
+class btod_multi_axpy :
+    public timings< btod_multi_axpy<N> >,
+    public noncopyable {
+
+public:
+    static const char k_clazz[]; //!< Class name
+
+private:
+    std::vector<block_tensor_rd_i<N, double>*> m_btv; //!< Arguments
+    std::vector<double> m_c; //!< Coefficients
+    size_t m_ny; //!< Number of results
+
+public:
+    /** \brief Initializes the operation
+        \param btv Arguments v_j.
+        \param c Coefficients c_kj (row-major, the size is a multiple of
+            the number of arguments).
+     **/
+    btod_multi_axpy(const std::vector<block_tensor_rd_i<N, double>*> &btv,
+        const std::vector<double> &c);
+
+    /** \brief Returns the number of results
+     **/
+    size_t get_nresults() const {
+        return m_ny;
+    }
+
+    /** \brief Computes the results
+        \param bty Results y_k.
+     **/
+    void perform(const std::vector<block_tensor_i<N, double>*> &bty);
+
+    /** \brief Adds the scaled linear combinations to the results
+        \param bty Results y_k.
+        \param d Scaling coefficient.
+     **/
+    void perform(const std::vector<block_tensor_i<N, double>*> &bty,
+        double d);
+
+private:
+    void do_perform(const std::vector<block_tensor_i<N, double>*> &bty,
+        bool zero, double d);
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_MULTI_AXPY_H
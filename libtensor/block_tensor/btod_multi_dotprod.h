@@ -0,0 +1,78 @@
+#ifndef LIBTENSOR_BTOD_MULTI_DOTPROD_H
+#define LIBTENSOR_BTOD_MULTI_DOTPROD_H
+
+#include <vector>
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include "block_tensor_i.h"
+
+namespace libtensor {
+
+
+/** \brief Computes the dot products of one block tensor with many others
+    \tparam N Tensor order.
+
+    Computes the slice of the Gram matrix
+    \f[ d_i = \langle v_i | w \rangle = \sum_j v_{i,j} w_j \f]
+    for a series of arguments \f$ v_i \f$. Unlike btod_dotprod, which
+    walks the orbits once for every argument pair, this operation visits
+    each canonical block of w once and reads the blocks of all the
+    arguments at this index together. The blocks are processed in parallel,
+    the partial sums are added up in a fixed order, so the result is
+    reproducible.
+
+    All the tensors need to have the same block index space and the same
+    symmetry. Permutations of the arguments are not supported.
+
+    \sa btod_multi_axpy
+
+    \ingroup libtensor_block_tensor_btod
+ **/
+template<size_t N>
+class btod_multi_dotprod :
+    public timings< btod_multi_dotprod<N> >,
+    public noncopyable {
+
+public:
+    static const char k_clazz[]; //!< Class name
+
+private:
+    block_tensor_rd_i<N, double> &m_btw; //!< Common argument (w)
+    std::vector<block_tensor_rd_i<N, double>*> m_btv; //!< Arguments (v_i)
+
+public:
+    /** \brief Initializes the operation
+        \param btw Common argument w.
+     **/
+    btod_multi_dotprod(block_tensor_rd_i<N, double> &btw) :
+        m_btw(btw)
+    { }
+
+    /** \brief Initializes the operation with a series of arguments
+        \param btw Common argument w.
+        \param btv Arguments v_i.
+     **/
+    btod_multi_dotprod(block_tensor_rd_i<N, double> &btw,
+        const std::vector<block_tensor_rd_i<N, double>*> &btv);
+
+    /** \brief Adds an argument
+     **/
+    void add_arg(block_tensor_rd_i<N, double> &btv);
+
+    /** \brief Returns the number of arguments
+     **/
+    size_t get_nargs() const {
+        return m_btv.size();
+    }
+
+    /** \brief Computes the dot products of w with all the arguments
+        \param d Dot products, one for each argument.
+     **/
+    void calculate(std::vector<double> &d);
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_MULTI_DOTPROD_H
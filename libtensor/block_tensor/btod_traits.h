@@ -54,6 +54,7 @@ struct btod_traits {
     template<size_t N, size_t M, size_t K>
     struct to_contract2_type {
         typedef tod_contract2<N, M, K> type;
+        typedef tod_contract2_batch<N, M, K> batch_type;
         typedef btod_contract2_clst_optimize<N, M, K> clst_optimize_type;
     };
 
@@ -48,6 +48,36 @@ public:
         return m_gbt.get_bis();
     }
 
+    /** \brief Sets the policy of the block cache
+     **/
+    void set_cache_policy(const direct_block_cache_policy &p) {
+        m_gbt.set_cache_policy(p);
+    }
+
+    /** \brief Returns the policy of the block cache
+     **/
+    direct_block_cache_policy get_cache_policy() {
+        return m_gbt.get_cache_policy();
+    }
+
+    /** \brief Discards all cached blocks
+     **/
+    void clear_cache() {
+        m_gbt.clear_cache();
+    }
+
+    /** \brief Returns the statistics of the block cache
+     **/
+    direct_block_cache_stats get_cache_stats() {
+        return m_gbt.get_cache_stats();
+    }
+
+    /** \brief Resets the statistics of the block cache
+     **/
+    void reset_cache_stats() {
+        m_gbt.reset_cache_stats();
+    }
+
 protected:
     //!    \name Implementation of libtensor::block_tensor_rd_i<N, T>
     //@{
@@ -72,6 +102,14 @@ protected:
         m_ctrl.ret_const_block(idx);
     }
 
+    virtual block_metadata<T> on_req_block_metadata(const index<N> &idx) {
+        return m_ctrl.req_block_metadata(idx);
+    }
+
+    virtual size_t on_req_structure_version() {
+        return m_ctrl.req_structure_version();
+    }
+
     //@}
 
     operation_t &get_op() {
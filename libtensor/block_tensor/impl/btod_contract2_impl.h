@@ -49,6 +49,39 @@ btod_contract2<N, M, K>::btod_contract2(
 }
 
 
+template<size_t N, size_t M, size_t K>
+btod_contract2<N, M, K>::btod_contract2(
+    const contraction2<N, M, K> &contr,
+    block_tensor_rd_i<NA, double> &bta,
+    block_tensor_rd_i<NB, double> &btb,
+    btod_contract2_plan<N, M, K> &plan) :
+
+    m_gbto(contr,
+        bta, scalar_transf<double>(),
+        btb, scalar_transf<double>(),
+        scalar_transf<double>(), plan) {
+
+}
+
+
+template<size_t N, size_t M, size_t K>
+btod_contract2<N, M, K>::btod_contract2(
+    const contraction2<N, M, K> &contr,
+    block_tensor_rd_i<NA, double> &bta,
+    double ka,
+    block_tensor_rd_i<NB, double> &btb,
+    double kb,
+    double kc,
+    btod_contract2_plan<N, M, K> &plan) :
+
+    m_gbto(contr,
+        bta, scalar_transf<double>(ka),
+        btb, scalar_transf<double>(kb),
+        scalar_transf<double>(kc), plan) {
+
+}
+
+
 template<size_t N, size_t M, size_t K>
 void btod_contract2<N, M, K>::perform(
     gen_block_stream_i<NC, bti_traits> &out) {
@@ -73,14 +106,8 @@ void btod_contract2<N, M, K>::perform(
     gen_block_tensor_i<NC, bti_traits> &btc,
     const scalar_transf<double> &d) {
 
-    typedef block_tensor_i_traits<double> bti_traits;
-
-    gen_block_tensor_rd_ctrl<NC, bti_traits> cc(btc);
-    std::vector<size_t> nzblkc;
-    cc.req_nonzero_blocks(nzblkc);
-    addition_schedule<NC, btod_traits> asch(get_symmetry(),
-        cc.req_const_symmetry());
-    asch.build(get_schedule(), nzblkc);
+    const addition_schedule<NC, btod_traits> &asch =
+        m_gbto.get_plan().req_addition_schedule(btc);
 
     gen_bto_aux_add<NC, btod_traits> out(get_symmetry(), asch, btc, d);
     out.open();
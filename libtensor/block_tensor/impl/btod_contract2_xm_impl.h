@@ -6,11 +6,13 @@
 #include <libtensor/gen_block_tensor/gen_bto_aux_copy.h>
 #include <libtensor/gen_block_tensor/impl/gen_bto_contract2_impl.h>
 #include <libtensor/linalg/BlasSequential.h>
+#include <chrono>
 #include <stdexcept>
 
 #include <libtensor/block_tensor/btod_contract2_xm.h>
 #include <libtensor/core/impl/xm_allocator.h>
 #include <libtensor/libxm/src/xm.h>
+#include "xm_mirror_cache.h"
 
 namespace libtensor {
 
@@ -100,6 +102,7 @@ void setup_input_tensor(struct xm_tensor* a, struct xm_allocator* allocator,
             dynamic_cast<dense_tensor<NA, double, libtensor::allocator<double> >&>(lt_blk)
                   .get_vm_ptr();
       memcpy(&data_ptr, &p, sizeof(data_ptr));
+      lt_xm_allocator::lt_xm_allocator<double>::expand(data_ptr);
       xm_tensor_set_canonical_block_raw(a, idx, data_ptr);
     }
     ctrl.ret_const_block(lt_absidx.get_index());
@@ -122,6 +125,45 @@ void setup_input_tensor(struct xm_tensor* a, struct xm_allocator* allocator,
   }
 }
 
+/** \brief Returns the libxm mirror of an argument, reuses the cached one
+        if the structure of the argument has not changed
+ **/
+template <size_t NA, typename bti_traits>
+xm_mirror_cache::mirror_ptr get_input_mirror(struct xm_allocator* allocator,
+                                             gen_block_tensor_rd_i<NA, bti_traits>& bta) {
+
+  size_t version;
+  {
+    gen_block_tensor_rd_ctrl<NA, bti_traits> ctrl(bta);
+    version = ctrl.req_structure_version();
+  }
+  bool cache = version != 0 && xm_mirror_cache::is_enabled();
+
+  xm_mirror_cache::mirror_ptr a;
+  if (cache) {
+    a = xm_mirror_cache::get_instance().find(&bta, version, allocator);
+    if (a) return a;
+  }
+
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+  xm_block_space_t* bsa = make_blockspace(bta);
+  a.reset(xm_tensor_create(bsa, XM_SCALAR_DOUBLE, allocator), xm_tensor_free);
+  xm_block_space_free(bsa);
+  if (!a) {
+    throw std::runtime_error("xm_tensor_create");
+  }
+  setup_input_tensor<NA, bti_traits>(a.get(), allocator, bta);
+
+  double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  if (cache) {
+    xm_mirror_cache::get_instance().insert(&bta, version, allocator, a, t);
+  } else {
+    xm_mirror_cache::get_instance().add_build_time(t);
+  }
+  return a;
+}
+
 template <size_t NA, typename bti_traits>
 void setup_output_tensor(struct xm_tensor* a, struct xm_allocator* allocator,
                          gen_block_tensor_i<NA, bti_traits>& bta) {
@@ -148,6 +190,7 @@ void setup_output_tensor(struct xm_tensor* a, struct xm_allocator* allocator,
             dynamic_cast<dense_tensor<NA, double, libtensor::allocator<double> >&>(lt_blk)
                   .get_vm_ptr();
       memcpy(&data_ptr, &p, sizeof(data_ptr));
+      lt_xm_allocator::lt_xm_allocator<double>::expand(data_ptr);
       xm_tensor_set_canonical_block_raw(a, idx, data_ptr);
     }
     ctrl.ret_block(lt_idx);
@@ -207,8 +250,8 @@ void btod_contract2_xm<N, M, K>::perform(gen_block_tensor_i<NC, bti_traits>& btc
   }
 
   xm_allocator_t* allocator;
-  xm_block_space_t *bsa, *bsb, *bsc;
-  xm_tensor_t *a, *b, *c;
+  xm_block_space_t* bsc;
+  xm_tensor_t* c;
   char idxbuf[32 * 3], *idxa, *idxb, *idxc;
   xm_scalar_type_t type = XM_SCALAR_DOUBLE;
 
@@ -256,40 +299,30 @@ void btod_contract2_xm<N, M, K>::perform(gen_block_tensor_i<NC, bti_traits>& btc
     idxc[NC - i - 1] = t;
   }
 
-  bsa = make_blockspace(m_bta);
-  bsb = make_blockspace(m_btb);
-  bsc = make_blockspace(btc);
+  // mirrors of a and b are kept between calls, c is set up every time
+  xm_mirror_cache::mirror_ptr a = get_input_mirror<NA, bti_traits>(allocator, m_bta);
+  xm_mirror_cache::mirror_ptr b = get_input_mirror<NB, bti_traits>(allocator, m_btb);
 
-  if ((a = xm_tensor_create(bsa, type, allocator)) == NULL) {
-    throw std::runtime_error("xm_tensor_create");
-  }
-  if ((b = xm_tensor_create(bsb, type, allocator)) == NULL) {
-    throw std::runtime_error("xm_tensor_create");
-  }
-  if ((c = xm_tensor_create(bsc, type, allocator)) == NULL) {
+  bsc = make_blockspace(btc);
+  c   = xm_tensor_create(bsc, type, allocator);
+  xm_block_space_free(bsc);
+  if (c == NULL) {
     throw std::runtime_error("xm_tensor_create");
   }
-  xm_block_space_free(bsa);
-  xm_block_space_free(bsb);
-  xm_block_space_free(bsc);
 
-  // setup tensor a
-  setup_input_tensor<NA, bti_traits>(a, allocator, m_bta);
-  // setup tensor b
-  setup_input_tensor<NB, bti_traits>(b, allocator, m_btb);
-  // setup tensor c
-  setup_output_tensor<NC, bti_traits>(c, allocator, btc);
+  try {
+    // setup tensor c
+    setup_output_tensor<NC, bti_traits>(c, allocator, btc);
 
-  {
     // set BLAS to sequential and contract
     BlasSequential seq;
     double alpha = m_ka.get_coeff() * m_kb.get_coeff() * m_kc.get_coeff();
-    xm_contract(alpha, a, b, 0.0, c, idxa, idxb, idxc);
+    xm_contract(alpha, a.get(), b.get(), 0.0, c, idxa, idxb, idxc);
+  } catch (...) {
+    xm_tensor_free(c);
+    throw;
   }
 
-  // free all
-  xm_tensor_free(a);
-  xm_tensor_free(b);
   xm_tensor_free(c);
 }
 
@@ -0,0 +1,418 @@
+#ifndef LIBTENSOR_BTOD_DAVIDSON_IMPL_H
+#define LIBTENSOR_BTOD_DAVIDSON_IMPL_H
+
+#include <algorithm>
+#include <cmath>
+#include <libtensor/exception.h>
+#include <libtensor/core/abs_index.h>
+#include <libtensor/dense_tensor/dense_tensor_ctrl.h>
+#include <libtensor/gen_block_tensor/gen_block_tensor_ctrl.h>
+#include <libtensor/symmetry/so_copy.h>
+#include "../block_tensor_ctrl.h"
+#include "../btod_multi_axpy.h"
+#include "../btod_multi_dotprod.h"
+#include "../btod_scale.h"
+#include "../btod_davidson.h"
+
+namespace libtensor {
+
+
+template<size_t N>
+const char btod_davidson<N>::k_clazz[] = "btod_davidson<N>";
+
+
+namespace {
+
+
+/** \brief Diagonalizes a small symmetric matrix by cyclic Jacobi rotations
+    \param n Size of matrix.
+    \param a Matrix (row-major), destroyed on output.
+    \param[out] e Eigenvalues in ascending order.
+    \param[out] s Eigenvectors in columns (row-major).
+ **/
+void btod_davidson_jacobi(size_t n, std::vector<double> &a,
+    std::vector<double> &e, std::vector<double> &s) {
+
+    s.assign(n * n, 0.0);
+    for(size_t i = 0; i < n; i++) s[i * n + i] = 1.0;
+
+    double anorm = 0.0;
+    for(size_t i = 0; i < n * n; i++) anorm += a[i] * a[i];
+
+    for(size_t sweep = 0; sweep < 100; sweep++) {
+
+        double off = 0.0;
+        for(size_t p = 0; p < n; p++) for(size_t q = p + 1; q < n; q++) {
+            off += a[p * n + q] * a[p * n + q];
+        }
+        if(off <= 1e-30 * anorm || off == 0.0) break;
+
+        for(size_t p = 0; p < n; p++) for(size_t q = p + 1; q < n; q++) {
+
+            double apq = a[p * n + q];
+            if(apq == 0.0) continue;
+            double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+            double t = (theta >= 0.0 ? 1.0 : -1.0) /
+                (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+            double c = 1.0 / std::sqrt(t * t + 1.0), sn = t * c;
+
+            for(size_t k = 0; k < n; k++) {
+                double akp = a[k * n + p], akq = a[k * n + q];
+                a[k * n + p] = c * akp - sn * akq;
+                a[k * n + q] = sn * akp + c * akq;
+            }
+            for(size_t k = 0; k < n; k++) {
+                double apk = a[p * n + k], aqk = a[q * n + k];
+                a[p * n + k] = c * apk - sn * aqk;
+                a[q * n + k] = sn * apk + c * aqk;
+            }
+            for(size_t k = 0; k < n; k++) {
+                double skp = s[k * n + p], skq = s[k * n + q];
+                s[k * n + p] = c * skp - sn * skq;
+                s[k * n + q] = sn * skp + c * skq;
+            }
+        }
+    }
+
+    //  Sort eigenpairs in ascending order
+
+    std::vector< std::pair<double, size_t> > ord(n);
+    for(size_t i = 0; i < n; i++) ord[i] = std::make_pair(a[i * n + i], i);
+    std::sort(ord.begin(), ord.end());
+    std::vector<double> s0(s);
+    e.resize(n);
+    for(size_t j = 0; j < n; j++) {
+        e[j] = ord[j].first;
+        for(size_t k = 0; k < n; k++) s[k * n + j] = s0[k * n + ord[j].second];
+    }
+}
+
+
+} // unnamed namespace
+
+
+template<size_t N>
+btod_davidson<N>::btod_davidson(matvec_i &a, precond_i &prec, size_t nroots,
+    size_t maxsub, double tol, size_t maxiter) :
+
+    m_a(a), m_prec(prec), m_nroots(nroots),
+    m_maxsub(maxsub == 0 ? std::max<size_t>(4 * nroots, 20) : maxsub),
+    m_tol(tol), m_maxiter(maxiter), m_niter(0) {
+
+    static const char method[] = "btod_davidson()";
+
+    if(nroots == 0) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "nroots");
+    }
+    if(m_maxsub < 2 * nroots) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "maxsub");
+    }
+}
+
+
+template<size_t N>
+bool btod_davidson<N>::solve(
+    const std::vector<block_tensor_i<N, double>*> &x) {
+
+    static const char method[] = "solve()";
+
+    if(x.size() < m_nroots) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__, "x");
+    }
+
+    btod_davidson<N>::start_timer();
+
+    const block_index_space<N> &bis = x[0]->get_bis();
+    symmetry<N, double> sym(bis);
+    {
+        block_tensor_rd_ctrl<N, double> cx(*x[0]);
+        so_copy<N, double>(cx.req_const_symmetry()).perform(sym);
+    }
+
+    std::vector<vector_type*> v, av, r;
+    bool conv = false;
+
+    try {
+
+        //  Orthonormal starting subspace from the guesses
+
+        for(size_t i = 0; i < x.size(); i++) {
+            vector_type *vi = make_vector(bis, sym);
+            std::vector<block_tensor_rd_i<N, double>*> xi(1, x[i]);
+            lincomb(xi, std::vector<double>(1, 1.0),
+                std::vector<block_tensor_i<N, double>*>(1, vi), false);
+            std::vector<block_tensor_rd_i<N, double>*> v0(v.begin(), v.end());
+            if(orthonormalize(*vi, v0) > 1e-8) v.push_back(vi);
+            else delete vi;
+        }
+        if(v.size() < m_nroots) {
+            throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__,
+                "x");
+        }
+
+        std::vector< std::vector<double> > h;
+        std::vector<double> e, s;
+        size_t m = 0;
+        m_niter = 0;
+
+        while(true) {
+
+            //  Products of new vectors and their projections onto
+            //  the subspace
+
+            std::vector<block_tensor_rd_i<N, double>*> vrd(v.begin(), v.end());
+            h.resize(v.size());
+            for(size_t i = 0; i < v.size(); i++) h[i].resize(v.size(), 0.0);
+            for(size_t k = m; k < v.size(); k++) {
+                vector_type *y = make_vector(bis, sym);
+                av.push_back(y);
+                m_a.perform(*v[k], *y);
+                std::vector<double> d;
+                dotprod(*y, vrd, d);
+                for(size_t i = 0; i < v.size(); i++) h[i][k] = h[k][i] = d[i];
+            }
+            m = v.size();
+
+            //  Ritz values and vectors
+
+            std::vector<double> hm(m * m);
+            for(size_t i = 0; i < m; i++) {
+                for(size_t j = 0; j < m; j++) hm[i * m + j] = h[i][j];
+            }
+            btod_davidson_jacobi(m, hm, e, s);
+
+            //  Residuals of all roots in one pass over the subspace:
+            //  r_k = sum_j s_jk (A v_j - e_k v_j)
+
+            std::vector<block_tensor_rd_i<N, double>*> vav(vrd);
+            vav.insert(vav.end(), av.begin(), av.end());
+            std::vector<double> c(m_nroots * 2 * m);
+            for(size_t k = 0; k < m_nroots; k++) {
+                for(size_t j = 0; j < m; j++) {
+                    c[k * 2 * m + j] = -e[k] * s[j * m + k];
+                    c[k * 2 * m + m + j] = s[j * m + k];
+                }
+            }
+            for(size_t k = 0; k < m_nroots; k++) {
+                r.push_back(make_vector(bis, sym));
+            }
+            lincomb(vav, c,
+                std::vector<block_tensor_i<N, double>*>(r.begin(), r.end()),
+                false);
+
+            m_niter++;
+            m_e.assign(e.begin(), e.begin() + m_nroots);
+            m_rnorm.resize(m_nroots);
+            conv = true;
+            for(size_t k = 0; k < m_nroots; k++) {
+                std::vector<block_tensor_rd_i<N, double>*> rk(1, r[k]);
+                std::vector<double> d;
+                dotprod(*r[k], rk, d);
+                m_rnorm[k] = std::sqrt(std::max(d[0], 0.0));
+                if(m_rnorm[k] >= m_tol) conv = false;
+            }
+            if(conv || m_niter >= m_maxiter) break;
+
+            //  Collapse the subspace to the Ritz vectors if it is full
+
+            size_t nnew = 0;
+            for(size_t k = 0; k < m_nroots; k++) {
+                if(m_rnorm[k] >= m_tol) nnew++;
+            }
+            if(m + nnew > m_maxsub) {
+
+                std::vector<vector_type*> v1, av1;
+                for(size_t k = 0; k < m_nroots; k++) {
+                    v1.push_back(make_vector(bis, sym));
+                }
+                for(size_t k = 0; k < m_nroots; k++) {
+                    av1.push_back(make_vector(bis, sym));
+                }
+                std::vector<block_tensor_i<N, double>*> y(v1.begin(), v1.end());
+                y.insert(y.end(), av1.begin(), av1.end());
+                std::vector<double> c1(2 * m_nroots * 2 * m, 0.0);
+                for(size_t k = 0; k < m_nroots; k++) {
+                    for(size_t j = 0; j < m; j++) {
+                        c1[k * 2 * m + j] = s[j * m + k];
+                        c1[(m_nroots + k) * 2 * m + m + j] = s[j * m + k];
+                    }
+                }
+                lincomb(vav, c1, y, false);
+
+                for(size_t i = 0; i < v.size(); i++) delete v[i];
+                for(size_t i = 0; i < av.size(); i++) delete av[i];
+                v.swap(v1);
+                av.swap(av1);
+
+                m = m_nroots;
+                h.assign(m, std::vector<double>(m, 0.0));
+                for(size_t k = 0; k < m; k++) h[k][k] = e[k];
+                s.assign(m * m, 0.0);
+                for(size_t k = 0; k < m; k++) s[k * m + k] = 1.0;
+            }
+
+            //  Preconditioned residuals of unconverged roots become
+            //  new vectors
+
+            for(size_t k = 0; k < m_nroots; k++) {
+                if(m_rnorm[k] < m_tol) continue;
+                m_prec.perform(e[k], *r[k]);
+                std::vector<block_tensor_rd_i<N, double>*> v0(v.begin(),
+                    v.end());
+                if(orthonormalize(*r[k], v0) > 1e-8) {
+                    v.push_back(r[k]);
+                    r[k] = 0;
+                }
+            }
+            for(size_t k = 0; k < r.size(); k++) delete r[k];
+            r.clear();
+
+            if(v.size() == m) break;
+        }
+
+        //  Eigenvectors: x_k = sum_j s_jk v_j
+
+        for(size_t k = 0; k < m_nroots; k++) {
+            block_tensor_ctrl<N, double> cx(*x[k]);
+            cx.req_zero_all_blocks();
+            so_copy<N, double>(sym).perform(cx.req_symmetry());
+        }
+        std::vector<double> c(m_nroots * m);
+        for(size_t k = 0; k < m_nroots; k++) {
+            for(size_t j = 0; j < m; j++) c[k * m + j] = s[j * m + k];
+        }
+        lincomb(std::vector<block_tensor_rd_i<N, double>*>(v.begin(),
+            v.begin() + m), c,
+            std::vector<block_tensor_i<N, double>*>(x.begin(),
+                x.begin() + m_nroots), true);
+
+    } catch(...) {
+        for(size_t i = 0; i < v.size(); i++) delete v[i];
+        for(size_t i = 0; i < av.size(); i++) delete av[i];
+        for(size_t i = 0; i < r.size(); i++) delete r[i];
+        btod_davidson<N>::stop_timer();
+        throw;
+    }
+
+    for(size_t i = 0; i < v.size(); i++) delete v[i];
+    for(size_t i = 0; i < av.size(); i++) delete av[i];
+    for(size_t i = 0; i < r.size(); i++) delete r[i];
+
+    btod_davidson<N>::stop_timer();
+
+    return conv;
+}
+
+
+template<size_t N>
+void btod_davidson<N>::dotprod(block_tensor_rd_i<N, double> &w,
+    const std::vector<block_tensor_rd_i<N, double>*> &v,
+    std::vector<double> &d) {
+
+    btod_multi_dotprod<N>(w, v).calculate(d);
+}
+
+
+template<size_t N>
+void btod_davidson<N>::lincomb(
+    const std::vector<block_tensor_rd_i<N, double>*> &v,
+    const std::vector<double> &c,
+    const std::vector<block_tensor_i<N, double>*> &y, bool add) {
+
+    if(v.empty() || y.empty()) return;
+
+    btod_multi_axpy<N> op(v, c);
+    if(add) op.perform(y, 1.0);
+    else op.perform(y);
+}
+
+
+template<size_t N>
+double btod_davidson<N>::orthonormalize(block_tensor_i<N, double> &w,
+    const std::vector<block_tensor_rd_i<N, double>*> &v) {
+
+    //  Classical Gram-Schmidt, repeated once for numerical stability
+
+    std::vector<block_tensor_i<N, double>*> wv(1, &w);
+    for(size_t pass = 0; pass < 2 && !v.empty(); pass++) {
+        std::vector<double> d;
+        dotprod(w, v, d);
+        for(size_t i = 0; i < d.size(); i++) d[i] = -d[i];
+        lincomb(v, d, wv, true);
+    }
+
+    std::vector<block_tensor_rd_i<N, double>*> w1(1, &w);
+    std::vector<double> d;
+    dotprod(w, w1, d);
+    double nrm = std::sqrt(std::max(d[0], 0.0));
+    if(nrm > 0.0) btod_scale<N>(w, 1.0 / nrm).perform();
+    return nrm;
+}
+
+
+template<size_t N>
+typename btod_davidson<N>::vector_type *btod_davidson<N>::make_vector(
+    const block_index_space<N> &bis, const symmetry<N, double> &sym) {
+
+    vector_type *v = new vector_type(bis);
+    block_tensor_ctrl<N, double> cv(*v);
+    so_copy<N, double>(sym).perform(cv.req_symmetry());
+    return v;
+}
+
+
+template<size_t N>
+void btod_davidson<N>::diag_precond::perform(double e,
+    block_tensor_i<N, double> &r) {
+
+    const dimensions<N> &bidims = r.get_bis().get_block_index_dims();
+    block_tensor_ctrl<N, double> cr(r);
+    block_tensor_rd_ctrl<N, double> cd(m_diag);
+
+    std::vector<size_t> nzblk;
+    gen_block_tensor_rd_ctrl<N, block_tensor_i_traits<double> >(r).
+        req_nonzero_blocks(nzblk);
+
+    for(size_t ib = 0; ib < nzblk.size(); ib++) {
+
+        index<N> idx;
+        abs_index<N>::get_index(nzblk[ib], bidims, idx);
+
+        bool zerod = cd.req_is_zero_block(idx);
+        dense_tensor_rd_ctrl<N, double> *cbd = 0;
+        const double *pd = 0;
+        if(!zerod) {
+            cbd = new dense_tensor_rd_ctrl<N, double>(cd.req_const_block(idx));
+            pd = cbd->req_const_dataptr();
+        }
+
+        dense_tensor_wr_i<N, double> &br = cr.req_block(idx);
+        {
+            dense_tensor_wr_ctrl<N, double> cbr(br);
+            double *pr = cbr.req_dataptr();
+            size_t sz = br.get_dims().get_size();
+            for(size_t i = 0; i < sz; i++) {
+                double den = e - (pd == 0 ? 0.0 : pd[i]);
+                if(std::fabs(den) < m_thresh) {
+                    den = den < 0.0 ? -m_thresh : m_thresh;
+                }
+                pr[i] /= den;
+            }
+            cbr.ret_dataptr(pr);
+        }
+        cr.ret_block(idx);
+
+        if(!zerod) {
+            cbd->ret_const_dataptr(pd);
+            delete cbd;
+            cd.ret_const_block(idx);
+        }
+    }
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_DAVIDSON_IMPL_H
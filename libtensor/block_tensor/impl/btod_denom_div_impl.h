@@ -0,0 +1,342 @@
+#ifndef LIBTENSOR_BTOD_DENOM_DIV_IMPL_H
+#define LIBTENSOR_BTOD_DENOM_DIV_IMPL_H
+
+#include <vector>
+#include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/core/bad_block_index_space.h>
+#include <libtensor/core/orbit.h>
+#include <libtensor/core/orbit_list.h>
+#include <libtensor/dense_tensor/dense_tensor_ctrl.h>
+#include <libtensor/dense_tensor/tod_copy.h>
+#include <libtensor/dense_tensor/tod_denom_div.h>
+#include <libtensor/gen_block_tensor/gen_block_tensor_ctrl.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_add.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_copy.h>
+#include <libtensor/symmetry/so_permute.h>
+#include "../btod_denom_div.h"
+
+namespace libtensor {
+
+
+template<size_t N>
+const char btod_denom_div<N>::k_clazz[] = "btod_denom_div<N>";
+
+
+namespace {
+
+
+template<size_t N>
+class btod_denom_div_task : public libutil::task_i {
+private:
+    btod_denom_div<N> &m_bto;
+    index<N> m_idx;
+    gen_block_stream_i<N, block_tensor_i_traits<double> > &m_out;
+
+public:
+    btod_denom_div_task(btod_denom_div<N> &bto, const index<N> &idx,
+        gen_block_stream_i<N, block_tensor_i_traits<double> > &out) :
+        m_bto(bto), m_idx(idx), m_out(out)
+    { }
+
+    virtual ~btod_denom_div_task() { }
+    virtual unsigned long get_cost() const { return 0; }
+    virtual void perform();
+
+};
+
+
+template<size_t N>
+class btod_denom_div_task_iterator : public libutil::task_iterator_i {
+private:
+    btod_denom_div<N> &m_bto;
+    gen_block_stream_i<N, block_tensor_i_traits<double> > &m_out;
+    const assignment_schedule<N, double> &m_sch;
+    typename assignment_schedule<N, double>::iterator m_i;
+
+public:
+    btod_denom_div_task_iterator(btod_denom_div<N> &bto,
+        gen_block_stream_i<N, block_tensor_i_traits<double> > &out) :
+        m_bto(bto), m_out(out), m_sch(bto.get_schedule()),
+        m_i(m_sch.begin())
+    { }
+
+    virtual bool has_more() const {
+        return m_i != m_sch.end();
+    }
+
+    virtual libutil::task_i *get_next();
+
+};
+
+
+class btod_denom_div_task_observer : public libutil::task_observer_i {
+public:
+    virtual void notify_start_task(libutil::task_i *t) { }
+    virtual void notify_finish_task(libutil::task_i *t) { delete t; }
+
+};
+
+
+} // unnamed namespace
+
+
+template<size_t N>
+btod_denom_div<N>::btod_denom_div(
+    block_tensor_rd_i<N, double> &bta,
+    const tensor_transf<N, double> &tra,
+    const sequence<N, block_tensor_rd_i<1, double>*> &btd,
+    const sequence<N, double> &cd,
+    double shift) :
+
+    m_bta(bta), m_tra(tra), m_btd(btd), m_cd(cd), m_shift(shift),
+    m_bisb(block_index_space<N>(bta.get_bis()).permute(tra.get_perm())),
+    m_symb(m_bisb), m_sch(m_bisb.get_block_index_dims()) {
+
+    check_bis();
+    make_schedule();
+}
+
+
+template<size_t N>
+btod_denom_div<N>::btod_denom_div(
+    block_tensor_rd_i<N, double> &bta,
+    const sequence<N, block_tensor_rd_i<1, double>*> &btd,
+    const sequence<N, double> &cd,
+    double shift) :
+
+    m_bta(bta), m_btd(btd), m_cd(cd), m_shift(shift),
+    m_bisb(bta.get_bis()), m_symb(m_bisb),
+    m_sch(m_bisb.get_block_index_dims()) {
+
+    check_bis();
+    make_schedule();
+}
+
+
+template<size_t N>
+void btod_denom_div<N>::perform(gen_block_stream_i<N, bti_traits> &out) {
+
+    btod_denom_div<N>::start_timer();
+
+    try {
+
+        btod_denom_div_task_iterator<N> ti(*this, out);
+        btod_denom_div_task_observer to;
+        libutil::thread_pool::submit(ti, to);
+
+    } catch(...) {
+        btod_denom_div<N>::stop_timer();
+        throw;
+    }
+
+    btod_denom_div<N>::stop_timer();
+}
+
+
+template<size_t N>
+void btod_denom_div<N>::perform(gen_block_tensor_i<N, bti_traits> &btb) {
+
+    gen_bto_aux_copy<N, btod_traits> out(m_symb, btb);
+    out.open();
+    perform(out);
+    out.close();
+}
+
+
+template<size_t N>
+void btod_denom_div<N>::perform(gen_block_tensor_i<N, bti_traits> &btb,
+    const scalar_transf<double> &c) {
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> cb(btb);
+    std::vector<size_t> nzblkb;
+    cb.req_nonzero_blocks(nzblkb);
+    addition_schedule<N, btod_traits> asch(m_symb, cb.req_const_symmetry());
+    asch.build(m_sch, nzblkb);
+
+    gen_bto_aux_add<N, btod_traits> out(m_symb, asch, btb, c);
+    out.open();
+    perform(out);
+    out.close();
+}
+
+
+template<size_t N>
+void btod_denom_div<N>::perform(block_tensor_i<N, double> &btb, double c) {
+
+    perform(btb, scalar_transf<double>(c));
+}
+
+
+template<size_t N>
+void btod_denom_div<N>::compute_block(
+    bool zero,
+    const index<N> &ib,
+    const tensor_transf<N, double> &trb,
+    dense_tensor_wr_i<N, double> &blkb) {
+
+    btod_denom_div<N>::start_timer("compute_block");
+
+    try {
+
+        compute_block_untimed(zero, ib, trb, blkb);
+
+    } catch(...) {
+        btod_denom_div<N>::stop_timer("compute_block");
+        throw;
+    }
+
+    btod_denom_div<N>::stop_timer("compute_block");
+}
+
+
+template<size_t N>
+void btod_denom_div<N>::compute_block_untimed(
+    bool zero,
+    const index<N> &ib,
+    const tensor_transf<N, double> &trb,
+    dense_tensor_wr_i<N, double> &blkb) {
+
+    typedef typename btod_traits::template temp_block_type<N>::type
+        temp_block_type;
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> ca(m_bta);
+
+    //  Block of A that makes the block of the result
+
+    index<N> ia(ib);
+    ia.permute(permutation<N>(m_tra.get_perm(), true));
+    orbit<N, double> oa(ca.req_const_symmetry(), ia);
+    index<N> cia;
+    abs_index<N>::get_index(oa.get_acindex(),
+        m_bta.get_bis().get_block_index_dims(), cia);
+    tensor_transf<N, double> tra(oa.get_transf(ia));
+    tra.transform(m_tra);
+
+    //  Blocks of the vectors, scaled by their coefficients
+
+    dimensions<N> dimsb = m_bisb.get_block_dims(ib);
+    std::vector<double> d[N];
+    sequence<N, const double*> pd(0);
+    for(size_t k = 0; k < N; k++) {
+
+        gen_block_tensor_rd_ctrl<1, bti_traits> cd(*m_btd[k]);
+        index<1> id;
+        id[0] = ib[k];
+        orbit<1, double> od(cd.req_const_symmetry(), id);
+        if(!od.is_allowed()) continue;
+        index<1> cid;
+        abs_index<1>::get_index(od.get_acindex(),
+            m_btd[k]->get_bis().get_block_index_dims(), cid);
+        if(cd.req_is_zero_block(cid)) continue;
+
+        double c = m_cd[k] * od.get_transf(id).get_scalar_tr().get_coeff();
+        dense_tensor_rd_i<1, double> &blkd = cd.req_const_block(cid);
+        {
+            dense_tensor_rd_ctrl<1, double> cblkd(blkd);
+            const double *p = cblkd.req_const_dataptr();
+            d[k].resize(dimsb[k]);
+            for(size_t i = 0; i < dimsb[k]; i++) d[k][i] = c * p[i];
+            cblkd.ret_const_dataptr(p);
+        }
+        cd.ret_const_block(cid);
+        pd[k] = &d[k][0];
+    }
+
+    //  Divide in the result if possible, otherwise in a temporary block
+
+    dense_tensor_rd_i<N, double> &blka = ca.req_const_block(cia);
+    if(zero && trb.get_perm().is_identity()) {
+        tra.transform(trb.get_scalar_tr());
+        tod_copy<N>(blka, tra).perform(true, blkb);
+        tod_denom_div<N>(pd, m_shift).perform(blkb);
+    } else {
+        temp_block_type blkt(dimsb);
+        tod_copy<N>(blka, tra).perform(true, blkt);
+        tod_denom_div<N>(pd, m_shift).perform(blkt);
+        tod_copy<N>(blkt, trb).perform(zero, blkb);
+    }
+    ca.ret_const_block(cia);
+}
+
+
+template<size_t N>
+void btod_denom_div<N>::check_bis() {
+
+    static const char method[] = "check_bis()";
+
+    for(size_t k = 0; k < N; k++) {
+        if(m_btd[k] == 0) {
+            throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__,
+                "btd");
+        }
+        const block_index_space<1> &bisd = m_btd[k]->get_bis();
+        if(bisd.get_dims()[0] != m_bisb.get_dims()[k] ||
+            !bisd.get_splits(bisd.get_type(0)).equals(
+                m_bisb.get_splits(m_bisb.get_type(k)))) {
+            throw bad_block_index_space(g_ns, k_clazz, method,
+                __FILE__, __LINE__, "btd");
+        }
+    }
+}
+
+
+template<size_t N>
+void btod_denom_div<N>::make_schedule() {
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> ca(m_bta);
+    so_permute<N, double>(ca.req_const_symmetry(), m_tra.get_perm()).
+        perform(m_symb);
+
+    permutation<N> pinv(m_tra.get_perm(), true);
+    const dimensions<N> &bidimsa = m_bta.get_bis().get_block_index_dims();
+
+    orbit_list<N, double> ol(m_symb);
+    for(typename orbit_list<N, double>::iterator io = ol.begin();
+        io != ol.end(); ++io) {
+
+        index<N> ia;
+        ol.get_index(io, ia);
+        ia.permute(pinv);
+        orbit<N, double> oa(ca.req_const_symmetry(), ia);
+        if(!oa.is_allowed()) continue;
+        index<N> cia;
+        abs_index<N>::get_index(oa.get_acindex(), bidimsa, cia);
+        if(ca.req_is_zero_block(cia)) continue;
+        m_sch.insert(ol.get_abs_index(io));
+    }
+}
+
+
+namespace {
+
+
+template<size_t N>
+void btod_denom_div_task<N>::perform() {
+
+    typedef typename btod_traits::template temp_block_type<N>::type
+        temp_block_type;
+
+    tensor_transf<N, double> tr0;
+    temp_block_type blk(m_bto.get_bis().get_block_dims(m_idx));
+    m_bto.compute_block_untimed(true, m_idx, tr0, blk);
+    m_out.put(m_idx, blk, tr0);
+}
+
+
+template<size_t N>
+libutil::task_i *btod_denom_div_task_iterator<N>::get_next() {
+
+    index<N> idx;
+    abs_index<N>::get_index(m_sch.get_abs_index(m_i),
+        m_bto.get_bis().get_block_index_dims(), idx);
+    ++m_i;
+    return new btod_denom_div_task<N>(m_bto, idx, m_out);
+}
+
+
+} // unnamed namespace
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_DENOM_DIV_IMPL_H
@@ -0,0 +1,574 @@
+#ifndef LIBTENSOR_BTOD_EWISE_IMPL_H
+#define LIBTENSOR_BTOD_EWISE_IMPL_H
+
+#include <memory>
+#include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/core/bad_block_index_space.h>
+#include <libtensor/core/block_index_space_product_builder.h>
+#include <libtensor/core/orbit.h>
+#include <libtensor/core/orbit_list.h>
+#include <libtensor/dense_tensor/dense_tensor_ctrl.h>
+#include <libtensor/dense_tensor/tod_copy.h>
+#include <libtensor/gen_block_tensor/gen_block_tensor_ctrl.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_add.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_copy.h>
+#include <libtensor/symmetry/so_copy.h>
+#include <libtensor/symmetry/so_dirprod.h>
+#include <libtensor/symmetry/so_dirsum.h>
+#include <libtensor/symmetry/so_merge.h>
+#include <libtensor/symmetry/so_permute.h>
+#include "../btod_ewise.h"
+
+namespace libtensor {
+
+
+template<size_t N>
+const char btod_ewise<N>::k_clazz[] = "btod_ewise<N>";
+
+
+namespace {
+
+
+template<size_t N>
+class btod_ewise_task : public libutil::task_i {
+private:
+    btod_ewise<N> &m_bto;
+    index<N> m_idx;
+    gen_block_stream_i<N, block_tensor_i_traits<double> > &m_out;
+
+public:
+    btod_ewise_task(btod_ewise<N> &bto, const index<N> &idx,
+        gen_block_stream_i<N, block_tensor_i_traits<double> > &out) :
+        m_bto(bto), m_idx(idx), m_out(out)
+    { }
+
+    virtual ~btod_ewise_task() { }
+    virtual unsigned long get_cost() const { return 0; }
+    virtual void perform();
+
+};
+
+
+template<size_t N>
+class btod_ewise_task_iterator : public libutil::task_iterator_i {
+private:
+    btod_ewise<N> &m_bto;
+    gen_block_stream_i<N, block_tensor_i_traits<double> > &m_out;
+    const assignment_schedule<N, double> &m_sch;
+    typename assignment_schedule<N, double>::iterator m_i;
+
+public:
+    btod_ewise_task_iterator(btod_ewise<N> &bto,
+        gen_block_stream_i<N, block_tensor_i_traits<double> > &out) :
+        m_bto(bto), m_out(out), m_sch(bto.get_schedule()),
+        m_i(m_sch.begin())
+    { }
+
+    virtual bool has_more() const {
+        return m_i != m_sch.end();
+    }
+
+    virtual libutil::task_i *get_next();
+
+};
+
+
+class btod_ewise_task_observer : public libutil::task_observer_i {
+public:
+    virtual void notify_start_task(libutil::task_i *t) { }
+    virtual void notify_finish_task(libutil::task_i *t) { delete t; }
+
+};
+
+
+/** \brief Block of an argument brought to the index order of the result
+
+    The data of the canonical block are read in place if no permutation is
+    required, otherwise the block is copied to a temporary block first.
+ **/
+template<size_t N>
+class btod_ewise_block : public noncopyable {
+public:
+    typedef btod_traits::bti_traits bti_traits;
+    typedef typename btod_traits::template temp_block_type<N>::type
+        temp_block_type;
+
+private:
+    gen_block_tensor_rd_ctrl<N, bti_traits> m_ca; //!< Argument control
+    index<N> m_cidx; //!< Index of canonical block
+    dense_tensor_rd_i<N, double> *m_blk; //!< Canonical block read in place
+    std::auto_ptr<temp_block_type> m_tmp; //!< Temporary block
+    std::auto_ptr< dense_tensor_rd_ctrl<N, double> > m_cblk; //!< Data ctrl
+    const double *m_p; //!< Data (null for zero block)
+    double m_c; //!< Coefficient
+
+public:
+    btod_ewise_block(block_tensor_rd_i<N, double> &bt,
+        const tensor_transf<N, double> &tr, const index<N> &ib,
+        const dimensions<N> &dimsb);
+
+    ~btod_ewise_block();
+
+    const double *get_data() const {
+        return m_p;
+    }
+
+    double get_coeff() const {
+        return m_c;
+    }
+
+};
+
+
+template<size_t N>
+btod_ewise_block<N>::btod_ewise_block(block_tensor_rd_i<N, double> &bt,
+    const tensor_transf<N, double> &tr, const index<N> &ib,
+    const dimensions<N> &dimsb) :
+
+    m_ca(bt), m_blk(0), m_p(0), m_c(0.0) {
+
+    index<N> ia(ib);
+    ia.permute(permutation<N>(tr.get_perm(), true));
+    orbit<N, double> oa(m_ca.req_const_symmetry(), ia);
+    if(!oa.is_allowed()) return;
+    abs_index<N>::get_index(oa.get_acindex(),
+        bt.get_bis().get_block_index_dims(), m_cidx);
+    if(m_ca.req_is_zero_block(m_cidx)) return;
+
+    tensor_transf<N, double> tra(oa.get_transf(ia));
+    tra.transform(tr);
+
+    dense_tensor_rd_i<N, double> &blk = m_ca.req_const_block(m_cidx);
+    if(tra.get_perm().is_identity()) {
+        m_blk = &blk;
+        m_c = tra.get_scalar_tr().get_coeff();
+        m_cblk.reset(new dense_tensor_rd_ctrl<N, double>(blk));
+    } else {
+        m_tmp.reset(new temp_block_type(dimsb));
+        tod_copy<N>(blk, tra).perform(true, *m_tmp);
+        m_ca.ret_const_block(m_cidx);
+        m_c = 1.0;
+        m_cblk.reset(new dense_tensor_rd_ctrl<N, double>(*m_tmp));
+    }
+    m_p = m_cblk->req_const_dataptr();
+}
+
+
+template<size_t N>
+btod_ewise_block<N>::~btod_ewise_block() {
+
+    if(m_p != 0) m_cblk->ret_const_dataptr(m_p);
+    m_cblk.reset();
+    if(m_blk != 0) m_ca.ret_const_block(m_cidx);
+}
+
+
+} // unnamed namespace
+
+
+template<size_t N>
+btod_ewise<N>::btod_ewise(
+    const std::vector<int> &prog,
+    const std::vector<block_tensor_rd_i<N, double>*> &bt,
+    const std::vector< tensor_transf<N, double> > &tr,
+    const scalar_transf<double> &c) :
+
+    m_prog(prog), m_bt(bt), m_tr(tr), m_c(c), m_depth(0),
+    m_bisb(bt.empty() ? block_index_space<N>(dimensions<N>(index_range<N>(
+        index<N>(), index<N>()))) :
+        block_index_space<N>(bt[0]->get_bis()).permute(tr[0].get_perm())),
+    m_symb(m_bisb), m_sch(m_bisb.get_block_index_dims()) {
+
+    check_prog();
+    check_bis();
+    make_symmetry();
+    make_schedule();
+}
+
+
+template<size_t N>
+void btod_ewise<N>::perform(gen_block_stream_i<N, bti_traits> &out) {
+
+    btod_ewise<N>::start_timer();
+
+    try {
+
+        btod_ewise_task_iterator<N> ti(*this, out);
+        btod_ewise_task_observer to;
+        libutil::thread_pool::submit(ti, to);
+
+    } catch(...) {
+        btod_ewise<N>::stop_timer();
+        throw;
+    }
+
+    btod_ewise<N>::stop_timer();
+}
+
+
+template<size_t N>
+void btod_ewise<N>::perform(gen_block_tensor_i<N, bti_traits> &btb) {
+
+    gen_bto_aux_copy<N, btod_traits> out(m_symb, btb);
+    out.open();
+    perform(out);
+    out.close();
+}
+
+
+template<size_t N>
+void btod_ewise<N>::perform(gen_block_tensor_i<N, bti_traits> &btb,
+    const scalar_transf<double> &c) {
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> cb(btb);
+    std::vector<size_t> nzblkb;
+    cb.req_nonzero_blocks(nzblkb);
+    addition_schedule<N, btod_traits> asch(m_symb, cb.req_const_symmetry());
+    asch.build(m_sch, nzblkb);
+
+    gen_bto_aux_add<N, btod_traits> out(m_symb, asch, btb, c);
+    out.open();
+    perform(out);
+    out.close();
+}
+
+
+template<size_t N>
+void btod_ewise<N>::perform(block_tensor_i<N, double> &btb, double c) {
+
+    perform(btb, scalar_transf<double>(c));
+}
+
+
+template<size_t N>
+void btod_ewise<N>::compute_block(
+    bool zero,
+    const index<N> &ib,
+    const tensor_transf<N, double> &trb,
+    dense_tensor_wr_i<N, double> &blkb) {
+
+    btod_ewise<N>::start_timer("compute_block");
+
+    try {
+
+        compute_block_untimed(zero, ib, trb, blkb);
+
+    } catch(...) {
+        btod_ewise<N>::stop_timer("compute_block");
+        throw;
+    }
+
+    btod_ewise<N>::stop_timer("compute_block");
+}
+
+
+template<size_t N>
+void btod_ewise<N>::compute_block_untimed(
+    bool zero,
+    const index<N> &ib,
+    const tensor_transf<N, double> &trb,
+    dense_tensor_wr_i<N, double> &blkb) {
+
+    typedef typename btod_traits::template temp_block_type<N>::type
+        temp_block_type;
+
+    //  Number of elements evaluated at a time
+    enum {
+        k_chunk = 256
+    };
+
+    dimensions<N> dimsb = m_bisb.get_block_dims(ib);
+    size_t n = dimsb.get_size();
+
+    std::vector<btod_ewise_block<N>*> blka(m_bt.size(), 0);
+    std::auto_ptr<temp_block_type> blkt;
+
+    try {
+
+        for(size_t i = 0; i < m_bt.size(); i++) {
+            blka[i] = new btod_ewise_block<N>(*m_bt[i], m_tr[i], ib, dimsb);
+        }
+
+        //  Write to the result directly unless it needs a permutation
+
+        bool direct = trb.get_perm().is_identity();
+        double cb = m_c.get_coeff();
+        if(direct) cb *= trb.get_scalar_tr().get_coeff();
+        if(!direct) blkt.reset(new temp_block_type(dimsb));
+        dense_tensor_wr_i<N, double> &blkr = direct ? blkb : *blkt;
+        bool add = direct && !zero;
+
+        std::vector<double> stack(m_depth * k_chunk);
+
+        dense_tensor_wr_ctrl<N, double> cr(blkr);
+        double *pr = cr.req_dataptr();
+
+        for(size_t i0 = 0; i0 < n; i0 += k_chunk) {
+
+            size_t len = n - i0 < k_chunk ? n - i0 : k_chunk;
+            size_t sp = 0, ia = 0;
+
+            for(size_t ip = 0; ip < m_prog.size(); ip++) {
+
+                if(m_prog[ip] == k_arg) {
+                    double *s = &stack[sp * k_chunk];
+                    const double *pa = blka[ia]->get_data();
+                    double ca = blka[ia]->get_coeff();
+                    if(pa == 0) {
+                        for(size_t i = 0; i < len; i++) s[i] = 0.0;
+                    } else {
+                        pa += i0;
+                        for(size_t i = 0; i < len; i++) s[i] = ca * pa[i];
+                    }
+                    sp++; ia++;
+                    continue;
+                }
+
+                double *s1 = &stack[(sp - 2) * k_chunk];
+                const double *s2 = &stack[(sp - 1) * k_chunk];
+                switch(m_prog[ip]) {
+                case k_add:
+                    for(size_t i = 0; i < len; i++) s1[i] += s2[i];
+                    break;
+                case k_mul:
+                    for(size_t i = 0; i < len; i++) s1[i] *= s2[i];
+                    break;
+                case k_div:
+                    for(size_t i = 0; i < len; i++) s1[i] /= s2[i];
+                    break;
+                }
+                sp--;
+            }
+
+            const double *s = &stack[0];
+            double *p = pr + i0;
+            if(add) {
+                for(size_t i = 0; i < len; i++) p[i] += cb * s[i];
+            } else {
+                for(size_t i = 0; i < len; i++) p[i] = cb * s[i];
+            }
+        }
+
+        cr.ret_dataptr(pr); pr = 0;
+
+        if(!direct) tod_copy<N>(*blkt, trb).perform(zero, blkb);
+
+    } catch(...) {
+        for(size_t i = 0; i < blka.size(); i++) delete blka[i];
+        throw;
+    }
+
+    for(size_t i = 0; i < blka.size(); i++) delete blka[i];
+}
+
+
+template<size_t N>
+void btod_ewise<N>::check_prog() {
+
+    static const char method[] = "check_prog()";
+
+    if(m_bt.empty() || m_bt.size() != m_tr.size()) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "bt");
+    }
+
+    size_t sp = 0, na = 0;
+    for(size_t ip = 0; ip < m_prog.size(); ip++) {
+        switch(m_prog[ip]) {
+        case k_arg:
+            if(na == m_bt.size()) {
+                throw bad_parameter(g_ns, k_clazz, method,
+                    __FILE__, __LINE__, "prog");
+            }
+            na++; sp++;
+            if(sp > m_depth) m_depth = sp;
+            break;
+        case k_add:
+        case k_mul:
+        case k_div:
+            if(sp < 2) {
+                throw bad_parameter(g_ns, k_clazz, method,
+                    __FILE__, __LINE__, "prog");
+            }
+            sp--;
+            break;
+        default:
+            throw bad_parameter(g_ns, k_clazz, method,
+                __FILE__, __LINE__, "prog");
+        }
+    }
+    if(sp != 1 || na != m_bt.size()) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "prog");
+    }
+}
+
+
+template<size_t N>
+void btod_ewise<N>::check_bis() {
+
+    static const char method[] = "check_bis()";
+
+    block_index_space<N> bisb(m_bisb);
+    bisb.match_splits();
+    for(size_t i = 1; i < m_bt.size(); i++) {
+        block_index_space<N> bisa(m_bt[i]->get_bis());
+        bisa.permute(m_tr[i].get_perm());
+        bisa.match_splits();
+        if(!bisa.equals(bisb)) {
+            throw bad_block_index_space(g_ns, k_clazz, method,
+                __FILE__, __LINE__, "bt");
+        }
+    }
+}
+
+
+template<size_t N>
+void btod_ewise<N>::make_symmetry() {
+
+    //  Symmetries of the arguments in the index order of the result are
+    //  combined following the program: direct sums for additions, direct
+    //  products otherwise, each followed by the merge of the indexes
+
+    block_index_space_product_builder<N, N> bbx(m_bisb, m_bisb,
+        permutation<N + N>());
+    mask<N + N> msk;
+    sequence<N + N, size_t> seq;
+    for(size_t i = 0; i < N; i++) {
+        msk[i] = msk[i + N] = true;
+        seq[i] = seq[i + N] = i;
+    }
+
+    std::vector< symmetry<N, double>* > stack;
+
+    try {
+
+        size_t ia = 0;
+        for(size_t ip = 0; ip < m_prog.size(); ip++) {
+
+            if(m_prog[ip] == k_arg) {
+                gen_block_tensor_rd_ctrl<N, bti_traits> ca(*m_bt[ia]);
+                stack.push_back(new symmetry<N, double>(m_bisb));
+                so_permute<N, double>(ca.req_const_symmetry(),
+                    m_tr[ia].get_perm()).perform(*stack.back());
+                ia++;
+                continue;
+            }
+
+            symmetry<N, double> *s2 = stack.back();
+            stack.pop_back();
+            symmetry<N, double> &s1 = *stack.back();
+
+            symmetry<N + N, double> symx(bbx.get_bis());
+            if(m_prog[ip] == k_add) {
+                so_dirsum<N, N, double>(s1, *s2).perform(symx);
+            } else {
+                so_dirprod<N, N, double>(s1, *s2).perform(symx);
+            }
+            delete s2;
+            so_merge<N + N, N, double>(symx, msk, seq).perform(s1);
+        }
+
+        so_copy<N, double>(*stack.back()).perform(m_symb);
+
+    } catch(...) {
+        for(size_t i = 0; i < stack.size(); i++) delete stack[i];
+        throw;
+    }
+
+    for(size_t i = 0; i < stack.size(); i++) delete stack[i];
+}
+
+
+template<size_t N>
+void btod_ewise<N>::make_schedule() {
+
+    static const char method[] = "make_schedule()";
+
+    std::vector<bool> stack;
+
+    orbit_list<N, double> ol(m_symb);
+    for(typename orbit_list<N, double>::iterator io = ol.begin();
+        io != ol.end(); ++io) {
+
+        index<N> ib;
+        ol.get_index(io, ib);
+
+        stack.clear();
+        size_t ia = 0;
+        for(size_t ip = 0; ip < m_prog.size(); ip++) {
+
+            if(m_prog[ip] == k_arg) {
+                gen_block_tensor_rd_ctrl<N, bti_traits> ca(*m_bt[ia]);
+                index<N> idxa(ib);
+                idxa.permute(permutation<N>(m_tr[ia].get_perm(), true));
+                orbit<N, double> oa(ca.req_const_symmetry(), idxa);
+                bool nz = oa.is_allowed();
+                if(nz) {
+                    index<N> cidxa;
+                    abs_index<N>::get_index(oa.get_acindex(),
+                        m_bt[ia]->get_bis().get_block_index_dims(), cidxa);
+                    nz = !ca.req_is_zero_block(cidxa);
+                }
+                stack.push_back(nz);
+                ia++;
+                continue;
+            }
+
+            bool nz2 = stack.back();
+            stack.pop_back();
+            bool nz1 = stack.back();
+            switch(m_prog[ip]) {
+            case k_add:
+                stack.back() = nz1 || nz2;
+                break;
+            case k_mul:
+                stack.back() = nz1 && nz2;
+                break;
+            case k_div:
+                if(!nz2) {
+                    throw bad_parameter(g_ns, k_clazz, method,
+                        __FILE__, __LINE__, "Zero block in denominator.");
+                }
+                break;
+            }
+        }
+
+        if(stack.back()) m_sch.insert(ol.get_abs_index(io));
+    }
+}
+
+
+namespace {
+
+
+template<size_t N>
+void btod_ewise_task<N>::perform() {
+
+    typedef typename btod_traits::template temp_block_type<N>::type
+        temp_block_type;
+
+    tensor_transf<N, double> tr0;
+    temp_block_type blk(m_bto.get_bis().get_block_dims(m_idx));
+    m_bto.compute_block_untimed(true, m_idx, tr0, blk);
+    m_out.put(m_idx, blk, tr0);
+}
+
+
+template<size_t N>
+libutil::task_i *btod_ewise_task_iterator<N>::get_next() {
+
+    index<N> idx;
+    abs_index<N>::get_index(m_sch.get_abs_index(m_i),
+        m_bto.get_bis().get_block_index_dims(), idx);
+    ++m_i;
+    return new btod_ewise_task<N>(m_bto, idx, m_out);
+}
+
+
+} // unnamed namespace
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_EWISE_IMPL_H
@@ -0,0 +1,275 @@
+#ifndef LIBTENSOR_BTOD_MULTI_AXPY_IMPL_H
+#define LIBTENSOR_BTOD_MULTI_AXPY_IMPL_H
+
+#include <algorithm>
+#include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/exception.h>
+#include <libtensor/core/bad_block_index_space.h>
+#include <libtensor/core/orbit_list.h>
+#include <libtensor/dense_tensor/dense_tensor_ctrl.h>
+#include <libtensor/linalg/linalg.h>
+#include <libtensor/symmetry/so_copy.h>
+#include "../block_tensor_ctrl.h"
+#include "../btod_multi_axpy.h"
+
+namespace libtensor {
+
+
+template<size_t N>
+const char btod_multi_axpy<N>::k_clazz[] = "btod_multi_axpy<N>";
+
+
+namespace {
+
+
+template<size_t N>
+class btod_multi_axpy_task : public libutil::task_i {
+private:
+    const std::vector< block_tensor_rd_ctrl<N, double>* > &m_cv;
+    const std::vector< block_tensor_ctrl<N, double>* > &m_cy;
+    const std::vector<double> &m_c;
+    index<N> m_idx;
+
+public:
+    btod_multi_axpy_task(
+        const std::vector< block_tensor_rd_ctrl<N, double>* > &cv,
+        const std::vector< block_tensor_ctrl<N, double>* > &cy,
+        const std::vector<double> &c, const index<N> &idx) :
+        m_cv(cv), m_cy(cy), m_c(c), m_idx(idx)
+    { }
+
+    virtual ~btod_multi_axpy_task() { }
+    virtual unsigned long get_cost() const { return 0; }
+    virtual void perform();
+
+};
+
+
+template<size_t N>
+class btod_multi_axpy_task_iterator : public libutil::task_iterator_i {
+private:
+    const std::vector< block_tensor_rd_ctrl<N, double>* > &m_cv;
+    const std::vector< block_tensor_ctrl<N, double>* > &m_cy;
+    const std::vector<double> &m_c;
+    const std::vector< index<N> > &m_blk;
+    size_t m_i;
+
+public:
+    btod_multi_axpy_task_iterator(
+        const std::vector< block_tensor_rd_ctrl<N, double>* > &cv,
+        const std::vector< block_tensor_ctrl<N, double>* > &cy,
+        const std::vector<double> &c, const std::vector< index<N> > &blk) :
+        m_cv(cv), m_cy(cy), m_c(c), m_blk(blk), m_i(0)
+    { }
+
+    virtual bool has_more() const {
+        return m_i < m_blk.size();
+    }
+
+    virtual libutil::task_i *get_next() {
+        return new btod_multi_axpy_task<N>(m_cv, m_cy, m_c, m_blk[m_i++]);
+    }
+
+};
+
+
+class btod_multi_axpy_task_observer : public libutil::task_observer_i {
+public:
+    virtual void notify_start_task(libutil::task_i *t) { }
+    virtual void notify_finish_task(libutil::task_i *t) { delete t; }
+
+};
+
+
+} // unnamed namespace
+
+
+template<size_t N>
+btod_multi_axpy<N>::btod_multi_axpy(
+    const std::vector<block_tensor_rd_i<N, double>*> &btv,
+    const std::vector<double> &c) :
+
+    m_btv(btv), m_c(c), m_ny(0) {
+
+    static const char method[] = "btod_multi_axpy()";
+
+    if(m_btv.empty()) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__, "btv");
+    }
+    for(size_t j = 1; j < m_btv.size(); j++) {
+        if(!m_btv[j]->get_bis().equals(m_btv[0]->get_bis())) {
+            throw bad_block_index_space(g_ns, k_clazz, method,
+                __FILE__, __LINE__, "btv");
+        }
+    }
+    if(m_c.size() % m_btv.size() != 0) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__, "c");
+    }
+    m_ny = m_c.size() / m_btv.size();
+}
+
+
+template<size_t N>
+void btod_multi_axpy<N>::perform(
+    const std::vector<block_tensor_i<N, double>*> &bty) {
+
+    do_perform(bty, true, 1.0);
+}
+
+
+template<size_t N>
+void btod_multi_axpy<N>::perform(
+    const std::vector<block_tensor_i<N, double>*> &bty, double d) {
+
+    do_perform(bty, false, d);
+}
+
+
+template<size_t N>
+void btod_multi_axpy<N>::do_perform(
+    const std::vector<block_tensor_i<N, double>*> &bty, bool zero,
+    double d) {
+
+    static const char method[] = "perform()";
+
+    size_t nv = m_btv.size();
+    if(bty.size() != m_ny) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__, "bty");
+    }
+    for(size_t k = 0; k < m_ny; k++) {
+        if(!bty[k]->get_bis().equals(m_btv[0]->get_bis())) {
+            throw bad_block_index_space(g_ns, k_clazz, method,
+                __FILE__, __LINE__, "bty");
+        }
+    }
+    if(m_ny == 0) return;
+
+    btod_multi_axpy<N>::start_timer();
+
+    std::vector< block_tensor_rd_ctrl<N, double>* > cv(nv, 0);
+    std::vector< block_tensor_ctrl<N, double>* > cy(m_ny, 0);
+
+    try {
+
+        for(size_t j = 0; j < nv; j++) {
+            cv[j] = new block_tensor_rd_ctrl<N, double>(*m_btv[j]);
+        }
+        const symmetry<N, double> &sym = cv[0]->req_const_symmetry();
+        for(size_t k = 0; k < m_ny; k++) {
+            cy[k] = new block_tensor_ctrl<N, double>(*bty[k]);
+            if(zero) {
+                cy[k]->req_zero_all_blocks();
+                so_copy<N, double>(sym).perform(cy[k]->req_symmetry());
+            }
+        }
+
+        //  Canonical blocks that are non-zero in at least one argument
+
+        std::vector< index<N> > blk;
+        orbit_list<N, double> ol(sym);
+        for(typename orbit_list<N, double>::iterator io = ol.begin();
+            io != ol.end(); ++io) {
+
+            index<N> idx;
+            ol.get_index(io, idx);
+            for(size_t j = 0; j < nv; j++) {
+                if(!cv[j]->req_is_zero_block(idx)) {
+                    blk.push_back(idx);
+                    break;
+                }
+            }
+        }
+
+        std::vector<double> c(m_c);
+        if(d != 1.0) for(size_t i = 0; i < c.size(); i++) c[i] *= d;
+
+        btod_multi_axpy_task_iterator<N> ti(cv, cy, c, blk);
+        btod_multi_axpy_task_observer to;
+        libutil::thread_pool::submit(ti, to);
+
+    } catch(...) {
+        for(size_t j = 0; j < nv; j++) delete cv[j];
+        for(size_t k = 0; k < m_ny; k++) delete cy[k];
+        btod_multi_axpy<N>::stop_timer();
+        throw;
+    }
+
+    for(size_t j = 0; j < nv; j++) delete cv[j];
+    for(size_t k = 0; k < m_ny; k++) delete cy[k];
+
+    btod_multi_axpy<N>::stop_timer();
+}
+
+
+namespace {
+
+
+template<size_t N>
+void btod_multi_axpy_task<N>::perform() {
+
+    size_t nv = m_cv.size(), ny = m_cy.size();
+    std::vector< dense_tensor_rd_ctrl<N, double>* > cbv(nv, 0);
+    std::vector<const double*> pv(nv, 0);
+
+    try {
+
+        //  Each block of the arguments is read once for all the results
+
+        size_t sz = 0;
+        for(size_t j = 0; j < nv; j++) {
+            if(m_cv[j]->req_is_zero_block(m_idx)) continue;
+            dense_tensor_rd_i<N, double> &bv = m_cv[j]->req_const_block(m_idx);
+            sz = bv.get_dims().get_size();
+            cbv[j] = new dense_tensor_rd_ctrl<N, double>(bv);
+            pv[j] = cbv[j]->req_const_dataptr();
+        }
+
+        for(size_t k = 0; k < ny; k++) {
+
+            bool contrib = false;
+            for(size_t j = 0; j < nv; j++) {
+                if(pv[j] != 0 && m_c[k * nv + j] != 0.0) contrib = true;
+            }
+            if(!contrib) continue;
+
+            bool zero = m_cy[k]->req_is_zero_block(m_idx);
+            dense_tensor_wr_i<N, double> &by = m_cy[k]->req_block(m_idx);
+            {
+                dense_tensor_wr_ctrl<N, double> cby(by);
+                double *py = cby.req_dataptr();
+                if(zero) std::fill(py, py + sz, 0.0);
+                for(size_t j = 0; j < nv; j++) {
+                    double c = m_c[k * nv + j];
+                    if(pv[j] == 0 || c == 0.0) continue;
+                    linalg::mul2_i_i_x(0, sz, pv[j], 1, c, py, 1);
+                }
+                cby.ret_dataptr(py);
+            }
+            m_cy[k]->ret_block(m_idx);
+        }
+
+    } catch(...) {
+        for(size_t j = 0; j < nv; j++) {
+            if(cbv[j] == 0) continue;
+            cbv[j]->ret_const_dataptr(pv[j]);
+            delete cbv[j];
+            m_cv[j]->ret_const_block(m_idx);
+        }
+        throw;
+    }
+
+    for(size_t j = 0; j < nv; j++) {
+        if(cbv[j] == 0) continue;
+        cbv[j]->ret_const_dataptr(pv[j]);
+        delete cbv[j];
+        m_cv[j]->ret_const_block(m_idx);
+    }
+}
+
+
+} // unnamed namespace
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_MULTI_AXPY_IMPL_H
@@ -0,0 +1,217 @@
+#ifndef LIBTENSOR_BTOD_MULTI_DOTPROD_IMPL_H
+#define LIBTENSOR_BTOD_MULTI_DOTPROD_IMPL_H
+
+#include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/core/abs_index.h>
+#include <libtensor/core/bad_block_index_space.h>
+#include <libtensor/core/orbit.h>
+#include <libtensor/core/orbit_list.h>
+#include <libtensor/core/scalar_transf_double.h>
+#include <libtensor/dense_tensor/dense_tensor_ctrl.h>
+#include <libtensor/linalg/linalg.h>
+#include "../block_tensor_ctrl.h"
+#include "../btod_multi_dotprod.h"
+
+namespace libtensor {
+
+
+template<size_t N>
+const char btod_multi_dotprod<N>::k_clazz[] = "btod_multi_dotprod<N>";
+
+
+namespace {
+
+
+template<size_t N>
+class btod_multi_dotprod_task : public libutil::task_i {
+private:
+    block_tensor_rd_ctrl<N, double> &m_cw;
+    const std::vector< block_tensor_rd_ctrl<N, double>* > &m_cv;
+    index<N> m_idx;
+    double m_wt;
+    double *m_d;
+
+public:
+    btod_multi_dotprod_task(block_tensor_rd_ctrl<N, double> &cw,
+        const std::vector< block_tensor_rd_ctrl<N, double>* > &cv,
+        const index<N> &idx, double wt, double *d) :
+        m_cw(cw), m_cv(cv), m_idx(idx), m_wt(wt), m_d(d)
+    { }
+
+    virtual ~btod_multi_dotprod_task() { }
+    virtual unsigned long get_cost() const { return 0; }
+    virtual void perform();
+
+};
+
+
+template<size_t N>
+class btod_multi_dotprod_task_iterator : public libutil::task_iterator_i {
+private:
+    block_tensor_rd_ctrl<N, double> &m_cw;
+    const std::vector< block_tensor_rd_ctrl<N, double>* > &m_cv;
+    const std::vector< index<N> > &m_blk;
+    const std::vector<double> &m_wt;
+    std::vector<double> &m_parts;
+    size_t m_i;
+
+public:
+    btod_multi_dotprod_task_iterator(block_tensor_rd_ctrl<N, double> &cw,
+        const std::vector< block_tensor_rd_ctrl<N, double>* > &cv,
+        const std::vector< index<N> > &blk, const std::vector<double> &wt,
+        std::vector<double> &parts) :
+        m_cw(cw), m_cv(cv), m_blk(blk), m_wt(wt), m_parts(parts), m_i(0)
+    { }
+
+    virtual bool has_more() const {
+        return m_i < m_blk.size();
+    }
+
+    virtual libutil::task_i *get_next() {
+        size_t i = m_i++;
+        return new btod_multi_dotprod_task<N>(m_cw, m_cv, m_blk[i], m_wt[i],
+            &m_parts[i * m_cv.size()]);
+    }
+
+};
+
+
+class btod_multi_dotprod_task_observer : public libutil::task_observer_i {
+public:
+    virtual void notify_start_task(libutil::task_i *t) { }
+    virtual void notify_finish_task(libutil::task_i *t) { delete t; }
+
+};
+
+
+} // unnamed namespace
+
+
+template<size_t N>
+btod_multi_dotprod<N>::btod_multi_dotprod(block_tensor_rd_i<N, double> &btw,
+    const std::vector<block_tensor_rd_i<N, double>*> &btv) :
+
+    m_btw(btw) {
+
+    for(size_t i = 0; i < btv.size(); i++) add_arg(*btv[i]);
+}
+
+
+template<size_t N>
+void btod_multi_dotprod<N>::add_arg(block_tensor_rd_i<N, double> &btv) {
+
+    static const char method[] = "add_arg()";
+
+    if(!btv.get_bis().equals(m_btw.get_bis())) {
+        throw bad_block_index_space(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "btv");
+    }
+    m_btv.push_back(&btv);
+}
+
+
+template<size_t N>
+void btod_multi_dotprod<N>::calculate(std::vector<double> &d) {
+
+    size_t nv = m_btv.size();
+    d.assign(nv, 0.0);
+    if(nv == 0) return;
+
+    btod_multi_dotprod<N>::start_timer();
+
+    block_tensor_rd_ctrl<N, double> cw(m_btw);
+    std::vector< block_tensor_rd_ctrl<N, double>* > cv(nv, 0);
+
+    try {
+
+        //  An argument that is w itself gets no controller, its blocks
+        //  are taken from w
+
+        for(size_t i = 0; i < nv; i++) {
+            if(m_btv[i] != &m_btw) {
+                cv[i] = new block_tensor_rd_ctrl<N, double>(*m_btv[i]);
+            }
+        }
+
+        //  Non-zero canonical blocks of w and their orbit sizes
+
+        const symmetry<N, double> &sym = cw.req_const_symmetry();
+        std::vector< index<N> > blk;
+        std::vector<double> wt;
+        orbit_list<N, double> ol(sym);
+        for(typename orbit_list<N, double>::iterator io = ol.begin();
+            io != ol.end(); ++io) {
+
+            index<N> idx;
+            ol.get_index(io, idx);
+            if(cw.req_is_zero_block(idx)) continue;
+            orbit<N, double> o(sym, idx);
+            blk.push_back(idx);
+            wt.push_back(double(o.get_size()));
+        }
+
+        //  Each task writes the partial sums of its block
+
+        std::vector<double> parts(blk.size() * nv, 0.0);
+        btod_multi_dotprod_task_iterator<N> ti(cw, cv, blk, wt, parts);
+        btod_multi_dotprod_task_observer to;
+        libutil::thread_pool::submit(ti, to);
+
+        for(size_t ib = 0; ib < blk.size(); ib++) {
+            for(size_t i = 0; i < nv; i++) d[i] += parts[ib * nv + i];
+        }
+
+    } catch(...) {
+        for(size_t i = 0; i < nv; i++) delete cv[i];
+        btod_multi_dotprod<N>::stop_timer();
+        throw;
+    }
+
+    for(size_t i = 0; i < nv; i++) delete cv[i];
+
+    btod_multi_dotprod<N>::stop_timer();
+}
+
+
+namespace {
+
+
+template<size_t N>
+void btod_multi_dotprod_task<N>::perform() {
+
+    //  The block of w is read once for all the arguments
+
+    dense_tensor_rd_i<N, double> &bw = m_cw.req_const_block(m_idx);
+    dense_tensor_rd_ctrl<N, double> cbw(bw);
+    const double *pw = cbw.req_const_dataptr();
+    size_t sz = bw.get_dims().get_size();
+
+    for(size_t i = 0; i < m_cv.size(); i++) {
+
+        if(m_cv[i] == 0) {
+            m_d[i] = m_wt * linalg::mul2_x_p_p(0, sz, pw, 1, pw, 1);
+            continue;
+        }
+        if(m_cv[i]->req_is_zero_block(m_idx)) continue;
+
+        dense_tensor_rd_i<N, double> &bv = m_cv[i]->req_const_block(m_idx);
+        {
+            dense_tensor_rd_ctrl<N, double> cbv(bv);
+            const double *pv = cbv.req_const_dataptr();
+            m_d[i] = m_wt * linalg::mul2_x_p_p(0, sz, pv, 1, pw, 1);
+            cbv.ret_const_dataptr(pv);
+        }
+        m_cv[i]->ret_const_block(m_idx);
+    }
+
+    cbw.ret_const_dataptr(pw);
+    m_cw.ret_const_block(m_idx);
+}
+
+
+} // unnamed namespace
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_MULTI_DOTPROD_IMPL_H
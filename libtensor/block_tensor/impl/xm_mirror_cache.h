@@ -0,0 +1,118 @@
+#ifndef LIBTENSOR_XM_MIRROR_CACHE_H
+#define LIBTENSOR_XM_MIRROR_CACHE_H
+
+#include <list>
+#include <memory>
+#include <libutil/singleton.h>
+#include <libutil/threads/mutex.h>
+#include <libtensor/libxm/src/xm.h>
+
+namespace libtensor {
+
+
+/** \brief Keeps libxm mirrors of block tensors between contractions
+
+    A mirror is an xm_tensor that describes the block space, the canonical
+    blocks and the derivative blocks (with their permutations and factors)
+    of a block tensor, and points to the data of the canonical blocks
+    directly. Building it walks every non-zero orbit of the tensor.
+    btod_contract2_xm keeps the mirrors of its arguments here, so that
+    repeated contractions of the same tensors build them only once.
+
+    A mirror is stored along with the structure version of its tensor
+    (gen_block_tensor_rd_i::on_req_structure_version()) and is only reused
+    while the version stays the same, i.e. until the symmetry of the tensor
+    is requested for writing or a block is created or zeroed. Changes to
+    the contents of existing blocks do not invalidate a mirror. Versions
+    are never shared between tensors, so a mirror is never picked up by
+    another tensor, even at the same address. The cache holds up to
+    k_maxmirrors mirrors and drops the least recently used one.
+
+    Mirrors are handed out as shared pointers, so a mirror that is dropped
+    from the cache remains valid while it is in use.
+
+    The cache also collects statistics: the numbers of hits and misses,
+    the time spent building mirrors, and the time saved by the hits (the
+    build time of each reused mirror, once for every reuse).
+
+    \sa btod_contract2_xm
+
+    \ingroup libtensor_block_tensor_btod
+ **/
+class xm_mirror_cache : public libutil::singleton<xm_mirror_cache> {
+    friend class libutil::singleton<xm_mirror_cache>;
+
+public:
+    enum {
+        k_maxmirrors = 16 //!< Maximum number of mirrors kept
+    };
+
+    typedef std::shared_ptr<xm_tensor_t> mirror_ptr; //!< Pointer to mirror
+
+private:
+    struct entry {
+        const void *bt; //!< Block tensor
+        size_t version; //!< Structure version of the block tensor
+        xm_allocator_t *allocator; //!< Allocator of the mirror
+        mirror_ptr mirror; //!< Mirror
+        double build_time; //!< Time taken to build the mirror (s)
+    };
+
+private:
+    bool m_enabled; //!< Whether mirrors are cached
+    libutil::mutex m_lock; //!< Lock
+    std::list<entry> m_entries; //!< Mirrors, most recently used first
+    size_t m_nhits; //!< Number of hits
+    size_t m_nmisses; //!< Number of misses
+    double m_build_time; //!< Time spent building mirrors (s)
+    double m_saved_time; //!< Build time saved by hits (s)
+
+protected:
+    xm_mirror_cache();
+
+public:
+    static void enable();
+    static void disable();
+    static bool is_enabled();
+
+    /** \brief Returns the mirror of a block tensor if the structure of the
+            tensor has not changed since it was built, null otherwise
+        \param bt Block tensor.
+        \param version Current structure version of the block tensor.
+        \param allocator Allocator.
+     **/
+    mirror_ptr find(const void *bt, size_t version, xm_allocator_t *allocator);
+
+    /** \brief Stores the mirror of a block tensor (replaces the one built
+            for an older version)
+        \param bt Block tensor.
+        \param version Structure version the mirror was built for.
+        \param allocator Allocator.
+        \param mirror Mirror.
+        \param build_time Time taken to build the mirror (s).
+     **/
+    void insert(const void *bt, size_t version, xm_allocator_t *allocator,
+        const mirror_ptr &mirror, double build_time);
+
+    /** \brief Records the time taken to build a mirror that is not cached
+     **/
+    void add_build_time(double build_time);
+
+    /** \brief Drops all mirrors
+     **/
+    void clear();
+
+    //! \name Statistics
+    //@{
+    size_t get_nhits();
+    size_t get_nmisses();
+    double get_build_time();
+    double get_saved_time();
+    void reset_stats();
+    //@}
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_XM_MIRROR_CACHE_H
@@ -0,0 +1,117 @@
+#ifndef LIBTENSOR_BTOD_CHOLESKY_H
+#define LIBTENSOR_BTOD_CHOLESKY_H
+
+#include <vector>
+#include <libtensor/timings.h>
+#include <libtensor/core/block_index_space.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/block_tensor/block_tensor_i.h>
+
+namespace libtensor {
+
+
+/** \brief Pivoted Cholesky decomposition of a 4-index block tensor
+
+    Decomposes a tensor that is symmetric and positive semi-definite as a
+    matrix of index pairs, such as the two-electron integrals (pq|rs),
+    into three-index factors:
+    \f[ (pq|rs) \approx \sum_L B_{pqL} B_{rsL} \f]
+
+    The decomposition is the usual pivoted (incomplete) Cholesky
+    algorithm. It starts from the diagonal (pq|pq), and at each step takes
+    the pair rs with the largest remaining diagonal as the pivot. The
+    column (pq|rs) of the pivot is read from the block tensor, the
+    previous vectors are projected out, and the result becomes the next
+    vector. The iterations stop once the largest remaining diagonal, which
+    bounds the error of every element, falls to the tolerance. Columns
+    and the diagonal are read by btod_extract and btod_diag, so the block
+    structure and the symmetry of the input are respected. Only the
+    diagonal and the vectors are kept in memory, which is
+    O(N<sup>2</sup> L) for L vectors.
+
+    The factor has the same block structure as the first two indexes of
+    the input, the third index is split into blocks of a given size.
+    Permutational symmetry of the first two indexes (e.g. (pq|rs) =
+    (qp|rs)) is carried over to the factor, and only its canonical blocks
+    are written. Other symmetry elements of the input are not carried
+    over because the irreducible representation of a vector depends on
+    its pivot.
+
+    \code
+    btod_cholesky op(bt_eri, 1e-8);
+    op.decompose();
+    block_tensor<3, double, allocator_t> bt_b(op.get_bis());
+    op.perform(bt_b);
+    btod_cholesky::reconstruct(bt_b, bt_eri_approx);
+    \endcode
+
+    \ingroup libtensor_btod
+ **/
+class btod_cholesky : public timings<btod_cholesky>, public noncopyable {
+public:
+    static const char k_clazz[]; //!< Class name
+
+private:
+    block_tensor_rd_i<4, double> &m_bta; //!< Input tensor
+    double m_tol; //!< Tolerance of the largest residual diagonal
+    size_t m_lsplit; //!< Block size of the factor index
+    size_t m_maxrank; //!< Largest number of vectors (0 - no limit)
+    bool m_done; //!< Whether the decomposition has been done
+    size_t m_rank; //!< Number of vectors
+    double m_maxres; //!< Largest residual diagonal
+    std::vector<double> m_vec; //!< Vectors, one after another
+    std::vector<size_t> m_piv; //!< Pivot of each vector (absolute pq)
+
+public:
+    /** \brief Initializes the operation
+        \param bta Input tensor (pq|rs).
+        \param tol Tolerance of the largest residual diagonal.
+        \param lsplit Block size of the factor index.
+        \param maxrank Largest number of vectors (zero for no limit).
+     **/
+    btod_cholesky(block_tensor_rd_i<4, double> &bta, double tol = 1e-8,
+        size_t lsplit = 32, size_t maxrank = 0);
+
+    /** \brief Computes the vectors, does nothing if they are there
+     **/
+    void decompose();
+
+    /** \brief Returns the number of vectors (decomposes if necessary)
+     **/
+    size_t get_rank();
+
+    /** \brief Returns the largest residual diagonal, which is the largest
+            error of any element of the reconstructed tensor
+     **/
+    double get_max_residual();
+
+    /** \brief Returns the pivots (pairs rs as absolute indexes r * n + s)
+     **/
+    const std::vector<size_t> &get_pivots();
+
+    /** \brief Returns the block index space of the factor B_{pqL}
+
+        The third dimension has the size of the rank, but at least one.
+     **/
+    block_index_space<3> get_bis();
+
+    /** \brief Writes the factor B_{pqL}
+        \param btb Output tensor, its block index space must be get_bis().
+     **/
+    void perform(block_tensor_i<3, double> &btb);
+
+    /** \brief Reconstructs the tensor from a factor using btod_contract2
+        \param btb Factor B_{pqL}.
+        \param btc Output tensor (pq|rs).
+     **/
+    static void reconstruct(block_tensor_rd_i<3, double> &btb,
+        block_tensor_i<4, double> &btc);
+
+private:
+    void check_input();
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_CHOLESKY_H
@@ -0,0 +1,68 @@
+#ifndef LIBTENSOR_BLAS_THREADING_POLICY_H
+#define LIBTENSOR_BLAS_THREADING_POLICY_H
+
+#include <cstdlib> // for size_t
+#include <vector>
+#include <libutil/singleton.h>
+
+namespace libtensor {
+
+
+/** \brief Splits CPUs between pool tasks and threaded BLAS
+
+    A batch of block operations runs on the thread pool one task per block.
+    If the batch has many small tasks, each task shall call single-threaded
+    BLAS, otherwise pool threads and BLAS threads oversubscribe the CPUs.
+    If the batch is dominated by a few huge tasks, running them on one pool
+    thread each leaves the other CPUs idle, so these tasks shall instead
+    call multithreaded BLAS.
+
+    A task is huge if its cost is at least the minimum cost and at least
+    the average cost per CPU of the whole batch. When fewer than ncpus
+    tasks are huge, they run together with ncpus / nhuge BLAS threads each,
+    and the remaining tasks run afterwards with one BLAS thread.
+
+    The policy is only applied when a thread pool is associated with the
+    calling thread; serial runs keep the BLAS setting of the user.
+
+    \sa gen_bto_contract2_batch, BlasThreads
+
+    \ingroup libtensor_core
+ **/
+class blas_threading_policy : public libutil::singleton<blas_threading_policy> {
+    friend class libutil::singleton<blas_threading_policy>;
+
+private:
+    bool m_enabled; //!< Policy is applied
+    unsigned long m_min_cost; //!< Minimum cost of huge task
+
+protected:
+    blas_threading_policy();
+
+public:
+    static void enable();
+    static void disable();
+    static bool is_enabled();
+
+    /** \brief Sets the minimum cost of a task that may use threaded BLAS
+            (in the units of task costs, for contractions about 1000
+            multiply-adds)
+     **/
+    static void set_min_cost(unsigned long cost);
+    static unsigned long get_min_cost();
+
+    /** \brief Selects huge tasks in a batch
+        \param costs Costs of tasks.
+        \param ncpus Number of CPUs available.
+        \param[out] huge Flags of huge tasks.
+        \return Number of BLAS threads for huge tasks (zero if there are
+            none or the policy is disabled).
+     **/
+    static size_t plan(const std::vector<unsigned long> &costs, size_t ncpus,
+        std::vector<bool> &huge);
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BLAS_THREADING_POLICY_H
@@ -0,0 +1,181 @@
+#ifndef LIBTENSOR_BLOCK_COMPRESSION_H
+#define LIBTENSOR_BLOCK_COMPRESSION_H
+
+#include <complex>
+#include <cstddef>
+
+namespace libtensor {
+
+
+/** \brief How the blocks of a tensor are compressed in cold storage
+
+    \sa block_compression
+
+    \ingroup libtensor_core
+ **/
+struct block_compression_policy {
+    int mode; //!< Compression mode (block_compression::NONE, ...)
+    double tol; //!< Absolute error bound of the lossy mode
+
+    block_compression_policy(int mode_ = 0, double tol_ = 0.0) :
+        mode(mode_), tol(tol_) { }
+
+    bool operator==(const block_compression_policy &other) const {
+        return mode == other.mode && tol == other.tol;
+    }
+};
+
+
+/** \brief Number of doubles per element, zero if the lossy mode does not
+        apply to the type
+
+    \ingroup libtensor_core
+ **/
+template<typename T>
+struct block_compression_traits {
+    enum { k_ndoubles = 0 };
+};
+
+template<>
+struct block_compression_traits<double> {
+    enum { k_ndoubles = 1 };
+};
+
+template<>
+struct block_compression_traits< std::complex<double> > {
+    enum { k_ndoubles = 2 };
+};
+
+
+/** \brief Transparent compression of tensor blocks written to disk
+
+    Allocators that keep blocks out of core (\sa lt_xm_allocator) compress
+    the data of a block when it is written back and expand it when it is
+    read again. Which blocks are compressed, and how, is decided by the
+    policy in effect when the block is allocated:
+    - NONE -- blocks are stored as they are (default).
+    - LOSSLESS -- the bytes of the elements are regrouped by significance
+        (byte shuffle) and run-length encoded. Zero and smooth blocks, and
+        blocks of small integers, shrink considerably.
+    - LOSSY -- the mantissas of double precision elements are rounded to
+        the fewest bits that keep the absolute error within the tolerance,
+        elements smaller than the tolerance become zero, then the lossless
+        stage is applied. For other element types this is the same as
+        LOSSLESS.
+
+    A block that does not get smaller is stored raw.
+
+    The policy is the default set by set_default() unless a scope object
+    overrides it on the calling thread. Block tensors carry their own
+    policy (gen_block_tensor::set_compression()), which is put in scope
+    whenever they create a block.
+
+    The number of compressed blocks, the raw and the stored number of
+    bytes, and the time spent compressing and expanding are counted for
+    all tensors together.
+
+    \ingroup libtensor_core
+ **/
+class block_compression {
+public:
+    enum {
+        NONE = 0, //!< No compression
+        LOSSLESS = 1, //!< Byte shuffle and run-length encoding
+        LOSSY = 2 //!< Mantissa rounding within tolerance, then lossless
+    };
+
+    /** \brief Sets the compression policy on the calling thread for the
+            lifetime of the object
+     **/
+    class scope {
+    private:
+        block_compression_policy m_prev; //!< Policy before this scope
+        bool m_prev_set; //!< Whether there was a scope before
+
+    public:
+        scope(const block_compression_policy &p);
+        ~scope();
+
+    private:
+        scope(const scope&);
+        const scope &operator=(const scope&);
+    };
+
+public:
+    /** \brief Sets the policy for blocks allocated outside of any scope
+     **/
+    static void set_default(const block_compression_policy &p);
+
+    /** \brief Returns the policy in effect on the calling thread
+     **/
+    static block_compression_policy get_policy();
+
+    /** \brief Compresses a block
+        \param p Policy (mode and tolerance).
+        \param ndoubles Doubles per element (\sa block_compression_traits).
+        \param data Elements.
+        \param nelem Number of elements.
+        \param elsize Size of one element in bytes.
+        \param out Output buffer, at least nelem * elsize bytes.
+        \return Number of bytes written to out or zero if the block does
+            not get smaller.
+     **/
+    static size_t compress(const block_compression_policy &p,
+        size_t ndoubles, const void *data, size_t nelem, size_t elsize,
+        unsigned char *out);
+
+    /** \brief Expands a block compressed by compress()
+        \param in Compressed data.
+        \param nin Size of compressed data in bytes.
+        \param data Output elements.
+        \param nelem Number of elements.
+        \param elsize Size of one element in bytes.
+        \return False if the compressed data are malformed.
+     **/
+    static bool decompress(const unsigned char *in, size_t nin, void *data,
+        size_t nelem, size_t elsize);
+
+    //!    \name Statistics
+    //@{
+
+    /** \brief Returns the number of blocks passed to compress()
+     **/
+    static size_t get_nblocks();
+
+    /** \brief Returns the size of the blocks passed to compress()
+     **/
+    static size_t get_raw_bytes();
+
+    /** \brief Returns the size of the same blocks as stored (raw size for
+            blocks that did not get smaller)
+     **/
+    static size_t get_stored_bytes();
+
+    /** \brief Returns the compression ratio (raw over stored bytes) or one
+            if nothing was compressed
+     **/
+    static double get_ratio();
+
+    /** \brief Returns the time spent compressing (seconds)
+     **/
+    static double get_compress_time();
+
+    /** \brief Returns the time spent expanding (seconds)
+     **/
+    static double get_decompress_time();
+
+    /** \brief Returns the number of bytes expanded
+     **/
+    static size_t get_decompressed_bytes();
+
+    /** \brief Resets the counters
+     **/
+    static void reset_stats();
+
+    //@}
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BLOCK_COMPRESSION_H
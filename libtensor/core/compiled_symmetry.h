@@ -0,0 +1,154 @@
+#ifndef LIBTENSOR_COMPILED_SYMMETRY_H
+#define LIBTENSOR_COMPILED_SYMMETRY_H
+
+#include <cstdlib> // for size_t
+#include <vector>
+#include <libutil/singleton.h>
+#include <libtensor/timings.h>
+#include "dimensions.h"
+#include "noncopyable.h"
+#include "symmetry.h"
+#include "tensor_transf.h"
+
+namespace libtensor {
+
+
+/** \brief Limits of compiled symmetries
+
+    Sets the largest number of blocks in a block index space for which
+    compiled_symmetry tabulates the orbits (default 2^20 blocks, about
+    21 bytes per block).
+
+    The limit shall only be changed between block tensor operations.
+
+    \sa compiled_symmetry
+
+    \ingroup libtensor_core
+ **/
+class compiled_symmetry_limits :
+    public libutil::singleton<compiled_symmetry_limits> {
+
+    friend class libutil::singleton<compiled_symmetry_limits>;
+
+private:
+    size_t m_max_blocks; //!< Maximum number of blocks in a table
+
+protected:
+    compiled_symmetry_limits();
+
+public:
+    /** \brief Sets the maximum number of blocks for which the orbits are
+            tabulated (zero disables the tables)
+     **/
+    static void set_max_blocks(size_t n);
+    static size_t get_max_blocks();
+};
+
+
+/** \brief Symmetry group compiled into a table of orbits
+    \tparam N Tensor order.
+    \tparam T Tensor element type.
+
+    orbit and short_orbit find the canonical index of a block by applying
+    every element of the symmetry group through the virtual interface
+    symmetry_element_i, which is repeated for every block index that is
+    looked up. Loops over the blocks of a result, like the search for
+    non-zero canonical blocks of a contraction, do this millions of times
+    for the same small set of orbits.
+
+    This class runs the orbit algorithm once for each orbit of the block
+    index space and keeps for every block its canonical index, the tensor
+    transformation from the canonical block (stored once for all blocks
+    that share it), whether the orbit is allowed, and the link to the next
+    block in the same orbit. All queries then take constant time.
+
+    Block index spaces with more blocks than the limit (\sa
+    compiled_symmetry_limits) are not tabulated. In that case nothing is
+    stored and each query runs short_orbit or orbit, so the class can be
+    used the same way regardless of the size.
+
+    The symmetry must not be changed or destroyed while this object is in
+    use. Queries are thread-safe.
+
+    \sa orbit, short_orbit
+
+    \ingroup libtensor_core
+ **/
+template<size_t N, typename T>
+class compiled_symmetry :
+    public noncopyable, public timings< compiled_symmetry<N, T> > {
+
+public:
+    static const char *k_clazz; //!< Class name
+
+public:
+    typedef tensor_transf<N, T> tensor_transf_type;
+
+private:
+    const symmetry<N, T> &m_sym; //!< Symmetry group
+    dimensions<N> m_bidims; //!< Block index dimensions
+    bool m_tab; //!< Whether the orbits are tabulated
+    std::vector<size_t> m_acidx; //!< Canonical index of each block
+    std::vector<size_t> m_next; //!< Next block in the orbit
+    std::vector<unsigned> m_itr; //!< Number of transformation of each block
+    std::vector<char> m_allowed; //!< Whether the orbit of block is allowed
+    std::vector<tensor_transf_type> m_tr; //!< Unique transformations
+
+public:
+    /** \brief Compiles the symmetry group
+        \param sym Symmetry group.
+     **/
+    compiled_symmetry(const symmetry<N, T> &sym);
+
+    /** \brief Returns true if the orbits are tabulated
+     **/
+    bool is_tabulated() const {
+        return m_tab;
+    }
+
+    /** \brief Returns the block index dimensions
+     **/
+    const dimensions<N> &get_bidims() const {
+        return m_bidims;
+    }
+
+    /** \brief Returns the absolute value of the canonical index of the orbit
+            of a block
+        \param aidx Absolute value of block index.
+     **/
+    size_t get_acindex(size_t aidx) const;
+
+    /** \brief Returns true if the block is canonical
+        \param aidx Absolute value of block index.
+     **/
+    bool is_canonical(size_t aidx) const {
+        return get_acindex(aidx) == aidx;
+    }
+
+    /** \brief Returns true if the orbit of a block is allowed by symmetry
+        \param aidx Absolute value of block index.
+     **/
+    bool is_allowed(size_t aidx) const;
+
+    /** \brief Returns the transformation of the canonical block of the orbit
+            that yields the block
+        \param aidx Absolute value of block index.
+     **/
+    tensor_transf_type get_transf(size_t aidx) const;
+
+    /** \brief Returns the sorted absolute indexes of all the blocks in the
+            orbit of a block
+        \param aidx Absolute value of block index.
+        \param[out] orb Blocks of the orbit.
+     **/
+    void get_orbit(size_t aidx, std::vector<size_t> &orb) const;
+
+private:
+    void build();
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_COMPILED_SYMMETRY_H
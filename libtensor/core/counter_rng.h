@@ -0,0 +1,89 @@
+#ifndef LIBTENSOR_COUNTER_RNG_H
+#define LIBTENSOR_COUNTER_RNG_H
+
+#include <atomic>
+#include <cstdlib> // for size_t
+#include <stdint.h>
+#include <libutil/singleton.h>
+
+namespace libtensor {
+
+
+/** \brief Counter-based random number generator
+
+    Generates random numbers equally distributed in [0;1[ with
+    the Philox4x32-10 function of the key and a counter. The key is made of
+    the seed, the stream number and the substream number, the counter is
+    the position of the number in the substream. Since every number depends
+    only on these values, the numbers of a substream can be generated
+    in any order and by any thread with the same result.
+
+    Operations that fill tensors with random numbers take a new stream from
+    next_stream() (a running number reset by set_seed()) and use substreams
+    for the parts of the tensor, like the blocks of a block tensor. So
+    the same sequence of operations after set_seed() gives the same numbers
+    for any number of threads.
+
+    The generation is written as a loop over batches of counters, which
+    the compiler vectorizes.
+
+    The seed shall only be changed between operations.
+
+    \ingroup libtensor_core
+ **/
+class counter_rng : public libutil::singleton<counter_rng> {
+
+    friend class libutil::singleton<counter_rng>;
+
+private:
+    uint64_t m_seed; //!< Seed
+    std::atomic<uint64_t> m_nstreams; //!< Number of streams taken
+
+protected:
+    counter_rng();
+
+public:
+    /** \brief Sets the seed and restarts the streams
+     **/
+    static void set_seed(uint64_t seed);
+
+    /** \brief Returns the seed
+     **/
+    static uint64_t get_seed();
+
+    /** \brief Returns the number of a new stream
+     **/
+    static uint64_t next_stream();
+
+    /** \brief Generates the beginning of a substream scaled by
+            a coefficient: \f$ a_i = c r_i \f$
+        \param stream Stream number.
+        \param substream Substream number.
+        \param ni Number of elements i.
+        \param a Pointer to a.
+        \param c Scaling coefficient.
+     **/
+    static void set_i_x(uint64_t stream, uint64_t substream, size_t ni,
+        double *a, double c);
+
+    /** \brief Adds the beginning of a substream scaled by a coefficient:
+            \f$ a_i = a_i + c r_i \f$
+        \param stream Stream number.
+        \param substream Substream number.
+        \param ni Number of elements i.
+        \param a Pointer to a.
+        \param c Scaling coefficient.
+     **/
+    static void add_i_x(uint64_t stream, uint64_t substream, size_t ni,
+        double *a, double c);
+
+private:
+    static void generate(uint64_t stream, uint64_t substream, size_t ni,
+        double *a, double c, bool add);
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_COUNTER_RNG_H
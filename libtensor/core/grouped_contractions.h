@@ -0,0 +1,57 @@
+#ifndef LIBTENSOR_GROUPED_CONTRACTIONS_H
+#define LIBTENSOR_GROUPED_CONTRACTIONS_H
+
+#include <cstdlib> // for size_t
+#include <libutil/singleton.h>
+
+namespace libtensor {
+
+
+/** \brief Switches block contractions to grouped execution
+
+    Block tensors with fine symmetry partitions produce thousands of tiny
+    block contractions, for which setting up the loops and matching the
+    kernel costs more than the multiplication itself. In the grouped mode
+    consecutive small result blocks of a batch (cost at most the maximum
+    cost, at most the maximum number of blocks) are computed by one task.
+    Their block products are gathered by shape, and each group is set up
+    once and run as a batched GEMM (see tod_contract2_batch).
+
+    The mode shall only be changed between block tensor operations.
+
+    \sa gen_bto_contract2_batch, tod_contract2_batch
+
+    \ingroup libtensor_core
+ **/
+class grouped_contractions : public libutil::singleton<grouped_contractions> {
+    friend class libutil::singleton<grouped_contractions>;
+
+private:
+    bool m_enabled; //!< Grouped mode is on
+    unsigned long m_max_cost; //!< Maximum cost of grouped block
+    size_t m_max_blocks; //!< Maximum number of blocks in group
+
+protected:
+    grouped_contractions();
+
+public:
+    static void enable();
+    static void disable();
+    static bool is_enabled();
+
+    /** \brief Sets the maximum cost of a result block that is grouped with
+            others (in the units of task costs, about 1000 multiply-adds)
+     **/
+    static void set_max_cost(unsigned long cost);
+    static unsigned long get_max_cost();
+
+    /** \brief Sets the maximum number of result blocks per group
+     **/
+    static void set_max_blocks(size_t n);
+    static size_t get_max_blocks();
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_GROUPED_CONTRACTIONS_H
@@ -0,0 +1,125 @@
+#ifndef LIBTENSOR_COMPILED_SYMMETRY_IMPL_H
+#define LIBTENSOR_COMPILED_SYMMETRY_IMPL_H
+
+#include "../compiled_symmetry.h"
+#include "../orbit.h"
+#include "../short_orbit.h"
+
+namespace libtensor {
+
+
+template<size_t N, typename T>
+const char *compiled_symmetry<N, T>::k_clazz = "compiled_symmetry<N, T>";
+
+
+template<size_t N, typename T>
+compiled_symmetry<N, T>::compiled_symmetry(const symmetry<N, T> &sym) :
+
+    m_sym(sym), m_bidims(sym.get_bis().get_block_index_dims()),
+    m_tab(m_bidims.get_size() <= compiled_symmetry_limits::get_max_blocks()) {
+
+    if(m_tab) build();
+}
+
+
+template<size_t N, typename T>
+size_t compiled_symmetry<N, T>::get_acindex(size_t aidx) const {
+
+    if(m_tab) return m_acidx[aidx];
+    return short_orbit<N, T>(m_sym, aidx).get_acindex();
+}
+
+
+template<size_t N, typename T>
+bool compiled_symmetry<N, T>::is_allowed(size_t aidx) const {
+
+    if(m_tab) return m_allowed[aidx] != 0;
+    return short_orbit<N, T>(m_sym, aidx, true).is_allowed();
+}
+
+
+template<size_t N, typename T>
+typename compiled_symmetry<N, T>::tensor_transf_type
+compiled_symmetry<N, T>::get_transf(size_t aidx) const {
+
+    if(m_tab) return m_tr[m_itr[aidx]];
+    return orbit<N, T>(m_sym, aidx, false).get_transf(aidx);
+}
+
+
+template<size_t N, typename T>
+void compiled_symmetry<N, T>::get_orbit(size_t aidx,
+    std::vector<size_t> &orb) const {
+
+    orb.clear();
+    if(m_tab) {
+        size_t n = m_acidx.size();
+        for(size_t i = m_acidx[aidx]; i != n; i = m_next[i]) orb.push_back(i);
+    } else {
+        orbit<N, T> o(m_sym, aidx, false);
+        orb.reserve(o.get_size());
+        for(typename orbit<N, T>::iterator i = o.begin(); i != o.end(); ++i) {
+            orb.push_back(o.get_abs_index(i));
+        }
+    }
+}
+
+
+template<size_t N, typename T>
+void compiled_symmetry<N, T>::build() {
+
+    compiled_symmetry::start_timer();
+
+    try {
+
+        size_t n = m_bidims.get_size();
+
+        //  n marks blocks not yet visited and the end of each orbit
+        m_acidx.assign(n, n);
+        m_next.assign(n, n);
+        m_itr.assign(n, 0);
+        m_allowed.assign(n, 0);
+
+        //  The first block of an orbit met in the ascending order
+        //  is canonical
+        for(size_t aidx = 0; aidx < n; aidx++) {
+
+            if(m_acidx[aidx] != n) continue;
+
+            orbit<N, T> o(m_sym, aidx, true);
+            char allowed = o.is_allowed() ? 1 : 0;
+            size_t prev = n;
+            for(typename orbit<N, T>::iterator i = o.begin(); i != o.end();
+                ++i) {
+
+                size_t aidx1 = o.get_abs_index(i);
+                const tensor_transf_type &tr = o.get_transf(i);
+
+                //  Few distinct transformations, most recent ones first
+                size_t itr = m_tr.size();
+                while(itr > 0 && m_tr[itr - 1] != tr) itr--;
+                if(itr == 0) {
+                    m_tr.push_back(tr);
+                    itr = m_tr.size();
+                }
+
+                m_acidx[aidx1] = aidx;
+                m_itr[aidx1] = unsigned(itr - 1);
+                m_allowed[aidx1] = allowed;
+                if(prev != n) m_next[prev] = aidx1;
+                prev = aidx1;
+            }
+        }
+
+    } catch(...) {
+        compiled_symmetry::stop_timer();
+        throw;
+    }
+
+    compiled_symmetry::stop_timer();
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_COMPILED_SYMMETRY_IMPL_H
@@ -2,6 +2,7 @@
 #define LIBTENSOR_XM_ALLOCATOR_H
 
 #include <libtensor/core/batching_policy_base.h>
+#include <libtensor/core/block_compression.h>
 #include <libtensor/defs.h>
 #include <libtensor/libxm/src/alloc.h>
 #include <libutil/singleton.h>
@@ -19,6 +20,9 @@ struct map_data {
     size_t size_bytes;
     int n_locks;
     void *lock_ptr;
+    unsigned long gen; //!< Changes whenever the data on disk changes
+    block_compression_policy cpolicy; //!< Compression on write
+    size_t stored_bytes; //!< Size on disk if compressed, zero if raw
 };
 typedef std::map<uintptr_t, map_data> map_type;
 
@@ -28,6 +32,10 @@ public:
     struct xm_allocator *xm_allocator_inst;
     libutil::mutex g_lock;
     map_type g_map;
+    unsigned long g_gen;
+
+protected:
+    alloc_data() : xm_allocator_inst(NULL), g_gen(0) { }
 };
 
 template<typename T>
@@ -89,6 +97,9 @@ public:
         data.size_bytes = get_block_size(sz);
         data.lock_ptr = NULL;
         data.n_locks = 0;
+        data.gen = ++alloc_data::get_instance().g_gen;
+        data.cpolicy = block_compression::get_policy();
+        data.stored_bytes = 0;
         pointer_type p = xm_allocator_allocate(alloc_data::get_instance().xm_allocator_inst, data.size_bytes);
         if (p == XM_NULL_PTR)
             throw std::runtime_error("allocate: unable to allocate memory");
@@ -123,27 +134,53 @@ public:
     }
 
     /** \brief Locks a block of memory in physical space for read-only
-            (does nothing in this implementation)
         \param p Pointer to the block of memory.
         \return Constant physical pointer to the memory.
+
+        The block is read from the pagefile without holding the allocator
+        lock, so threads locking different blocks do not wait for each
+        other's disk reads. If the block is written back in the meantime,
+        the read is repeated. Compressed blocks are expanded here as well.
      **/
     static const T *lock_ro(pointer_type p) {
-        if (xm_allocator_get_path(alloc_data::get_instance().xm_allocator_inst) == NULL)
+        alloc_data &ad = alloc_data::get_instance();
+        if (xm_allocator_get_path(ad.xm_allocator_inst) == NULL)
             return (const T *)p;
 
-        libutil::auto_lock<libutil::mutex> lock(alloc_data::get_instance().g_lock);
-        map_type::iterator it = alloc_data::get_instance().g_map.find(p);
-        if (it == alloc_data::get_instance().g_map.end())
-            throw std::runtime_error("lock_ro: pointer not allocated");
-        if (it->second.lock_ptr == NULL) {
-            it->second.lock_ptr = malloc(it->second.size_bytes);
-            if (it->second.lock_ptr == NULL)
+        void *buf = NULL;
+        size_t size_bytes = 0, stored_bytes = 0;
+        unsigned long gen = 0;
+        bool ok = true;
+        while (true) {
+            {
+                libutil::auto_lock<libutil::mutex> lock(ad.g_lock);
+                map_type::iterator it = ad.g_map.find(p);
+                if (it == ad.g_map.end()) {
+                    free(buf);
+                    throw std::runtime_error("lock_ro: pointer not allocated");
+                }
+                if (it->second.lock_ptr != NULL) {
+                    free(buf);
+                    it->second.n_locks++;
+                    return (const T *)it->second.lock_ptr;
+                }
+                if (buf != NULL && it->second.gen == gen) {
+                    if (!ok) {
+                        free(buf);
+                        throw std::runtime_error("lock_ro: bad compressed block");
+                    }
+                    it->second.lock_ptr = buf;
+                    it->second.n_locks++;
+                    return (const T *)buf;
+                }
+                size_bytes = it->second.size_bytes;
+                stored_bytes = it->second.stored_bytes;
+                gen = it->second.gen;
+            }
+            if (buf == NULL && (buf = malloc(size_bytes)) == NULL)
                 throw std::runtime_error("lock_ro: out of memory");
-            xm_allocator_read(alloc_data::get_instance().xm_allocator_inst, p,
-		it->second.lock_ptr, it->second.size_bytes);
+            ok = read_block(p, buf, size_bytes, stored_bytes);
         }
-        it->second.n_locks++;
-        return (const T *)it->second.lock_ptr;
     }
 
     /** \brief Unlocks a block of memory previously locked by lock_ro()
@@ -196,13 +233,50 @@ public:
             throw std::runtime_error("unlock_rw: block not locked");
         it->second.n_locks--;
         if (it->second.n_locks == 0) {
-            xm_allocator_write(alloc_data::get_instance().xm_allocator_inst, p,
-	        it->second.lock_ptr, it->second.size_bytes);
+            write_block(p, it->second);
+            it->second.gen = ++alloc_data::get_instance().g_gen;
             free(it->second.lock_ptr);
             it->second.lock_ptr = NULL;
         }
     }
 
+    /** \brief Stores a block uncompressed from now on
+        \param p Pointer to a block of memory.
+
+        Code that reads or writes the pagefile directly (libxm contractions)
+        calls this for every block it is given.
+     **/
+    static void expand(pointer_type p) {
+        alloc_data &ad = alloc_data::get_instance();
+        if (ad.xm_allocator_inst == NULL ||
+            xm_allocator_get_path(ad.xm_allocator_inst) == NULL)
+            return;
+
+        libutil::auto_lock<libutil::mutex> lock(ad.g_lock);
+        map_type::iterator it = ad.g_map.find(p);
+        if (it == ad.g_map.end())
+            throw std::runtime_error("expand: pointer not allocated");
+        map_data &data = it->second;
+        data.cpolicy = block_compression_policy();
+        if (data.stored_bytes == 0)
+            return;
+        if (data.lock_ptr != NULL) {
+            write_block(p, data);
+        } else {
+            void *buf = malloc(data.size_bytes);
+            if (buf == NULL)
+                throw std::runtime_error("expand: out of memory");
+            if (!read_block(p, buf, data.size_bytes, data.stored_bytes)) {
+                free(buf);
+                throw std::runtime_error("expand: bad compressed block");
+            }
+            xm_allocator_write(ad.xm_allocator_inst, p, buf, data.size_bytes);
+            data.stored_bytes = 0;
+            free(buf);
+        }
+        data.gen = ++ad.g_gen;
+    }
+
     /** \brief Sets a priority flag on a memory block (stub)
         \param p Pointer to a block of memory.
      **/
@@ -216,6 +290,49 @@ public:
     static void unset_priority(pointer_type p) {
 
     }
+
+private:
+    /** \brief Reads a block from the pagefile, expands it if it is stored
+            compressed, returns false if it cannot be expanded
+     **/
+    static bool read_block(pointer_type p, void *buf, size_t size_bytes,
+        size_t stored_bytes) {
+        alloc_data &ad = alloc_data::get_instance();
+        if (stored_bytes == 0) {
+            xm_allocator_read(ad.xm_allocator_inst, p, buf, size_bytes);
+            return true;
+        }
+        unsigned char *cbuf = (unsigned char *)malloc(stored_bytes);
+        if (cbuf == NULL)
+            throw std::runtime_error("read_block: out of memory");
+        xm_allocator_read(ad.xm_allocator_inst, p, cbuf, stored_bytes);
+        bool ok = block_compression::decompress(cbuf, stored_bytes, buf,
+            size_bytes / sizeof(T), sizeof(T));
+        free(cbuf);
+        return ok;
+    }
+
+    /** \brief Writes the locked copy of a block to the pagefile, compressed
+            if the policy of the block says so and it gets smaller
+     **/
+    static void write_block(pointer_type p, map_data &data) {
+        alloc_data &ad = alloc_data::get_instance();
+        unsigned char *cbuf = NULL;
+        size_t nc = 0;
+        if (data.cpolicy.mode != block_compression::NONE &&
+            (cbuf = (unsigned char *)malloc(data.size_bytes)) != NULL) {
+            nc = block_compression::compress(data.cpolicy,
+                block_compression_traits<T>::k_ndoubles, data.lock_ptr,
+                data.size_bytes / sizeof(T), sizeof(T), cbuf);
+        }
+        if (nc > 0)
+            xm_allocator_write(ad.xm_allocator_inst, p, cbuf, nc);
+        else
+            xm_allocator_write(ad.xm_allocator_inst, p, data.lock_ptr,
+                data.size_bytes);
+        data.stored_bytes = nc;
+        free(cbuf);
+    }
 };
 
 template<typename T>
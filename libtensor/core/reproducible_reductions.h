@@ -0,0 +1,48 @@
+#ifndef LIBTENSOR_REPRODUCIBLE_REDUCTIONS_H
+#define LIBTENSOR_REPRODUCIBLE_REDUCTIONS_H
+
+#include <libutil/singleton.h>
+
+namespace libtensor {
+
+
+/** \brief Switches parallel block accumulations to a fixed order
+
+    By default blocks that receive several contributions from concurrent
+    tasks (e.g. in symmetrizations) are accumulated in the order the tasks
+    finish, so results may differ in the last bits from run to run. In
+    the reproducible mode the contributions are buffered and summed in
+    an order that depends only on the block indexes, which makes results
+    bitwise identical regardless of the number of threads and scheduling.
+    The price is a temporary copy of the contributions.
+
+    Contractions and dot products accumulate in a fixed order in either
+    mode.
+
+    The mode shall only be changed between block tensor operations.
+
+    \sa gen_bto_aux_symmetrize
+
+    \ingroup libtensor_core
+ **/
+class reproducible_reductions :
+    public libutil::singleton<reproducible_reductions> {
+
+    friend class libutil::singleton<reproducible_reductions>;
+
+private:
+    bool m_enabled; //!< Reproducible mode is on
+
+protected:
+    reproducible_reductions();
+
+public:
+    static void enable();
+    static void disable();
+    static bool is_enabled();
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_REPRODUCIBLE_REDUCTIONS_H
@@ -0,0 +1,159 @@
+#ifndef LIBTENSOR_SCALAR_TRANSF_COMPLEX_H
+#define LIBTENSOR_SCALAR_TRANSF_COMPLEX_H
+
+#include <complex>
+#include "scalar_transf.h"
+
+
+namespace libtensor {
+
+
+/** \brief Specialization of scalar_transf<T> for T == std::complex<double>
+ **/
+template<>
+class scalar_transf< std::complex<double> > {
+public:
+    typedef std::complex<double> element_type;
+
+private:
+    element_type m_coeff; //!< Coefficient
+
+public:
+    //! \name Constructors
+    //@{
+
+    /** \brief Default constructor
+        \param coeff Scaling coefficient (default: 1.0)
+     **/
+    explicit scalar_transf(const element_type &coeff = 1.0) :
+        m_coeff(coeff) { }
+
+    /** \brief Copy constructor
+     **/
+    scalar_transf(const scalar_transf<element_type> &tr) :
+        m_coeff(tr.m_coeff) { }
+
+    /** \brief Assigment operator
+     **/
+    scalar_transf<element_type> &operator=(
+        const scalar_transf<element_type> &tr) {
+        m_coeff = tr.m_coeff;
+        return *this;
+    }
+
+    //@}
+
+
+    //! \name Manipulating functions
+    //@ {
+
+    void reset() { m_coeff = 1.0; }
+
+    scalar_transf<element_type> &transform(
+        const scalar_transf<element_type> &tr) {
+        m_coeff *= tr.m_coeff;
+        return *this;
+    }
+
+    scalar_transf<element_type> &invert() {
+        m_coeff = (m_coeff == 0.0 ? element_type(0.0) : 1.0 / m_coeff);
+        return *this;
+    }
+
+    void apply(element_type &el) const { el *= m_coeff; }
+
+    //@}
+
+    //! \name Functions specific for T = std::complex<double>
+    //@{
+
+    /** \brief Scale coefficient by c
+     **/
+    void scale(const element_type &c) { m_coeff *= c; }
+
+    /** \brief Returns the coefficient
+     **/
+    const element_type &get_coeff() const { return m_coeff; }
+
+    //@}
+
+    //! Comparison functions and operators
+    //@{
+
+    /** \brief True, if the transformation leaves the elements unchanged
+     **/
+    bool is_identity() const { return m_coeff == 1.0; }
+
+    /** \brief True if all elements are mapped to zero.
+     **/
+    bool is_zero() const { return m_coeff == 0.0; }
+
+    /** \brief equal comparison
+     **/
+    bool operator==(const scalar_transf<element_type> &tr) const {
+        return m_coeff == tr.m_coeff;
+    }
+
+    /** \brief Unequal comparison
+     **/
+    bool operator!=(const scalar_transf<element_type> &tr) const {
+        return !operator==(tr);
+    }
+
+    //@}
+};
+
+
+/** \brief Specialization of scalar_transf_sum<T> for
+        T == std::complex<double>
+ **/
+template<>
+class scalar_transf_sum< std::complex<double> > {
+public:
+    typedef std::complex<double> element_type;
+
+private:
+    element_type m_coeff; //!< Coefficient
+
+public:
+    /** \brief Default constructor
+     **/
+    scalar_transf_sum() : m_coeff(0.0) { }
+
+    /** \brief Add scalar transformation to sum
+     */
+    void add(const scalar_transf<element_type> &tr) {
+        m_coeff += tr.get_coeff();
+    }
+
+    /** \brief Return the result transformation
+     **/
+    scalar_transf<element_type> get_transf() const {
+        return scalar_transf<element_type>(m_coeff);
+    }
+
+    /** \brief Apply sum to element
+     **/
+    void apply(element_type &el) const { el *= m_coeff; }
+
+    /** \brief True, if the transformation leaves the elements unchanged
+     **/
+    bool is_identity() const { return m_coeff == 1.0; }
+
+    /** \brief True if all elements are mapped to zero.
+     **/
+    bool is_zero() const { return m_coeff == 0.0; }
+};
+
+
+inline std::ostream &operator<<(std::ostream &os,
+        const scalar_transf< std::complex<double> > &tr) {
+    os << tr.get_coeff();
+    return os;
+}
+
+
+} // namespace libtensor
+
+
+#endif // LIBTENSOR_SCALAR_TRANSF_COMPLEX_H
@@ -2,6 +2,7 @@
 #define LIBTENSOR_TOD_APPLY_IMPL_H
 
 #include <libtensor/kernels/kern_apply.h>
+#include <libtensor/kernels/kern_apply_i_i.h>
 #include <libtensor/kernels/kern_applyadd.h>
 #include <libtensor/kernels/loop_list_runner.h>
 #include <libtensor/core/bad_dimensions.h>
@@ -104,9 +105,16 @@ void tod_apply<N, Functor>::perform(
     r.m_ptrb_end[0] = pb + dimsb.get_size();
 
     {
-        std::auto_ptr< kernel_base<linalg, 1, 1> > kern(zero ?
-            kern_apply<Functor>::match(m_fn, m_c1, m_c2, loop_in, loop_out) :
-            kern_applyadd<Functor>::match(m_fn, m_c1, m_c2, loop_in, loop_out));
+        std::auto_ptr< kernel_base<linalg, 1, 1> > kern(
+            kern_apply_i_i<Functor>::match(m_fn, m_c1, m_c2, !zero,
+                loop_in, loop_out));
+        if(kern.get() == 0) {
+            kern.reset(zero ?
+                kern_apply<Functor>::match(m_fn, m_c1, m_c2,
+                    loop_in, loop_out) :
+                kern_applyadd<Functor>::match(m_fn, m_c1, m_c2,
+                    loop_in, loop_out));
+        }
         tod_apply<N, Functor>::start_timer(kern->get_name());
         loop_list_runner<linalg, 1, 1>(loop_in).run(0, r, *kern);
         tod_apply<N, Functor>::stop_timer(kern->get_name());
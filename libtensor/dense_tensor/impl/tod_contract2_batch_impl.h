@@ -0,0 +1,307 @@
+#ifndef LIBTENSOR_TOD_CONTRACT2_BATCH_IMPL_H
+#define LIBTENSOR_TOD_CONTRACT2_BATCH_IMPL_H
+
+#include <cstring> // for memset
+#include <map>
+#include <memory>
+#include <libtensor/core/bad_dimensions.h>
+#include <libtensor/core/contraction2_align.h>
+#include <libtensor/core/contraction2_list_builder.h>
+#include <libtensor/exception.h>
+#include <libtensor/linalg/linalg.h>
+#include <libtensor/kernels/kern_dmul2.h>
+#include <libtensor/kernels/loop_list_runner.h>
+#include "../dense_tensor_ctrl.h"
+#include "../to_contract2_dims.h"
+#include "../tod_contract2.h"
+#include "../tod_contract2_batch.h"
+
+
+namespace libtensor {
+
+
+template<size_t N, size_t M, size_t K>
+const char *tod_contract2_batch<N, M, K>::k_clazz =
+    "tod_contract2_batch<N, M, K>";
+
+
+template<size_t N, size_t M, size_t K>
+size_t tod_contract2_batch<N, M, K>::add_result(
+    dense_tensor_wr_i<k_orderc, double> &tc) {
+
+    m_res.push_back(&tc);
+    return m_res.size() - 1;
+}
+
+
+template<size_t N, size_t M, size_t K>
+void tod_contract2_batch<N, M, K>::add_args(
+    const contraction2<N, M, K> &contr,
+    dense_tensor_rd_i<k_ordera, double> &ta,
+    const scalar_transf<double> &ka,
+    dense_tensor_rd_i<k_orderb, double> &tb,
+    const scalar_transf<double> &kb,
+    const scalar_transf<double> &kc,
+    size_t ic) {
+
+    double d = ka.get_coeff() * kb.get_coeff() * kc.get_coeff();
+    add_args(contr, ta, tb, d, ic);
+}
+
+
+template<size_t N, size_t M, size_t K>
+void tod_contract2_batch<N, M, K>::add_args(
+    const contraction2<N, M, K> &contr,
+    dense_tensor_rd_i<k_ordera, double> &ta,
+    dense_tensor_rd_i<k_orderb, double> &tb,
+    double d, size_t ic) {
+
+    static const char *method = "add_args(const contraction2<N, M, K>&, "
+        "dense_tensor_i<N + K, double>&, dense_tensor_i<M + K, double>&, "
+        "double, size_t)";
+
+    if(ic >= m_res.size()) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__, "ic");
+    }
+    if(!to_contract2_dims<N, M, K>(contr, ta.get_dims(), tb.get_dims()).
+        get_dims().equals(m_res[ic]->get_dims())) {
+        throw bad_dimensions(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "ta,tb");
+    }
+
+    m_argslst.push_back(args(contr, ta, tb, d, ic));
+}
+
+
+template<size_t N, size_t M, size_t K>
+void tod_contract2_batch<N, M, K>::perform(bool zero) {
+
+    typedef std::vector<const args*> group_type;
+
+    tod_contract2_batch<N, M, K>::start_timer();
+
+    std::vector<dense_tensor_wr_ctrl<k_orderc, double>*> cc;
+    std::vector<double*> pc;
+
+    try {
+
+        //  Check out results for the whole batch
+
+        for(size_t i = 0; i < m_res.size(); i++) {
+            cc.push_back(new dense_tensor_wr_ctrl<k_orderc, double>(
+                *m_res[i]));
+            pc.push_back(cc[i]->req_dataptr());
+            if(zero) {
+                memset(pc[i], 0, sizeof(double) *
+                    m_res[i]->get_dims().get_size());
+            }
+        }
+
+        //  Group contractions that need no permutations by shape
+
+        tod_contract2_batch<N, M, K>::start_timer("group");
+        std::vector<group_type> groups;
+        std::vector<const args*> other;
+        for(typename std::list<args>::const_iterator i = m_argslst.begin();
+            i != m_argslst.end(); ++i) {
+
+            if(i->d == 0.0) continue;
+
+            contraction2_align<N, M, K> align(i->contr);
+            if(!align.get_perma().is_identity() ||
+                !align.get_permb().is_identity() ||
+                !align.get_permc().is_identity()) {
+                other.push_back(&*i);
+                continue;
+            }
+
+            const sequence<2 * (N + M + K), size_t> &conn =
+                i->contr.get_conn();
+            size_t j = 0;
+            for(; j < groups.size(); j++) {
+                const args &a0 = *groups[j][0];
+                if(a0.d != i->d ||
+                    !a0.ta.get_dims().equals(i->ta.get_dims()) ||
+                    !a0.tb.get_dims().equals(i->tb.get_dims())) continue;
+                const sequence<2 * (N + M + K), size_t> &conn0 =
+                    a0.contr.get_conn();
+                size_t k = 0;
+                while(k < 2 * (N + M + K) && conn0[k] == conn[k]) k++;
+                if(k == 2 * (N + M + K)) break;
+            }
+            if(j == groups.size()) groups.push_back(group_type());
+            groups[j].push_back(&*i);
+        }
+        tod_contract2_batch<N, M, K>::stop_timer("group");
+
+        for(size_t j = 0; j < groups.size(); j++) {
+            perform_group(groups[j], pc);
+        }
+
+        for(size_t i = 0; i < cc.size(); i++) {
+            cc[i]->ret_dataptr(pc[i]);
+            delete cc[i];
+        }
+        cc.clear();
+        pc.clear();
+
+        //  The rest goes one by one
+
+        for(size_t i = 0; i < other.size(); i++) {
+            const args &a = *other[i];
+            tod_contract2<N, M, K>(a.contr, a.ta, a.tb, a.d).
+                perform(false, *m_res[a.ic]);
+        }
+
+    } catch(...) {
+        for(size_t i = 0; i < cc.size(); i++) {
+            if(i < pc.size()) cc[i]->ret_dataptr(pc[i]);
+            delete cc[i];
+        }
+        tod_contract2_batch<N, M, K>::stop_timer();
+        throw;
+    }
+
+    tod_contract2_batch<N, M, K>::stop_timer();
+}
+
+
+template<size_t N, size_t M, size_t K>
+void tod_contract2_batch<N, M, K>::perform_group(
+    const std::vector<const args*> &grp, const std::vector<double*> &pc) {
+
+    typedef std::list< loop_list_node<2, 1> > list_t;
+    typedef typename list_t::const_iterator iterator_t;
+    typedef dense_tensor_rd_ctrl<k_ordera, double> ctrl_a_type;
+    typedef dense_tensor_rd_ctrl<k_orderb, double> ctrl_b_type;
+    typedef std::map<dense_tensor_rd_i<k_ordera, double>*, size_t> map_a_type;
+    typedef std::map<dense_tensor_rd_i<k_orderb, double>*, size_t> map_b_type;
+
+    const args &a0 = *grp[0];
+    const dimensions<k_ordera> &dimsa = a0.ta.get_dims();
+    const dimensions<k_orderb> &dimsb = a0.tb.get_dims();
+    const dimensions<k_orderc> &dimsc = m_res[a0.ic]->get_dims();
+    size_t n = grp.size();
+
+    //  Set up the loops once for the whole group
+
+    tod_contract2_batch<N, M, K>::start_timer("setup");
+    list_t loop_in, loop_out;
+    loop_list_adapter list_adapter(loop_in);
+    contraction2_list_builder<N, M, K>(a0.contr).
+        populate(list_adapter, dimsa, dimsb, dimsc);
+
+    //  Recognize matrix multiplication: c_ij = a_ip b_jp up to the layout
+    //  of a and b, or the same with a and b swapped if c is column-major
+
+    bool gemm = false, swap = false, tra = false, trb = false;
+    size_t ni = 0, nj = 0, np = 0, sa = 0, sb = 0, sic = 0;
+    if(loop_in.size() == 3) {
+        const loop_list_node<2, 1> *li = 0, *lj = 0, *lp = 0;
+        for(iterator_t i = loop_in.begin(); i != loop_in.end(); ++i) {
+            size_t inca = i->stepa(0), incb = i->stepa(1), incc = i->stepb(0);
+            if(inca > 0 && incb > 0 && incc == 0) lp = &*i;
+            else if(inca > 0 && incb == 0 && incc > 0) li = &*i;
+            else if(inca == 0 && incb > 0 && incc > 0) lj = &*i;
+        }
+        if(li && lj && lp && (lj->stepb(0) == 1 || li->stepb(0) == 1)) {
+            swap = lj->stepb(0) != 1;
+            const loop_list_node<2, 1> *lr = swap ? lj : li;
+            const loop_list_node<2, 1> *lc = swap ? li : lj;
+            size_t x = swap ? 1 : 0, y = swap ? 0 : 1;
+            size_t sxr = lr->stepa(x), sxp = lp->stepa(x);
+            size_t syc = lc->stepa(y), syp = lp->stepa(y);
+            bool okx = sxp == 1 || sxr == 1, oky = syp == 1 || syc == 1;
+            if(okx && oky) {
+                gemm = true;
+                tra = sxp != 1;
+                trb = syp != 1;
+                sa = tra ? sxp : sxr;
+                sb = trb ? syp : syc;
+                ni = lr->weight();
+                nj = lc->weight();
+                np = lp->weight();
+                sic = lr->stepb(0);
+            }
+        }
+    }
+
+    std::auto_ptr< kernel_base<linalg, 2, 1> > kern;
+    if(!gemm) kern.reset(kern_dmul2<linalg>::match(a0.d, loop_in, loop_out));
+    tod_contract2_batch<N, M, K>::stop_timer("setup");
+
+    //  Check out the arguments (each tensor once)
+
+    std::vector<ctrl_a_type*> ca;
+    std::vector<ctrl_b_type*> cb;
+    std::vector<const double*> pa0, pb0;
+    std::vector<const double*> pa(n), pb(n);
+    std::vector<double*> pc1(n);
+    map_a_type mapa;
+    map_b_type mapb;
+
+    try {
+
+        for(size_t k = 0; k < n; k++) {
+            const args &a = *grp[k];
+            typename map_a_type::iterator ia = mapa.find(&a.ta);
+            if(ia == mapa.end()) {
+                ca.push_back(new ctrl_a_type(a.ta));
+                pa0.push_back(ca.back()->req_const_dataptr());
+                ia = mapa.insert(std::make_pair(&a.ta, ca.size() - 1)).first;
+            }
+            typename map_b_type::iterator ib = mapb.find(&a.tb);
+            if(ib == mapb.end()) {
+                cb.push_back(new ctrl_b_type(a.tb));
+                pb0.push_back(cb.back()->req_const_dataptr());
+                ib = mapb.insert(std::make_pair(&a.tb, cb.size() - 1)).first;
+            }
+            pa[k] = pa0[ia->second];
+            pb[k] = pb0[ib->second];
+            pc1[k] = pc[a.ic];
+        }
+
+        if(gemm) {
+            tod_contract2_batch<N, M, K>::start_timer("gemm_batch");
+            linalg::mul2_ij_batch_x(0, tra, trb, ni, nj, np,
+                swap ? &pb[0] : &pa[0], sa, swap ? &pa[0] : &pb[0], sb,
+                &pc1[0], sic, a0.d, n);
+            tod_contract2_batch<N, M, K>::stop_timer("gemm_batch");
+        } else {
+            tod_contract2_batch<N, M, K>::start_timer("kernel");
+            loop_list_runner<linalg, 2, 1> runner(loop_in);
+            for(size_t k = 0; k < n; k++) {
+                loop_registers<2, 1> r;
+                r.m_ptra[0] = pa[k];
+                r.m_ptra[1] = pb[k];
+                r.m_ptrb[0] = pc1[k];
+                r.m_ptra_end[0] = pa[k] + dimsa.get_size();
+                r.m_ptra_end[1] = pb[k] + dimsb.get_size();
+                r.m_ptrb_end[0] = pc1[k] + dimsc.get_size();
+                runner.run(0, r, *kern);
+            }
+            tod_contract2_batch<N, M, K>::stop_timer("kernel");
+        }
+
+    } catch(...) {
+        for(size_t i = 0; i < pa0.size(); i++) ca[i]->ret_const_dataptr(pa0[i]);
+        for(size_t i = 0; i < ca.size(); i++) delete ca[i];
+        for(size_t i = 0; i < pb0.size(); i++) cb[i]->ret_const_dataptr(pb0[i]);
+        for(size_t i = 0; i < cb.size(); i++) delete cb[i];
+        throw;
+    }
+
+    for(size_t i = 0; i < ca.size(); i++) {
+        ca[i]->ret_const_dataptr(pa0[i]);
+        delete ca[i];
+    }
+    for(size_t i = 0; i < cb.size(); i++) {
+        cb[i]->ret_const_dataptr(pb0[i]);
+        delete cb[i];
+    }
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOD_CONTRACT2_BATCH_IMPL_H
@@ -13,6 +13,7 @@
 #include <libtensor/kernels/kern_dmul2.h>
 #include <libtensor/kernels/loop_list_node.h>
 #include <libtensor/kernels/loop_list_runner.h>
+#include <libtensor/kernels/loop_plan_cache.h>
 #include "../dense_tensor.h"
 #include "../dense_tensor_ctrl.h"
 #include "../tod_contract2.h"
@@ -356,10 +357,38 @@ void tod_contract2<N, M, K>::perform_internal(aligned_args &ar,
     contr1.permute_b(ar.permb);
     contr1.permute_c(ar.permc);
 
-    std::list< loop_list_node<2, 1> > loop_in, loop_out;
-    loop_list_adapter list_adapter(loop_in);
-    contraction2_list_builder<N, M, K>(contr1).
-        populate(list_adapter, dimsa1, dimsb1, dimsc);
+    //  Look up the loops and the kernel for this contraction, dimensions
+    //  and factor, build them if there are none yet. Contractions with
+    //  the same N + M + K share the cache, so the key starts with N and M.
+
+    enum {
+        k_lenkey = 4 * (N + M + K) + 2
+    };
+    typedef loop_plan_cache<linalg, 2, 1, loop_plan_key<k_lenkey> >
+        plan_cache_type;
+    loop_plan_key<k_lenkey> key;
+    const sequence<2 * (N + M + K), size_t> &conn = contr1.get_conn();
+    size_t j = 0;
+    key.sig[j++] = N;
+    key.sig[j++] = M;
+    for(size_t i = 0; i < 2 * (N + M + K); i++) key.sig[j++] = conn[i];
+    for(size_t i = 0; i < k_ordera; i++) key.sig[j++] = dimsa1.get_dim(i);
+    for(size_t i = 0; i < k_orderb; i++) key.sig[j++] = dimsb1.get_dim(i);
+    for(size_t i = 0; i < k_orderc; i++) key.sig[j++] = dimsc.get_dim(i);
+    key.d = ar.d;
+
+    plan_cache_type &cache = plan_cache_type::get_instance();
+    const typename plan_cache_type::plan *plan = cache.find(key);
+    if(plan == 0) {
+        std::list< loop_list_node<2, 1> > loop_in, loop_out;
+        loop_list_adapter list_adapter(loop_in);
+        contraction2_list_builder<N, M, K>(contr1).
+            populate(list_adapter, dimsa1, dimsb1, dimsc);
+        std::auto_ptr< kernel_base<linalg, 2, 1> > kern(
+            kern_dmul2<linalg>::match(ar.d, loop_in, loop_out));
+        plan = &cache.insert(key, loop_in, kern.get());
+        kern.release();
+    }
 
     {
         loop_registers<2, 1> r;
@@ -370,13 +399,11 @@ void tod_contract2<N, M, K>::perform_internal(aligned_args &ar,
         r.m_ptra_end[1] = pb2 + dimsb1.get_size();
         r.m_ptrb_end[0] = pc + dimsc.get_size();
 
-        std::auto_ptr< kernel_base<linalg, 2, 1> > kern(
-            kern_dmul2<linalg>::match(ar.d, loop_in, loop_out));
         tod_contract2<N, M, K>::start_timer("kernel");
-        tod_contract2<N, M, K>::start_timer(kern->get_name());
-        loop_list_runner<linalg, 2, 1>(loop_in).run(0, r, *kern);
+        tod_contract2<N, M, K>::start_timer(plan->kern->get_name());
+        loop_list_runner<linalg, 2, 1>(plan->loop).run(0, r, *plan->kern);
         tod_contract2<N, M, K>::stop_timer("kernel");
-        tod_contract2<N, M, K>::stop_timer(kern->get_name());
+        tod_contract2<N, M, K>::stop_timer(plan->kern->get_name());
     }
 
     if(pa1) {
@@ -6,6 +6,7 @@
 #include <libtensor/kernels/kern_dadd1.h>
 #include <libtensor/kernels/kern_dcopy.h>
 #include <libtensor/kernels/loop_list_runner.h>
+#include <libtensor/kernels/loop_plan_cache.h>
 #include <libtensor/core/bad_dimensions.h>
 #include "../dense_tensor_ctrl.h"
 #include "../tod_set.h"
@@ -89,23 +90,49 @@ void tod_copy<N>::perform(bool zero, dense_tensor_wr_i<N, double> &tb) {
         for(size_t i = 0; i < N; i++) seqa[i] = i;
         m_perm.apply(seqa);
 
-        std::list< loop_list_node<1, 1> > loop_in, loop_out;
-        typename std::list< loop_list_node<1, 1> >::iterator inode =
-            loop_in.end();
-
-        //  Go over indexes in B and connect them with indexes in A
-        //  trying to glue together consecutive indexes
-        for(size_t idxb = 0; idxb < N;) {
-            size_t len = 1;
-            size_t idxa = seqa[idxb];
-            do {
-                len *= dimsa.get_dim(idxa);
-                idxa++; idxb++;
-            } while(idxb < N && seqa[idxb] == idxa);
-
-            inode = loop_in.insert(loop_in.end(), loop_list_node<1, 1>(len));
-            inode->stepa(0) = dimsa.get_increment(idxa - 1);
-            inode->stepb(0) = dimsb.get_increment(idxb - 1);
+        //  Look up the loops and the kernel for this permutation, dimensions
+        //  and factor, build them if there are none yet
+
+        typedef loop_plan_cache<linalg, 1, 1, loop_plan_key<2 * N + 1> >
+            plan_cache_type;
+        loop_plan_key<2 * N + 1> key;
+        for(size_t i = 0; i < N; i++) {
+            key.sig[i] = seqa[i];
+            key.sig[N + i] = dimsa.get_dim(i);
+        }
+        key.sig[2 * N] = zero ? 1 : 0;
+        key.d = m_c;
+
+        plan_cache_type &cache = plan_cache_type::get_instance();
+        const typename plan_cache_type::plan *plan = cache.find(key);
+        if(plan == 0) {
+
+            std::list< loop_list_node<1, 1> > loop_in, loop_out;
+            typename std::list< loop_list_node<1, 1> >::iterator inode =
+                loop_in.end();
+
+            //  Go over indexes in B and connect them with indexes in A
+            //  trying to glue together consecutive indexes
+            for(size_t idxb = 0; idxb < N;) {
+                size_t len = 1;
+                size_t idxa = seqa[idxb];
+                do {
+                    len *= dimsa.get_dim(idxa);
+                    idxa++; idxb++;
+                } while(idxb < N && seqa[idxb] == idxa);
+
+                inode = loop_in.insert(loop_in.end(),
+                    loop_list_node<1, 1>(len));
+                inode->stepa(0) = dimsa.get_increment(idxa - 1);
+                inode->stepb(0) = dimsb.get_increment(idxb - 1);
+            }
+
+            std::auto_ptr< kernel_base<linalg, 1, 1> > kern(
+                zero ?
+                    kern_dcopy<linalg>::match(m_c, loop_in, loop_out) :
+                    kern_dadd1<linalg>::match(m_c, loop_in, loop_out));
+            plan = &cache.insert(key, loop_in, kern.get());
+            kern.release();
         }
 
         const double *pa = ca.req_const_dataptr();
@@ -119,15 +146,9 @@ void tod_copy<N>::perform(bool zero, dense_tensor_wr_i<N, double> &tb) {
         r.m_ptra_end[0] = pa + dimsa.get_size();
         r.m_ptrb_end[0] = pb + dimsb.get_size();
 
-        {
-            std::auto_ptr< kernel_base<linalg, 1, 1> > kern(
-                zero ?
-                    kern_dcopy<linalg>::match(m_c, loop_in, loop_out) :
-                    kern_dadd1<linalg>::match(m_c, loop_in, loop_out));
-            tod_copy<N>::start_timer(kern->get_name());
-            loop_list_runner<linalg, 1, 1>(loop_in).run(0, r, *kern);
-            tod_copy<N>::stop_timer(kern->get_name());
-        }
+        tod_copy<N>::start_timer(plan->kern->get_name());
+        loop_list_runner<linalg, 1, 1>(plan->loop).run(0, r, *plan->kern);
+        tod_copy<N>::stop_timer(plan->kern->get_name());
 
         ca.ret_const_dataptr(pa);
         cb.ret_dataptr(pb);
@@ -0,0 +1,73 @@
+#ifndef LIBTENSOR_TOD_DENOM_DIV_IMPL_H
+#define LIBTENSOR_TOD_DENOM_DIV_IMPL_H
+
+#include <vector>
+#include "../dense_tensor_ctrl.h"
+#include "../tod_denom_div.h"
+
+namespace libtensor {
+
+
+template<size_t N>
+const char *tod_denom_div<N>::k_clazz = "tod_denom_div<N>";
+
+
+template<size_t N>
+tod_denom_div<N>::tod_denom_div(const sequence<N, const double*> &d,
+    double shift) :
+
+    m_d(d), m_shift(shift) {
+
+}
+
+
+template<size_t N>
+void tod_denom_div<N>::perform(dense_tensor_wr_i<N, double> &ta) {
+
+    tod_denom_div<N>::start_timer();
+
+    try {
+
+        const dimensions<N> &dims = ta.get_dims();
+        size_t ni = dims[N - 1], nouter = dims.get_size() / ni;
+
+        //  Partial sums of the first N - 1 vectors, then denominators along
+        //  the last dimension
+        sequence<N, size_t> idx(0);
+        std::vector<double> den(ni);
+
+        dense_tensor_wr_ctrl<N, double> ca(ta);
+        double *p = ca.req_dataptr();
+
+        for(size_t io = 0; io < nouter; io++) {
+
+            double s = m_shift;
+            for(size_t k = 0; k + 1 < N; k++) if(m_d[k]) s += m_d[k][idx[k]];
+
+            const double *dl = m_d[N - 1];
+            if(dl) for(size_t i = 0; i < ni; i++) den[i] = s + dl[i];
+            else for(size_t i = 0; i < ni; i++) den[i] = s;
+
+            double *p1 = p + io * ni;
+            for(size_t i = 0; i < ni; i++) p1[i] /= den[i];
+
+            for(size_t k = N - 1; k > 0; k--) {
+                if(++idx[k - 1] < dims[k - 1]) break;
+                idx[k - 1] = 0;
+            }
+        }
+
+        ca.ret_dataptr(p); p = 0;
+
+    } catch(...) {
+        tod_denom_div<N>::stop_timer();
+        throw;
+    }
+
+    tod_denom_div<N>::stop_timer();
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOD_DENOM_DIV_IMPL_H
@@ -0,0 +1,45 @@
+#ifndef LIBTENSOR_TOD_NORM_IMPL_H
+#define LIBTENSOR_TOD_NORM_IMPL_H
+
+#include <cmath>
+#include "../dense_tensor_ctrl.h"
+#include "../tod_norm.h"
+
+namespace libtensor {
+
+
+template<size_t N>
+const char *tod_norm<N>::k_clazz = "tod_norm<N>";
+
+
+template<size_t N>
+void tod_norm<N>::perform(dense_tensor_rd_i<N, double> &t, double &norm,
+    double &maxabs) {
+
+    tod_norm::start_timer();
+
+    dense_tensor_rd_ctrl<N, double> ctrl(t);
+
+    size_t sz = t.get_dims().get_size();
+    const double *p = ctrl.req_const_dataptr();
+
+    double s = 0.0, m = 0.0;
+    for(size_t i = 0; i < sz; i++) {
+        double a = fabs(p[i]);
+        s += a * a;
+        //  NaN is sticky, so a block of NaNs is never taken for zero
+        if(a > m || a != a) m = a;
+    }
+
+    ctrl.ret_const_dataptr(p);
+
+    norm = sqrt(s);
+    maxabs = m;
+
+    tod_norm::stop_timer();
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOD_NORM_IMPL_H
@@ -1,7 +1,7 @@
 #ifndef LIBTENSOR_TOD_RANDOM_IMPL_H
 #define LIBTENSOR_TOD_RANDOM_IMPL_H
 
-#include <libtensor/linalg/linalg.h>
+#include <libtensor/core/counter_rng.h>
 #include "../dense_tensor_ctrl.h"
 #include "../tod_random.h"
 
@@ -13,13 +13,25 @@ const char *tod_random<N>::k_clazz = "tod_random<N>";
 
 
 template<size_t N>
-tod_random<N>::tod_random(const scalar_transf<double> &c) : m_c(c.get_coeff()) {
+tod_random<N>::tod_random(const scalar_transf<double> &c) :
+    m_c(c.get_coeff()), m_keyed(false), m_stream(0), m_substream(0) {
 
 }
 
 
 template<size_t N>
-tod_random<N>::tod_random(double c) : m_c(c) {
+tod_random<N>::tod_random(double c) :
+    m_c(c), m_keyed(false), m_stream(0), m_substream(0) {
+
+}
+
+
+template<size_t N>
+tod_random<N>::tod_random(const scalar_transf<double> &c, uint64_t stream,
+    uint64_t substream) :
+
+    m_c(c.get_coeff()), m_keyed(true), m_stream(stream),
+    m_substream(substream) {
 
 }
 
@@ -38,8 +50,9 @@ void tod_random<N>::perform(bool zero, dense_tensor_wr_i<N, double> &t) {
     size_t sz = t.get_dims().get_size();
     double *ptr = ctrl.req_dataptr();
 
-    if(zero) linalg::rng_set_i_x(0, sz, ptr, 1, m_c);
-    else linalg::rng_add_i_x(0, sz, ptr, 1, m_c);
+    uint64_t stream = m_keyed ? m_stream : counter_rng::next_stream();
+    if(zero) counter_rng::set_i_x(stream, m_substream, sz, ptr, m_c);
+    else counter_rng::add_i_x(stream, m_substream, sz, ptr, m_c);
 
     ctrl.ret_dataptr(ptr);
 }
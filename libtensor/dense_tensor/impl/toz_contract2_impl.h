@@ -0,0 +1,245 @@
+#ifndef LIBTENSOR_TOZ_CONTRACT2_IMPL_H
+#define LIBTENSOR_TOZ_CONTRACT2_IMPL_H
+
+#include <libtensor/core/allocator.h>
+#include <libtensor/core/bad_dimensions.h>
+#include <libtensor/core/permutation_builder.h>
+#include <libtensor/linalg/linalg.h>
+#include "../dense_tensor_ctrl.h"
+#include "../toz_contract2.h"
+#include "toz_copy_impl.h"
+
+
+namespace libtensor {
+
+
+template<size_t N, size_t M, size_t K>
+const char *toz_contract2<N, M, K>::k_clazz = "toz_contract2<N, M, K>";
+
+
+template<size_t N, size_t M, size_t K>
+toz_contract2<N, M, K>::toz_contract2(
+    const contraction2<N, M, K> &contr,
+    dense_tensor_rd_i<k_ordera, element_type> &ta,
+    dense_tensor_rd_i<k_orderb, element_type> &tb,
+    const element_type &d) :
+
+    m_contr(contr), m_ta(ta), m_tb(tb), m_d(d),
+    m_dimsc(contr, ta.get_dims(), tb.get_dims()) {
+
+}
+
+
+template<size_t N, size_t M, size_t K>
+void toz_contract2<N, M, K>::perform(bool zero,
+    dense_tensor_wr_i<k_orderc, element_type> &tc) {
+
+    static const char *method =
+        "perform(bool, dense_tensor_wr_i<N + M, complex<double> >&)";
+
+    typedef allocator<element_type> allocator_type;
+
+    if(!m_dimsc.get_dims().equals(tc.get_dims())) {
+        throw bad_dimensions(g_ns, k_clazz, method, __FILE__, __LINE__, "tc");
+    }
+
+    const dimensions<k_ordera> &dimsa = m_ta.get_dims();
+    const dimensions<k_orderb> &dimsb = m_tb.get_dims();
+    const dimensions<k_orderc> &dimsc = tc.get_dims();
+
+    if(m_d == 0.0) {
+        if(zero) {
+            dense_tensor_wr_ctrl<k_orderc, element_type> cc(tc);
+            element_type *pc = cc.req_dataptr();
+            for(size_t i = 0; i < dimsc.get_size(); i++) pc[i] = 0.0;
+            cc.ret_dataptr(pc);
+        }
+        return;
+    }
+
+    toz_contract2<N, M, K>::start_timer();
+
+    try {
+
+    //  Outer indexes of A and B in the order of C, inner indexes in the
+    //  order of A (as numbered in A and in B)
+
+    const sequence<2 * (N + M + K), size_t> &conn = m_contr.get_conn();
+    sequence<k_ordera, size_t> outa(0), seqa(0), seqa1(0);
+    sequence<k_orderb, size_t> outb(0), seqb(0), seqb1(0);
+    sequence<k_orderc, size_t> seqc(0), seqc1(0);
+    sequence<K, size_t> inna(0), innb(0), inna1(0), innb1(0);
+    for(size_t i = 0; i < k_ordera; i++) seqa[i] = i;
+    for(size_t i = 0; i < k_orderb; i++) seqb[i] = i;
+    for(size_t i = 0; i < k_orderc; i++) seqc[i] = i;
+
+    size_t ia = 0, ib = 0;
+    for(size_t i = 0; i < k_orderc; i++) {
+        size_t j = conn[i] - k_orderc;
+        if(j < k_ordera) outa[ia++] = j;
+        else outb[ib++] = j - k_ordera;
+    }
+    for(size_t i = 0, k = 0; i < k_ordera; i++) {
+        if(conn[k_orderc + i] < k_orderc) continue;
+        inna[k] = i;
+        innb[k++] = conn[k_orderc + i] - k_orderc - k_ordera;
+    }
+
+    //  Try the inner indexes in the order of A and in the order of B, take
+    //  the one that leaves less data to permute
+
+    for(size_t i = 0, k = 0; i < k_orderb; i++) {
+        size_t j = conn[k_orderc + k_ordera + i];
+        if(j < k_orderc) continue;
+        inna1[k] = j - k_orderc;
+        innb1[k++] = i;
+    }
+
+    bool tra, trb, perma1, permb1;
+    tra = layout(outa, inna, seqa1, perma1);
+    trb = layout(outb, innb, seqb1, permb1);
+    size_t cost = (perma1 ? dimsa.get_size() : 0) +
+        (permb1 ? dimsb.get_size() : 0);
+    if(cost > 0) {
+        sequence<k_ordera, size_t> seqa2(0);
+        sequence<k_orderb, size_t> seqb2(0);
+        bool perma2, permb2;
+        bool tra2 = layout(outa, inna1, seqa2, perma2);
+        bool trb2 = layout(outb, innb1, seqb2, permb2);
+        size_t cost2 = (perma2 ? dimsa.get_size() : 0) +
+            (permb2 ? dimsb.get_size() : 0);
+        if(cost2 < cost) {
+            tra = tra2; trb = trb2;
+            seqa1 = seqa2; seqb1 = seqb2;
+        }
+    }
+
+    //  Result is [outer A | outer B], or [outer B | outer A] if the first
+    //  index of C comes from B
+
+    bool swap = conn[0] - k_orderc >= k_ordera;
+    for(size_t i = 0, k = 0; i < 2; i++) {
+        bool froma = (i == 0) != swap;
+        for(size_t j = 0; j < k_orderc; j++) {
+            if((conn[j] - k_orderc < k_ordera) == froma) seqc1[k++] = j;
+        }
+    }
+
+    permutation<k_ordera> perma(
+        permutation_builder<k_ordera>(seqa1, seqa).get_perm());
+    permutation<k_orderb> permb(
+        permutation_builder<k_orderb>(seqb1, seqb).get_perm());
+    permutation<k_orderc> permc(
+        permutation_builder<k_orderc>(seqc, seqc1).get_perm());
+
+    size_t ni = 1, nj = 1, np = 1;
+    for(size_t i = 0; i < N; i++) ni *= dimsa.get_dim(outa[i]);
+    for(size_t i = 0; i < M; i++) nj *= dimsb.get_dim(outb[i]);
+    for(size_t i = 0; i < K; i++) np *= dimsa.get_dim(inna[i]);
+
+    dense_tensor_rd_ctrl<k_ordera, element_type> ca(m_ta);
+    dense_tensor_rd_ctrl<k_orderb, element_type> cb(m_tb);
+    dense_tensor_wr_ctrl<k_orderc, element_type> cc(tc);
+
+    const element_type *pa = ca.req_const_dataptr();
+    const element_type *pb = cb.req_const_dataptr();
+    element_type *pc = cc.req_dataptr();
+    const element_type *pa1 = pa, *pb1 = pb;
+    element_type *pc1 = pc;
+
+    typename allocator_type::pointer_type vpa, vpb, vpc;
+    element_type *pa2 = 0, *pb2 = 0, *pc2 = 0;
+
+    if(!perma.is_identity()) {
+        toz_contract2<N, M, K>::start_timer("perma");
+        vpa = allocator_type::allocate(dimsa.get_size());
+        pa2 = allocator_type::lock_rw(vpa);
+        toz_copy<k_ordera>::perform_raw(dimsa, perma, 1.0, true, pa, pa2);
+        pa1 = pa2;
+        toz_contract2<N, M, K>::stop_timer("perma");
+    }
+    if(!permb.is_identity()) {
+        toz_contract2<N, M, K>::start_timer("permb");
+        vpb = allocator_type::allocate(dimsb.get_size());
+        pb2 = allocator_type::lock_rw(vpb);
+        toz_copy<k_orderb>::perform_raw(dimsb, permb, 1.0, true, pb, pb2);
+        pb1 = pb2;
+        toz_contract2<N, M, K>::stop_timer("permb");
+    }
+    if(!permc.is_identity()) {
+        vpc = allocator_type::allocate(dimsc.get_size());
+        pc1 = pc2 = allocator_type::lock_rw(vpc);
+    }
+    if(pc2 != 0 || zero) {
+        for(size_t i = 0; i < dimsc.get_size(); i++) pc1[i] = 0.0;
+    }
+
+    toz_contract2<N, M, K>::start_timer("zgemm");
+    if(swap) {
+        linalg::mul2_ij_x(0, trb, tra, nj, ni, np, pb1, trb ? nj : np,
+            pa1, tra ? ni : np, pc1, ni, m_d);
+    } else {
+        linalg::mul2_ij_x(0, tra, trb, ni, nj, np, pa1, tra ? ni : np,
+            pb1, trb ? nj : np, pc1, nj, m_d);
+    }
+    toz_contract2<N, M, K>::stop_timer("zgemm");
+
+    if(pc2 != 0) {
+        toz_contract2<N, M, K>::start_timer("permc");
+        dimensions<k_orderc> dimsc1(dimsc);
+        dimsc1.permute(permutation<k_orderc>(permc, true));
+        toz_copy<k_orderc>::perform_raw(dimsc1, permc, 1.0, zero, pc2, pc);
+        toz_contract2<N, M, K>::stop_timer("permc");
+        allocator_type::unlock_rw(vpc);
+        allocator_type::deallocate(vpc);
+    }
+    if(pb2 != 0) {
+        allocator_type::unlock_rw(vpb);
+        allocator_type::deallocate(vpb);
+    }
+    if(pa2 != 0) {
+        allocator_type::unlock_rw(vpa);
+        allocator_type::deallocate(vpa);
+    }
+
+    ca.ret_const_dataptr(pa);
+    cb.ret_const_dataptr(pb);
+    cc.ret_dataptr(pc);
+
+    } catch(...) {
+        toz_contract2<N, M, K>::stop_timer();
+        throw;
+    }
+
+    toz_contract2<N, M, K>::stop_timer();
+}
+
+
+template<size_t N, size_t M, size_t K> template<size_t L>
+bool toz_contract2<N, M, K>::layout(const sequence<L, size_t> &out,
+    const sequence<K, size_t> &inn, sequence<L, size_t> &seq, bool &perm) {
+
+    const size_t nout = L - K;
+
+    //  Inner indexes go first only if that is the order already in place
+
+    bool tr = true;
+    for(size_t i = 0; i < K; i++) seq[i] = inn[i];
+    for(size_t i = 0; i < nout; i++) seq[K + i] = out[i];
+    for(size_t i = 0; i < L; i++) if(seq[i] != i) tr = false;
+    if(tr && nout > 0) {
+        perm = false;
+        return true;
+    }
+
+    perm = false;
+    for(size_t i = 0; i < nout; i++) seq[i] = out[i];
+    for(size_t i = 0; i < K; i++) seq[nout + i] = inn[i];
+    for(size_t i = 0; i < L; i++) if(seq[i] != i) perm = true;
+    return false;
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOZ_CONTRACT2_IMPL_H
@@ -0,0 +1,118 @@
+#ifndef LIBTENSOR_TOZ_COPY_IMPL_H
+#define LIBTENSOR_TOZ_COPY_IMPL_H
+
+#include <libtensor/core/bad_dimensions.h>
+#include "../dense_tensor_ctrl.h"
+#include "../toz_copy.h"
+
+
+namespace libtensor {
+
+
+template<size_t N>
+const char *toz_copy<N>::k_clazz = "toz_copy<N>";
+
+
+template<size_t N>
+toz_copy<N>::toz_copy(dense_tensor_rd_i<N, element_type> &ta,
+    const tensor_transf_t &tr) :
+
+    m_ta(ta), m_perm(tr.get_perm()), m_c(tr.get_scalar_tr().get_coeff()),
+    m_dimsb(ta.get_dims()) {
+
+    m_dimsb.permute(m_perm);
+}
+
+
+template<size_t N>
+toz_copy<N>::toz_copy(dense_tensor_rd_i<N, element_type> &ta,
+    const permutation<N> &p, const element_type &c) :
+
+    m_ta(ta), m_perm(p), m_c(c), m_dimsb(ta.get_dims()) {
+
+    m_dimsb.permute(m_perm);
+}
+
+
+template<size_t N>
+void toz_copy<N>::perform(bool zero,
+    dense_tensor_wr_i<N, element_type> &tb) {
+
+    static const char *method =
+        "perform(bool, dense_tensor_wr_i<N, complex<double> >&)";
+
+    if(!tb.get_dims().equals(m_dimsb)) {
+        throw bad_dimensions(g_ns, k_clazz, method, __FILE__, __LINE__, "tb");
+    }
+
+    toz_copy<N>::start_timer();
+
+    try {
+
+        dense_tensor_rd_ctrl<N, element_type> ca(m_ta);
+        dense_tensor_wr_ctrl<N, element_type> cb(tb);
+
+        const element_type *pa = ca.req_const_dataptr();
+        element_type *pb = cb.req_dataptr();
+
+        perform_raw(m_ta.get_dims(), m_perm, m_c, zero, pa, pb);
+
+        ca.ret_const_dataptr(pa);
+        cb.ret_dataptr(pb);
+
+    } catch(...) {
+        toz_copy<N>::stop_timer();
+        throw;
+    }
+
+    toz_copy<N>::stop_timer();
+}
+
+
+template<size_t N>
+void toz_copy<N>::perform_raw(const dimensions<N> &dimsa,
+    const permutation<N> &perm, const element_type &c, bool zero,
+    const element_type *pa, element_type *pb) {
+
+    dimensions<N> dimsb(dimsa);
+    dimsb.permute(perm);
+
+    //  Index k of B runs over index seqa[k] of A
+
+    sequence<N, size_t> seqa(0);
+    for(size_t i = 0; i < N; i++) seqa[i] = i;
+    perm.apply(seqa);
+
+    size_t stepa[N], cnt[N];
+    for(size_t i = 0; i < N; i++) {
+        stepa[i] = dimsa.get_increment(seqa[i]);
+        cnt[i] = 0;
+    }
+
+    size_t nlast = dimsb.get_dim(N - 1), slast = stepa[N - 1];
+    size_t nouter = dimsb.get_size() / nlast;
+    const element_type *a = pa;
+
+    for(size_t io = 0; io < nouter; io++) {
+
+        element_type *b = pb + io * nlast;
+        if(zero) {
+            for(size_t j = 0; j < nlast; j++) b[j] = c * a[j * slast];
+        } else {
+            for(size_t j = 0; j < nlast; j++) b[j] += c * a[j * slast];
+        }
+
+        //  Advance the outer indexes of B
+        for(size_t k = N - 1; k-- > 0;) {
+            a += stepa[k];
+            if(++cnt[k] < dimsb.get_dim(k)) break;
+            a -= stepa[k] * cnt[k];
+            cnt[k] = 0;
+        }
+    }
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOZ_COPY_IMPL_H
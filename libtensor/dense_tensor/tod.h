@@ -14,6 +14,7 @@
 #include "tod_btconv.h"
 #include "tod_compare.h"
 #include "tod_contract2.h"
+#include "tod_contract2_batch.h"
 #include "tod_copy.h"
 #include "tod_diag.h"
 #include "tod_dirsum.h"
@@ -24,6 +25,7 @@
 #include "tod_import_raw.h"
 #include "tod_mult.h"
 #include "tod_mult1.h"
+#include "tod_norm.h"
 #include "tod_random.h"
 #include "tod_scale.h"
 #include "tod_scatter.h"
@@ -30,6 +30,17 @@ namespace libtensor {
     The latter function should perform the intended operation of the functor
     on the tensor data.
 
+    Optionally, the functor can apply the function to arrays of elements
+    at once, e.g. using vectorized math routines, with
+    \code
+        void Functor::apply_batch(size_t n, double c1, const double *a,
+            double c2, double *b, bool add);
+    \endcode
+    which computes \f$ b_i = c_2 f(c_1 a_i) \f$ for \f$ i < n \f$, or adds
+    the result to \f$ b_i \f$ if add is true. If the function is present
+    (detected at compile time), it is used for all the elements, otherwise
+    operator() is called for each element.
+
     \ingroup libtensor_dense_tensor_tod
  **/
 template<size_t N, typename Functor>
@@ -0,0 +1,142 @@
+#ifndef LIBTENSOR_TOD_CONTRACT2_BATCH_H
+#define LIBTENSOR_TOD_CONTRACT2_BATCH_H
+
+#include <list>
+#include <vector>
+#include <libtensor/timings.h>
+#include <libtensor/core/contraction2.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/scalar_transf_double.h>
+#include <libtensor/dense_tensor/dense_tensor_i.h>
+#include <libtensor/kernels/loop_list_node.h>
+
+
+namespace libtensor {
+
+
+/** \brief Contracts many pairs of small dense tensors into several results
+    \tparam N Order of first tensor (A) less contraction degree.
+    \tparam M Order of second tensor (B) less contraction degree.
+    \tparam K Contraction degree (number of inner indexes).
+
+    The operation computes a set of results, each of which is the sum of
+    contractions as in tod_contract2. Results are registered with
+    add_result(), contractions with add_args() refer to the result by its
+    number.
+
+    Contractions that need no permutation of their arguments and have the
+    same shape (contraction, dimensions, scaling factor) are grouped
+    together. The loops and the kernel of each group are set up once, and
+    if the group is a matrix multiplication it is passed to BLAS as one
+    batched GEMM (linalg::mul2_ij_batch_x), otherwise the kernel runs for
+    each member. The remaining contractions are done one by one by
+    tod_contract2.
+
+    \sa tod_contract2, grouped_contractions
+
+    \ingroup libtensor_dense_tensor_tod
+ **/
+template<size_t N, size_t M, size_t K>
+class tod_contract2_batch :
+    public timings< tod_contract2_batch<N, M, K> >,
+    public noncopyable {
+public:
+    static const char *k_clazz;
+
+public:
+    enum {
+        k_ordera = N + K, //!< Order of first argument (A)
+        k_orderb = M + K, //!< Order of second argument (B)
+        k_orderc = N + M //!< Order of result (C)
+    };
+
+private:
+    struct args {
+        contraction2<N, M, K> contr; //!< Contraction
+        dense_tensor_rd_i<k_ordera, double> &ta; //!< First tensor (A)
+        dense_tensor_rd_i<k_orderb, double> &tb; //!< Second tensor (B)
+        double d; //!< Scaling factor
+        size_t ic; //!< Number of result
+
+        args(
+            const contraction2<N, M, K> &contr_,
+            dense_tensor_rd_i<k_ordera, double> &ta_,
+            dense_tensor_rd_i<k_orderb, double> &tb_,
+            double d_, size_t ic_) :
+            contr(contr_), ta(ta_), tb(tb_), d(d_), ic(ic_) { }
+    };
+
+    class loop_list_adapter {
+    private:
+        typedef std::list< loop_list_node<2, 1> > list_t;
+        list_t &m_list;
+
+    public:
+        loop_list_adapter(list_t &list) : m_list(list) { }
+        void append(size_t weight, size_t inca, size_t incb,
+            size_t incc) {
+            typedef typename list_t::iterator iterator_t;
+            typedef loop_list_node<2, 1> node_t;
+            iterator_t inode = m_list.insert(m_list.end(), node_t(weight));
+            inode->stepa(0) = inca;
+            inode->stepa(1) = incb;
+            inode->stepb(0) = incc;
+        }
+    };
+
+private:
+    std::vector<dense_tensor_wr_i<k_orderc, double>*> m_res; //!< Results
+    std::list<args> m_argslst; //!< List of arguments
+
+public:
+    /** \brief Registers a result tensor
+        \param tc Result tensor.
+        \return Number of the result.
+     **/
+    size_t add_result(dense_tensor_wr_i<k_orderc, double> &tc);
+
+    /** \brief Adds a contraction to a result
+        \param contr Contraction.
+        \param ta First contracted tensor A.
+        \param ka Scalar transformation of A.
+        \param tb Second contracted tensor B.
+        \param kb Scalar transformation of B.
+        \param kc Scalar transformation of result (C).
+        \param ic Number of the result.
+     **/
+    void add_args(
+        const contraction2<N, M, K> &contr,
+        dense_tensor_rd_i<k_ordera, double> &ta,
+        const scalar_transf<double> &ka,
+        dense_tensor_rd_i<k_orderb, double> &tb,
+        const scalar_transf<double> &kb,
+        const scalar_transf<double> &kc,
+        size_t ic);
+
+    /** \brief Adds a contraction to a result
+        \param contr Contraction.
+        \param ta First contracted tensor A.
+        \param tb Second contracted tensor B.
+        \param d Scaling factor d.
+        \param ic Number of the result.
+     **/
+    void add_args(
+        const contraction2<N, M, K> &contr,
+        dense_tensor_rd_i<k_ordera, double> &ta,
+        dense_tensor_rd_i<k_orderb, double> &tb,
+        double d, size_t ic);
+
+    /** \brief Performs the operation
+        \param zero Zero results before computing.
+     **/
+    void perform(bool zero);
+
+private:
+    void perform_group(const std::vector<const args*> &grp,
+        const std::vector<double*> &pc);
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOD_CONTRACT2_BATCH_H
@@ -0,0 +1,52 @@
+#ifndef LIBTENSOR_TOD_DENOM_DIV_H
+#define LIBTENSOR_TOD_DENOM_DIV_H
+
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/sequence.h>
+#include "dense_tensor_i.h"
+
+namespace libtensor {
+
+
+/** \brief Divides tensor elements by a sum of vectors (energy denominator)
+    \tparam N Tensor order.
+
+    Divides each element of a tensor by the direct sum of one vector per
+    dimension and a shift:
+    \f[
+        t_{i_1 \ldots i_N} = \frac{t_{i_1 \ldots i_N}}
+            {d^{(1)}_{i_1} + \cdots + d^{(N)}_{i_N} + s}
+    \f]
+    The denominator is formed on the fly, one vector of partial sums for
+    the last dimension at a time. The vectors are given as arrays as long
+    as the respective dimension, a null pointer stands for a zero vector.
+
+    \ingroup libtensor_dense_tensor_tod
+ **/
+template<size_t N>
+class tod_denom_div : public timings< tod_denom_div<N> >, public noncopyable {
+public:
+    static const char *k_clazz; //!< Class name
+
+private:
+    sequence<N, const double*> m_d; //!< Vectors
+    double m_shift; //!< Shift of the denominator
+
+public:
+    /** \brief Initializes the operation
+        \param d Vectors (null for zero vectors).
+        \param shift Shift of the denominator.
+     **/
+    tod_denom_div(const sequence<N, const double*> &d, double shift = 0.0);
+
+    /** \brief Performs the operation
+        \param ta Tensor.
+     **/
+    void perform(dense_tensor_wr_i<N, double> &ta);
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOD_DENOM_DIV_H
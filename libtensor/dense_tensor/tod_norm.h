@@ -0,0 +1,39 @@
+#ifndef LIBTENSOR_TOD_NORM_H
+#define LIBTENSOR_TOD_NORM_H
+
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include "dense_tensor_i.h"
+
+namespace libtensor {
+
+
+/** \brief Computes the Frobenius norm and the largest absolute element of
+        a dense tensor
+    \tparam N Tensor order.
+
+    Both quantities are obtained in a single pass over the data array. A tensor
+    is all zero if and only if the largest absolute element is zero.
+
+    \ingroup libtensor_dense_tensor_tod
+ **/
+template<size_t N>
+class tod_norm : public timings< tod_norm<N> >, public noncopyable {
+public:
+    static const char *k_clazz; //!< Class name
+
+public:
+    /** \brief Performs the operation
+        \param t Tensor.
+        \param[out] norm Frobenius norm of the tensor.
+        \param[out] maxabs Largest absolute value of elements.
+     **/
+    void perform(dense_tensor_rd_i<N, double> &t, double &norm,
+        double &maxabs);
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOD_NORM_H
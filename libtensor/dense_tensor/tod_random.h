@@ -1,6 +1,7 @@
 #ifndef LIBTENSOR_TOD_RANDOM_H
 #define LIBTENSOR_TOD_RANDOM_H
 
+#include <stdint.h>
 #include <libtensor/timings.h>
 #include <libtensor/core/noncopyable.h>
 #include <libtensor/core/scalar_transf_double.h>
@@ -16,6 +17,11 @@ namespace libtensor {
     distributed in the intervall [0;1[ or adds those numbers to the tensor
     scaled by a coefficient.
 
+    The numbers are taken from a substream of counter_rng. Unless the stream
+    and substream are given, each call to perform() uses a new stream.
+
+    \sa counter_rng
+
     \ingroup libtensor_dense_tensor_tod
  **/
 template<size_t N>
@@ -25,6 +31,9 @@ public:
 
 private:
     double m_c; // Scaling coefficient
+    bool m_keyed; //!< Whether the stream is given
+    uint64_t m_stream; //!< Stream
+    uint64_t m_substream; //!< Substream
 
 public:
     /** \brief Prepares the operation
@@ -37,6 +46,14 @@ public:
      **/
     tod_random(double c);
 
+    /** \brief Prepares the operation using the given substream
+        \param c Scalar transformation.
+        \param stream Stream number (\sa counter_rng::next_stream).
+        \param substream Substream number.
+     **/
+    tod_random(const scalar_transf<double> &c, uint64_t stream,
+        uint64_t substream);
+
     /** \brief Perform operation
         \param zero Zero tensor first
         \param t Tensor to put random data
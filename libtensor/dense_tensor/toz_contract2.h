@@ -0,0 +1,99 @@
+#ifndef LIBTENSOR_TOZ_CONTRACT2_H
+#define LIBTENSOR_TOZ_CONTRACT2_H
+
+#include <complex>
+#include <libtensor/timings.h>
+#include <libtensor/core/contraction2.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/scalar_transf_complex.h>
+#include <libtensor/dense_tensor/dense_tensor_i.h>
+#include "to_contract2_dims.h"
+
+
+namespace libtensor {
+
+
+/** \brief Contraction of two complex dense tensors
+    \tparam N Order of first tensor (A) less contraction degree.
+    \tparam M Order of second tensor (B) less contraction degree.
+    \tparam K Contraction degree (number of inner indexes).
+
+    Complex counterpart of tod_contract2: computes
+    \f$ C = C + d \sum A B \f$ (or \f$ C = d \sum A B \f$ if zero is set)
+    for tensors of std::complex<double>.
+
+    The contraction is done as transpose-transpose-GEMM-transpose: A and B
+    are brought to the matrix forms [outer | inner] or [inner | outer] with
+    the outer indexes in the order of C and the inner indexes in a common
+    order, the product is formed by a single complex matrix multiplication
+    (linalg::mul2_ij_x, ZGEMM with the CBLAS backend) and permuted into C.
+    The layouts are chosen so that arguments already in a matrix form are
+    used in place, and the permutations that are identities are skipped.
+    The whole contraction thus costs one call to ZGEMM rather than four real
+    contractions on split real and imaginary parts.
+
+    \sa tod_contract2, toz_copy
+
+    \ingroup libtensor_dense_tensor_tod
+ **/
+template<size_t N, size_t M, size_t K>
+class toz_contract2 :
+    public timings< toz_contract2<N, M, K> >,
+    public noncopyable {
+public:
+    static const char *k_clazz;
+
+    typedef std::complex<double> element_type;
+
+public:
+    enum {
+        k_ordera = N + K, //!< Order of first argument (A)
+        k_orderb = M + K, //!< Order of second argument (B)
+        k_orderc = N + M //!< Order of result (C)
+    };
+
+private:
+    contraction2<N, M, K> m_contr; //!< Contraction
+    dense_tensor_rd_i<k_ordera, element_type> &m_ta; //!< First tensor (A)
+    dense_tensor_rd_i<k_orderb, element_type> &m_tb; //!< Second tensor (B)
+    element_type m_d; //!< Scaling factor
+    to_contract2_dims<N, M, K> m_dimsc; //!< Dimensions of result
+
+public:
+    /** \brief Initializes the contraction operation
+        \param contr Contraction.
+        \param ta First contracted tensor A.
+        \param tb Second contracted tensor B.
+        \param d Scaling factor d (default 1.0).
+     **/
+    toz_contract2(
+        const contraction2<N, M, K> &contr,
+        dense_tensor_rd_i<k_ordera, element_type> &ta,
+        dense_tensor_rd_i<k_orderb, element_type> &tb,
+        const element_type &d = 1.0);
+
+    /** \brief Computes the contraction
+        \param zero Zero result first.
+        \param tc Output tensor.
+     **/
+    void perform(bool zero, dense_tensor_wr_i<k_orderc, element_type> &tc);
+
+private:
+    /** \brief Lays out an argument as [outer | inner] or [inner | outer],
+            prefers the one that needs no permutation
+        \param out Outer indexes.
+        \param inn Inner indexes.
+        \param[out] seq Index order of the matrix form.
+        \param[out] perm Whether the argument needs to be permuted.
+        \return True if the inner indexes go first.
+     **/
+    template<size_t L>
+    static bool layout(const sequence<L, size_t> &out,
+        const sequence<K, size_t> &inn, sequence<L, size_t> &seq,
+        bool &perm);
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOZ_CONTRACT2_H
@@ -0,0 +1,85 @@
+#ifndef LIBTENSOR_TOZ_COPY_H
+#define LIBTENSOR_TOZ_COPY_H
+
+#include <complex>
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/scalar_transf_complex.h>
+#include <libtensor/core/tensor_transf.h>
+#include "dense_tensor_i.h"
+
+namespace libtensor {
+
+
+/** \brief Copies the contents of a complex tensor, permutes and scales the
+        entries if necessary
+    \tparam N Tensor order.
+
+    Complex counterpart of tod_copy: makes a transformed copy of a tensor
+    of std::complex<double>. The result can replace or be added to the
+    output tensor.
+
+    \code
+    dense_tensor_i<2, std::complex<double> > &t1(...), &t2(...);
+    permutation<2> perm; perm.permute(0, 1);
+    toz_copy<2> cp(t1, perm, std::complex<double>(0.0, 1.0));
+    cp.perform(true, t2); // Copies transposed t1 multiplied by i to t2
+    \endcode
+
+    \sa tod_copy
+
+    \ingroup libtensor_dense_tensor_tod
+ **/
+template<size_t N>
+class toz_copy : public timings< toz_copy<N> >, public noncopyable {
+public:
+    static const char *k_clazz; //!< Class name
+
+    typedef std::complex<double> element_type;
+    typedef tensor_transf<N, element_type> tensor_transf_t;
+
+private:
+    dense_tensor_rd_i<N, element_type> &m_ta; //!< Source tensor
+    permutation<N> m_perm; //!< Permutation of indexes
+    element_type m_c; //!< Scaling coefficient
+    dimensions<N> m_dimsb; //!< Dimensions of output tensor
+
+public:
+    /** \brief Prepares the permute & copy operation
+        \param ta Source tensor.
+        \param tr Tensor transformation.
+     **/
+    toz_copy(dense_tensor_rd_i<N, element_type> &ta,
+        const tensor_transf_t &tr = tensor_transf_t());
+
+    /** \brief Prepares the permute & copy operation
+        \param ta Source tensor.
+        \param p Permutation of tensor indexes.
+        \param c Coefficient.
+     **/
+    toz_copy(dense_tensor_rd_i<N, element_type> &ta, const permutation<N> &p,
+        const element_type &c = 1.0);
+
+    /** \brief Runs the operation
+        \param zero Overwrite/add to flag.
+        \param tb Output tensor.
+     **/
+    void perform(bool zero, dense_tensor_wr_i<N, element_type> &tb);
+
+    /** \brief Permutes and scales a raw array (b = c P a or b += c P a)
+        \param dimsa Dimensions of the source array.
+        \param perm Permutation of indexes (as in the constructor).
+        \param c Coefficient.
+        \param zero Overwrite/add to flag.
+        \param pa Source array.
+        \param pb Output array.
+     **/
+    static void perform_raw(const dimensions<N> &dimsa,
+        const permutation<N> &perm, const element_type &c, bool zero,
+        const element_type *pa, element_type *pb);
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_TOZ_COPY_H
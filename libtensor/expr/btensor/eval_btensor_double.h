@@ -1,6 +1,7 @@
 #ifndef LIBTENSOR_EXPR_EVAL_BTENSOR_DOUBLE_H
 #define LIBTENSOR_EXPR_EVAL_BTENSOR_DOUBLE_H
 
+#include <cstddef>
 #include <libtensor/expr/dag/expr_tree.h>
 #include <libtensor/expr/eval/eval_i.h>
 
@@ -37,6 +38,19 @@ public:
      **/
     static void use_libxm(bool usexm);
 
+    /** \brief Returns the memory of intermediates planned for the most
+            recent evaluation, in bytes
+
+        The plan is based on the dimensions of the intermediates and does
+        not take their symmetry or sparsity into account.
+     **/
+    static size_t get_planned_peak();
+
+    /** \brief Returns the peak memory of the blocks of intermediates
+            in the most recent evaluation, in bytes
+     **/
+    static size_t get_achieved_peak();
+
 };
 
 
@@ -0,0 +1,182 @@
+#ifndef LIBTENSOR_EXPR_FACTORIZED_BTENSOR_H
+#define LIBTENSOR_EXPR_FACTORIZED_BTENSOR_H
+
+#include <map>
+#include <libtensor/exception.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/expr/dag/expr_tree.h>
+#include <libtensor/expr/dag/node_contract.h>
+#include <libtensor/expr/iface/expr_rhs.h>
+#include <libtensor/expr/iface/node_ident_any_tensor.h>
+#include "btensor_i.h"
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Base class of factorized block tensors, keeps the statistics of
+        contractions through factors
+
+    \ingroup libtensor_expr_btensor
+ **/
+class factorized_btensor_base : public noncopyable {
+public:
+    virtual ~factorized_btensor_base() { }
+
+    /** \brief Records a contraction evaluated through the factors
+        \param avoided Size of the full tensor in bytes, which was not formed.
+        \param interm Size of the intermediate formed instead in bytes.
+     **/
+    static void record_contraction(size_t avoided, size_t interm);
+
+    /** \brief Returns the number of contractions evaluated through factors
+     **/
+    static size_t get_ncontractions();
+
+    /** \brief Returns the total size of full tensors not formed in bytes
+     **/
+    static size_t get_avoided_bytes();
+
+    /** \brief Returns the total size of intermediates formed instead in bytes
+     **/
+    static size_t get_interm_bytes();
+
+    /** \brief Returns the memory saved in bytes (the size of the tensors not
+            formed less the size of the intermediates, but at least zero)
+     **/
+    static size_t get_saved_bytes();
+
+    /** \brief Resets the statistics
+     **/
+    static void reset_stats();
+
+};
+
+
+/** \brief Block tensor given by two factors
+    \tparam N Number of indexes of the first factor (without the factor
+        index).
+    \tparam M Number of indexes of the second factor (without the factor
+        index).
+    \tparam T Tensor element type.
+
+    Represents the tensor
+    \f[ T_{IJ} = \sum_L A_{IL} B_{JL} \f]
+    where I and J are groups of N and M indexes, and L is the last index of
+    both factors. This is the form of Cholesky (see btod_cholesky) and
+    density fitting factorizations of the two-electron integrals.
+
+    The tensor is never formed unless an expression requires it as a whole.
+    In expressions the tensor is expanded into the contraction of its
+    factors. When the tensor is an argument of another contraction, the
+    evaluator contracts the other argument with one of the factors first
+    (whichever order takes fewer operations) and the result with the other
+    factor, which needs no more than an intermediate with the factor index.
+
+    \code
+    factorized_btensor<2, 2> eri(b, b); // (pq|rs) = sum_L B_pqL B_rsL
+    e(i|j|a|b) = contract(c|d, t(i|j|c|d), eri(a|c|b|d));
+    \endcode
+
+    The factors must remain valid while the object is in use.
+
+    \ingroup libtensor_expr_btensor
+ **/
+template<size_t N, size_t M, typename T = double>
+class factorized_btensor :
+    public factorized_btensor_base, public any_tensor<N + M, T> {
+
+public:
+    static const char k_tensor_type[];
+
+private:
+    btensor_i<N + 1, T> &m_a; //!< First factor
+    btensor_i<M + 1, T> &m_b; //!< Second factor
+
+public:
+    /** \brief Initializes the tensor
+        \param a First factor A_{IL}.
+        \param b Second factor B_{JL}.
+     **/
+    factorized_btensor(btensor_i<N + 1, T> &a, btensor_i<M + 1, T> &b);
+
+    /** \brief Virtual destructor
+     **/
+    virtual ~factorized_btensor() { }
+
+    virtual const char *get_tensor_type() const {
+        return k_tensor_type;
+    }
+
+    /** \brief Returns the first factor
+     **/
+    btensor_i<N + 1, T> &get_factor_a() const {
+        return m_a;
+    }
+
+    /** \brief Returns the second factor
+     **/
+    btensor_i<M + 1, T> &get_factor_b() const {
+        return m_b;
+    }
+
+protected:
+    /** \brief Expands the tensor into the contraction of the factors
+     **/
+    virtual expr_rhs<N + M, T> make_rhs(const label<N + M> &l);
+
+};
+
+
+template<size_t N, size_t M, typename T>
+const char factorized_btensor<N, M, T>::k_tensor_type[] =
+    "factorized_btensor";
+
+
+template<size_t N, size_t M, typename T>
+factorized_btensor<N, M, T>::factorized_btensor(btensor_i<N + 1, T> &a,
+    btensor_i<M + 1, T> &b) :
+
+    any_tensor<N + M, T>(*this), m_a(a), m_b(b) {
+
+    const block_index_space<N + 1> &bisa = m_a.get_bis();
+    const block_index_space<M + 1> &bisb = m_b.get_bis();
+    if(bisa.get_dims()[N] != bisb.get_dims()[M] ||
+        !bisa.get_splits(bisa.get_type(N)).equals(
+            bisb.get_splits(bisb.get_type(M)))) {
+
+        throw bad_parameter(g_ns, "factorized_btensor<N, M, T>",
+            "factorized_btensor()", __FILE__, __LINE__,
+            "Incompatible factor indexes.");
+    }
+}
+
+
+template<size_t N, size_t M, typename T>
+expr_rhs<N + M, T> factorized_btensor<N, M, T>::make_rhs(
+    const label<N + M> &l) {
+
+    std::multimap<size_t, size_t> cseq;
+    cseq.insert(std::pair<size_t, size_t>(N, N + 1 + M));
+
+    expr_tree e(node_contract(N + M, cseq, true, true));
+    expr_tree::node_id_t id = e.get_root();
+    e.add(id, node_ident_any_tensor<N + 1, T>(m_a));
+    e.add(id, node_ident_any_tensor<M + 1, T>(m_b));
+
+    return expr_rhs<N + M, T>(e, l);
+}
+
+
+} // namespace expr
+} // namespace libtensor
+
+
+namespace libtensor {
+
+using expr::factorized_btensor;
+using expr::factorized_btensor_base;
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_FACTORIZED_BTENSOR_H
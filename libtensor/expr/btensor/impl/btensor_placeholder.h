@@ -1,6 +1,9 @@
 #ifndef LIBTENSOR_EXPR_BTENSOR_PLACEHOLDER_H
 #define LIBTENSOR_EXPR_BTENSOR_PLACEHOLDER_H
 
+#include <mutex>
+#include <vector>
+#include <libtensor/block_tensor/block_tensor_ctrl.h>
 #include <libtensor/expr/btensor/btensor.h>
 
 namespace libtensor {
@@ -14,6 +17,17 @@ public:
 };
 
 
+/** \brief Placeholder for an intermediate block tensor of an expression
+
+    The tensor is created on the first assignment and destroyed either
+    explicitly or together with the placeholder. A tensor released via
+    recycle_btensor() goes to a pool instead and is handed to the next
+    intermediate with the same block index space. The pool keeps the tensor
+    object along with its block map, while the data of the blocks is freed.
+    The pool is emptied by clear_pool().
+
+    \ingroup libtensor_expr_btensor
+ **/
 template<size_t N, typename T>
 class btensor_placeholder :
     public btensor_placeholder_base, public any_tensor<N, T> {
@@ -38,7 +52,8 @@ public:
 
     void create_btensor(const block_index_space<N> &bis) {
         destroy_btensor();
-        m_bt = new btensor<N, T>(bis);
+        m_bt = take_from_pool(bis);
+        if(m_bt == 0) m_bt = new btensor<N, T>(bis);
     }
 
     void destroy_btensor() {
@@ -46,6 +61,20 @@ public:
         m_bt = 0;
     }
 
+    /** \brief Zeroes the tensor and returns it to the pool for reuse
+     **/
+    void recycle_btensor() {
+        if(m_bt == 0) return;
+        {
+            block_tensor_ctrl<N, T> ctrl(*m_bt);
+            ctrl.req_zero_all_blocks();
+            ctrl.req_symmetry().clear();
+        }
+        std::lock_guard<std::mutex> lock(get_pool_mutex());
+        get_pool().push_back(m_bt);
+        m_bt = 0;
+    }
+
     bool is_empty() const {
         return m_bt == 0;
     }
@@ -62,6 +91,39 @@ public:
         return t.template get_tensor< btensor_placeholder<N, T> >();
     }
 
+    /** \brief Destroys all the tensors in the pool
+     **/
+    static void clear_pool() {
+        std::lock_guard<std::mutex> lock(get_pool_mutex());
+        std::vector<btensor<N, T>*> &pool = get_pool();
+        for(size_t i = 0; i < pool.size(); i++) delete pool[i];
+        pool.clear();
+    }
+
+private:
+    static btensor<N, T> *take_from_pool(const block_index_space<N> &bis) {
+        std::lock_guard<std::mutex> lock(get_pool_mutex());
+        std::vector<btensor<N, T>*> &pool = get_pool();
+        for(size_t i = 0; i < pool.size(); i++) {
+            if(pool[i]->get_bis().equals(bis)) {
+                btensor<N, T> *bt = pool[i];
+                pool.erase(pool.begin() + i);
+                return bt;
+            }
+        }
+        return 0;
+    }
+
+    static std::vector<btensor<N, T>*> &get_pool() {
+        static std::vector<btensor<N, T>*> pool;
+        return pool;
+    }
+
+    static std::mutex &get_pool_mutex() {
+        static std::mutex mtx;
+        return mtx;
+    }
+
 };
 
 
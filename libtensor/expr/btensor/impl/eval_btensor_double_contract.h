@@ -1,6 +1,7 @@
 #ifndef LIBTENSOR_EXPR_EVAL_BTENSOR_DOUBLE_CONTRACT_H
 #define LIBTENSOR_EXPR_EVAL_BTENSOR_DOUBLE_CONTRACT_H
 
+#include <libtensor/expr/dag/graph.h>
 #include "../eval_btensor.h"
 #include "eval_btensor_evaluator_i.h"
 
@@ -45,6 +46,22 @@ public:
 extern bool use_libxm; //!< Swtich between native/libxm btod_contract
 
 
+/** \brief Rewrites contractions with factorized tensors to contract through
+        the factors
+
+    Replaces every contraction of an expression X with the expansion of a
+    factorized tensor (see factorized_btensor)
+    \f[ \sum X T, \quad T_{IJ} = \sum_L A_{IL} B_{JL} \f]
+    by \f$ \sum (\sum X A) B \f$ or \f$ \sum (\sum X B) A \f$, whichever
+    takes fewer operations, so the full tensor T is never formed. Expansions
+    that are not arguments of a contraction are left as they are.
+
+    The sizes of the tensors not formed and of the intermediates are
+    recorded in the statistics of factorized_btensor_base.
+ **/
+void contract_through_factors(graph &g);
+
+
 } // namespace eval_btensor_double
 } // namespace expr
 } // namespace libtensor
@@ -7,6 +7,19 @@ namespace libtensor {
 namespace expr {
 
 
+/** \brief Prepares an expression tree for the evaluation with block tensors
+
+    Besides transforming the tree, the builder plans the memory used by
+    the intermediates. The assignments are ordered depth first, and among
+    the independent subtrees of a node those that need more memory than
+    they leave behind are evaluated first (the ordering that minimizes
+    the peak for trees). The sizes of the intermediates are estimated from
+    the dimensions of the tensors, ignoring symmetry and sparsity. Then
+    the last use of each intermediate is determined, so that it can be
+    released right after the assignment that reads it for the last time.
+
+    \ingroup libtensor_expr_btensor
+ **/
 class eval_tree_builder_btensor {
 public:
     static const char k_clazz[]; //!< Class name
@@ -20,11 +33,13 @@ public:
 
 private:
     expr_tree m_tree; //!< Evaluation tree
-    eval_order_t m_order;
+    eval_order_t m_order; //!< Order of assignments
+    std::vector<eval_order_t> m_release; //!< Intermediates to release
+    size_t m_peak; //!< Planned peak memory of intermediates in bytes
 
 public:
     eval_tree_builder_btensor(const expr_tree &tr) :
-        m_tree(tr), m_order(0)
+        m_tree(tr), m_order(0), m_peak(0)
     { }
 
     /** \brief Modifies the expression tree for direct evaluation
@@ -40,6 +55,20 @@ public:
     const eval_order_t &get_order() {
         return m_order;
     }
+
+    /** \brief Returns the intermediates that are used for the last time by
+            each assignment in the evaluation order
+     **/
+    const std::vector<eval_order_t> &get_release() {
+        return m_release;
+    }
+
+    /** \brief Returns the planned peak memory of intermediates in bytes
+            (estimated from the dimensions of the tensors)
+     **/
+    size_t get_planned_peak() const {
+        return m_peak;
+    }
 };
 
 
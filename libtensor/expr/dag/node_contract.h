@@ -23,6 +23,11 @@ namespace expr {
     would be represented by the contraction map
     \code { {1,2},{3,4} } \endcode
 
+    A contraction can be marked as the expansion of a factorized tensor
+    (see factorized_btensor). Evaluators then contract through the factors
+    when the node is itself an argument of a contraction instead of forming
+    its result.
+
     \ingroup libtensor_expr
  **/
 class node_contract : public node {
@@ -32,18 +37,22 @@ public:
 private:
     std::multimap<size_t, size_t> m_map; //!< Map
     bool m_do_contr; //!< Perform contraction
+    bool m_factorized; //!< Expansion of a factorized tensor
 
 public:
     /** \brief Creates a contraction node of two tensors
         \param n Order of result
         \param map Contraction map
         \param do_contr Perform summation
+        \param factorized Node is the expansion of a factorized tensor
      **/
     node_contract(
         size_t n,
         const std::multimap<size_t, size_t> &map,
-        bool do_contr = true) :
-        node(node_contract::k_op_type, n), m_map(map), m_do_contr(do_contr)
+        bool do_contr = true,
+        bool factorized = false) :
+        node(node_contract::k_op_type, n), m_map(map), m_do_contr(do_contr),
+        m_factorized(factorized)
     { }
 
     /** \brief Virtual destructor
@@ -68,6 +77,13 @@ public:
         return m_do_contr;
     }
 
+    /** \brief Returns whether the node is the expansion of a factorized
+            tensor
+     **/
+    bool is_factorized() const {
+        return m_factorized;
+    }
+
 };
 
 
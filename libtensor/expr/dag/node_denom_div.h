@@ -0,0 +1,56 @@
+#ifndef LIBTENSOR_EXPR_NODE_DENOM_DIV_H
+#define LIBTENSOR_EXPR_NODE_DENOM_DIV_H
+
+#include "node.h"
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Tensor expression node: division by an energy denominator
+
+    The node has N + 1 arguments: the tensor to be divided followed by one
+    vector for each of its dimensions, in the order of the dimensions. The
+    denominator is the direct sum of the (scaled) vectors plus a shift.
+
+    \ingroup libtensor_expr_dag
+ **/
+class node_denom_div : public node {
+public:
+    static const char k_op_type[]; //!< Operation type
+
+private:
+    double m_shift; //!< Shift of the denominator
+
+public:
+    /** \brief Creates the node
+        \param n Tensor order.
+        \param shift Shift of the denominator.
+     **/
+    node_denom_div(size_t n, double shift = 0.0) :
+        node(k_op_type, n), m_shift(shift)
+    { }
+
+    /** \brief Virtual destructor
+     **/
+    virtual ~node_denom_div() { }
+
+    /** \brief Creates a copy of the node via new
+     **/
+    virtual node *clone() const {
+        return new node_denom_div(*this);
+    }
+
+    /** \brief Returns the shift of the denominator
+     **/
+    double get_shift() const {
+        return m_shift;
+    }
+
+};
+
+
+} // namespace expr
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_NODE_DENOM_DIV_H
@@ -0,0 +1,69 @@
+#ifndef LIBTENSOR_EXPR_NODE_EWISE_H
+#define LIBTENSOR_EXPR_NODE_EWISE_H
+
+#include <vector>
+#include "node.h"
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Tensor expression node: fused chain of element-wise operations
+
+    The node replaces a tree of element-wise additions, multiplications
+    and divisions, which is then evaluated in one pass without forming
+    intermediates. The arguments of the node are the leaves of the tree
+    transformed to the index order of the result. The tree itself is kept
+    as a program in postfix notation: k_arg takes the next argument, the
+    other instructions replace the two topmost entries of the stack with
+    the result of the operation.
+
+    \ingroup libtensor_expr_dag
+ **/
+class node_ewise : public node {
+public:
+    static const char k_op_type[]; //!< Operation type
+
+    //! Instructions
+    enum {
+        k_arg, //!< Push next argument
+        k_add, //!< Add two topmost entries
+        k_mul, //!< Multiply two topmost entries
+        k_div //!< Divide second topmost by topmost entry
+    };
+
+private:
+    std::vector<int> m_prog; //!< Program
+
+public:
+    /** \brief Creates the node
+        \param n Tensor order.
+        \param prog Program in postfix notation.
+     **/
+    node_ewise(size_t n, const std::vector<int> &prog) :
+        node(k_op_type, n), m_prog(prog)
+    { }
+
+    /** \brief Virtual destructor
+     **/
+    virtual ~node_ewise() { }
+
+    /** \brief Creates a copy of the node via new
+     **/
+    virtual node *clone() const {
+        return new node_ewise(*this);
+    }
+
+    /** \brief Returns the program
+     **/
+    const std::vector<int> &get_prog() const {
+        return m_prog;
+    }
+
+};
+
+
+} // namespace expr
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_NODE_EWISE_H
@@ -0,0 +1,114 @@
+#ifndef LIBTENSOR_EXPR_OPERATORS_DENOM_DIV_H
+#define LIBTENSOR_EXPR_OPERATORS_DENOM_DIV_H
+
+#include <libtensor/expr/dag/node_denom_div.h>
+#include <libtensor/expr/expr_exception.h>
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Division by an energy denominator made of vectors (implementation)
+    \tparam N Tensor order.
+    \tparam T Tensor element type.
+
+    The vectors are matched to the dimensions of the expression by their
+    letters, each letter of the expression has to be covered by exactly
+    one vector.
+
+    \ingroup libtensor_expr_operators
+ **/
+template<size_t N, typename T>
+expr_rhs<N, T> denom_div(
+    const expr_rhs<N, T> &r,
+    const expr_rhs<1, T> *const *d,
+    size_t nd,
+    double shift) {
+
+    static const char method[] = "denom_div(const expr_rhs<N, T> &, "
+        "const expr_rhs<1, T>*const*, size_t, double)";
+
+    if(nd != N) {
+        throw expr_exception(g_ns, "", method, __FILE__, __LINE__,
+            "Number of vectors does not match the tensor order.");
+    }
+
+    expr_tree e(node_denom_div(N, shift));
+    expr_tree::node_id_t id = e.get_root();
+    e.add(id, r.get_expr());
+
+    for(size_t i = 0; i < N; i++) {
+        const letter &l = r.letter_at(i);
+        const expr_rhs<1, T> *di = 0;
+        for(size_t k = 0; k < nd; k++) {
+            if(!d[k]->contains(l)) continue;
+            if(di != 0) {
+                throw expr_exception(g_ns, "", method, __FILE__, __LINE__,
+                    "Duplicate letter.");
+            }
+            di = d[k];
+        }
+        if(di == 0) {
+            throw expr_exception(g_ns, "", method, __FILE__, __LINE__,
+                "Letter not found.");
+        }
+        e.add(id, di->get_expr());
+    }
+
+    return expr_rhs<N, T>(e, r.get_label());
+}
+
+
+/** \brief Divides a two-index expression by the energy denominator
+        \f$ d_1 + d_2 + s \f$
+
+    The letters of the vectors select the indexes of the expression, e.g.
+    denom_div(r(i|a), e_o(i), -e_v(a)).
+
+    \ingroup libtensor_expr_operators
+ **/
+template<size_t N, typename T>
+expr_rhs<N, T> denom_div(
+    const expr_rhs<N, T> &r,
+    const expr_rhs<1, T> &d1,
+    const expr_rhs<1, T> &d2,
+    double shift = 0.0) {
+
+    const expr_rhs<1, T> *d[2] = { &d1, &d2 };
+    return denom_div(r, d, 2, shift);
+}
+
+
+/** \brief Divides a four-index expression by the energy denominator
+        \f$ d_1 + d_2 + d_3 + d_4 + s \f$
+
+    The letters of the vectors select the indexes of the expression, e.g.
+    denom_div(r(i|j|a|b), e_o(i), e_o(j), -e_v(a), -e_v(b)).
+
+    \ingroup libtensor_expr_operators
+ **/
+template<size_t N, typename T>
+expr_rhs<N, T> denom_div(
+    const expr_rhs<N, T> &r,
+    const expr_rhs<1, T> &d1,
+    const expr_rhs<1, T> &d2,
+    const expr_rhs<1, T> &d3,
+    const expr_rhs<1, T> &d4,
+    double shift = 0.0) {
+
+    const expr_rhs<1, T> *d[4] = { &d1, &d2, &d3, &d4 };
+    return denom_div(r, d, 4, shift);
+}
+
+
+} // namespace expr
+} // namespace libtensor
+
+
+namespace libtensor {
+
+using expr::denom_div;
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_OPERATORS_DENOM_DIV_H
@@ -6,6 +6,7 @@
  **/
 
 #include "contract.h"
+#include "denom_div.h"
 #include "diag.h"
 #include "dirsum.h"
 #include "dot_product.h"
@@ -1,10 +1,12 @@
 #ifndef LIBTENSOR_BLOCK_MAP_H
 #define LIBTENSOR_BLOCK_MAP_H
 
-#include <map>
+#include <atomic>
 #include <vector>
 #include <libtensor/core/block_index_space.h>
 #include <libtensor/core/immutable.h>
+#include "block_metadata.h"
+#include "impl/block_table.h"
 
 namespace libtensor {
 
@@ -18,8 +20,26 @@ namespace libtensor {
     keys. This class maintains such a map and provides facility to create and
     remove blocks. All the necessary memory management is done here as well.
 
-    This implementation is not thread safe. Calls must be externally
-        synchronized.
+    The blocks are kept in a block_table: a dense array of pointers for small
+    block grids or an open addressing hash table for large ones.
+
+    Along with the blocks the map keeps a cache of block metadata (see
+    block_metadata). Each time a block is created or invalidated, its version
+    is bumped, so metadata computed from an older version of a block are
+    never stored. The cached metadata are published with a sequence lock:
+    readers never block, a reader that overlaps with a writer reports
+    the metadata out of date. The block traits shall define
+    \c block_norm_type<N>::type, the operation used to compute the metadata.
+
+    Lookups (contains(), find(), get()), get_metadata(), set_metadata() and
+    invalidate_metadata() are lock-free and may run concurrently with each
+    other and with the creation or removal of other blocks. To make this safe,
+    the bookkeeping node of a removed block is retired rather than freed, and
+    reused when a block with the same index is created again; so a concurrent
+    lookup never touches freed memory and never returns a node that belongs
+    to a different block. The blocks themselves are destroyed on removal, so
+    a block must not be removed while it is in use. create(), remove() and
+    clear() must be externally synchronized with each other.
 
     \ingroup libtensor_gen_block_tensor
  **/
@@ -28,26 +48,43 @@ class block_map : public immutable {
 public:
     typedef typename BtTraits::element_type element_type;
     typedef typename BtTraits::template block_type<N>::type block_type;
+    typedef typename BtTraits::bti_traits::template rd_block_type<N>::type
+        rd_block_type;
     typedef typename BtTraits::template block_factory_type<N>::type
         block_factory_type;
-    typedef std::map<size_t, block_type*> map_type;
+    typedef block_metadata<element_type> metadata_type;
+
+private:
+    struct block_node {
+        std::atomic<block_type*> blk; //!< Block (null if removed)
+        std::atomic<size_t> version; //!< Version of block contents
+        std::atomic<size_t> mdversion; //!< Version of cached metadata
+        std::atomic<element_type> mdnorm; //!< Cached norm
+        std::atomic<element_type> mdmaxabs; //!< Cached largest abs value
+    };
+    typedef block_table<block_node> map_type;
 
 private:
     static const char *k_clazz; //!< Class name
+    static const size_t k_busy = size_t(-1); //!< Metadata are being written
 
 public:
     dimensions<N> m_bidims; //!< Block index dimensions
     block_factory_type m_bf; //!< Block factory
-    map_type m_map; //!< Map that stores all the pointers
+    map_type m_map; //!< Table that stores all the pointers
+    map_type m_retired; //!< Nodes of removed blocks (for reuse)
     mutable std::vector<size_t> m_cached_blst; //!< Cached list of blocks
     mutable bool m_dirty_cache; //!< Whether the cache needs an update
+    std::atomic<size_t> m_version; //!< Last issued block version
 
 public:
     /** \brief Constructs the map
         \param bis Block index space.
      **/
     block_map(const block_index_space<N> &bis) :
-        m_bidims(bis.get_block_index_dims()), m_bf(bis), m_dirty_cache(true)
+        m_bidims(bis.get_block_index_dims()), m_bf(bis),
+        m_map(m_bidims.get_size()), m_retired(m_bidims.get_size()),
+        m_dirty_cache(true), m_version(0)
     { }
 
     /** \brief Destroys the map and all the blocks
@@ -78,6 +115,12 @@ public:
      **/
     void get_all(std::vector<size_t> &blst) const;
 
+    /** \brief Returns the pointer to a block identified by the index or null
+            if the block does not exist
+        \param idx Index of the block.
+     **/
+    block_type *find(const index<N> &idx) const;
+
     /** \brief Returns the reference to a block identified by the index
         \param idx Index of the block.
         \throw block_not_found If the index supplied does not correspond
@@ -90,10 +133,49 @@ public:
      **/
     void clear();
 
+    /** \brief Returns the cached metadata of a block (lock-free)
+        \param idx Index of the block.
+        \param[out] md Metadata if they are up to date.
+        \param[out] version Current version of the block.
+        \return True if the cached metadata are up to date, false otherwise.
+        \throw block_not_found If the block does not exist.
+     **/
+    bool get_metadata(const index<N> &idx, metadata_type &md,
+        size_t &version) const;
+
+    /** \brief Stores the metadata computed from a given version of a block
+            (lock-free). The metadata are dropped if the block has changed
+            since or another thread is storing metadata at the same time
+        \param idx Index of the block.
+        \param md Metadata.
+        \param version Version of the block the metadata were computed from.
+     **/
+    void set_metadata(const index<N> &idx, const metadata_type &md,
+        size_t version);
+
+    /** \brief Marks the metadata of a block out of date (to be called after
+            the block has been modified)
+        \param idx Index of the block.
+     **/
+    void invalidate_metadata(const index<N> &idx);
+
+    /** \brief Computes the metadata of a block from its contents
+        \param blk Block.
+     **/
+    static metadata_type compute_metadata(rd_block_type &blk);
+
 protected:
     virtual void on_set_immutable();
 
 private:
+    /** \brief Returns the node of a block or throws block_not_found
+     **/
+    block_node *get_node(const index<N> &idx, const char *method) const;
+
+    /** \brief Destroys the block of a removed node and retires the node
+     **/
+    void retire(size_t aidx, block_node *node);
+
     /** \brief Removes all blocks (without checking for immutability)
      **/
     void do_clear();
@@ -0,0 +1,39 @@
+#ifndef LIBTENSOR_BLOCK_METADATA_H
+#define LIBTENSOR_BLOCK_METADATA_H
+
+namespace libtensor {
+
+
+/** \brief Summary information about the contents of a tensor block
+    \tparam T Tensor element type.
+
+    Block metadata are cheap descriptors of a block that allow algorithms
+    to screen blocks without reading their data. Block tensors compute them
+    lazily when first requested and discard them when the block is returned
+    after writing.
+
+    \ingroup libtensor_gen_block_tensor
+ **/
+template<typename T>
+struct block_metadata {
+
+    T norm; //!< Frobenius norm of the block
+    T maxabs; //!< Largest absolute value of elements
+    bool zero; //!< Whether all the elements are zero
+
+    /** \brief Default constructor (metadata of a zero block)
+     **/
+    block_metadata() : norm(0), maxabs(0), zero(true) { }
+
+    /** \brief Initializing constructor (a block whose largest absolute value
+            is NaN is not zero)
+     **/
+    block_metadata(const T &norm_, const T &maxabs_) :
+        norm(norm_), maxabs(maxabs_), zero(maxabs_ == T(0)) { }
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BLOCK_METADATA_H
@@ -0,0 +1,30 @@
+#ifndef LIBTENSOR_BLOCK_STRUCTURE_VERSION_H
+#define LIBTENSOR_BLOCK_STRUCTURE_VERSION_H
+
+#include <cstddef>
+
+namespace libtensor {
+
+
+/** \brief Issues versions of block tensor structures
+
+    Versions are issued from a single process-wide counter, so a version
+    identifies the structure of one block tensor at one point in time even
+    if the tensor is destroyed and another one is created at the same
+    address. Zero is never issued.
+
+    \sa gen_block_tensor_rd_i::on_req_structure_version()
+
+    \ingroup libtensor_gen_block_tensor
+ **/
+class block_structure_version {
+public:
+    /** \brief Returns a new version
+     **/
+    static size_t next();
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BLOCK_STRUCTURE_VERSION_H
@@ -0,0 +1,70 @@
+#ifndef LIBTENSOR_DIRECT_BLOCK_CACHE_H
+#define LIBTENSOR_DIRECT_BLOCK_CACHE_H
+
+#include <cstddef> // for size_t
+
+namespace libtensor {
+
+
+/** \brief Policy of the block cache of direct block tensors
+
+    Blocks of a direct block tensor are computed on demand and normally
+    discarded as soon as they are no longer in use. With a cache, released
+    blocks are kept up to a given total size. Once the budget is exceeded,
+    the least recently used (LRU) or the least frequently used (LFU) blocks
+    are discarded first.
+
+    \sa direct_gen_block_tensor
+
+    \ingroup libtensor_gen_block_tensor
+ **/
+struct direct_block_cache_policy {
+
+    enum {
+        NONE, //!< No cache
+        LRU, //!< Discard least recently used blocks first
+        LFU //!< Discard least frequently used blocks first
+    };
+
+    int mode; //!< Cache mode
+    size_t max_bytes; //!< Largest total size of cached blocks in bytes
+
+    direct_block_cache_policy(int mode_ = NONE, size_t max_bytes_ = 0) :
+        mode(mode_), max_bytes(max_bytes_)
+    { }
+
+};
+
+
+/** \brief Statistics of the block cache of a direct block tensor
+
+    \ingroup libtensor_gen_block_tensor
+ **/
+struct direct_block_cache_stats {
+
+    size_t nhits; //!< Blocks taken from the cache
+    size_t nmisses; //!< Blocks computed
+    size_t nrecomputed; //!< Blocks computed not for the first time
+    size_t nevicted; //!< Blocks discarded from the cache
+    size_t cached_bytes; //!< Current size of cached blocks in bytes
+    double compute_time; //!< Time spent computing blocks (s)
+    double recompute_time; //!< Part of compute_time spent on recomputation
+
+    direct_block_cache_stats() :
+        nhits(0), nmisses(0), nrecomputed(0), nevicted(0), cached_bytes(0),
+        compute_time(0.0), recompute_time(0.0)
+    { }
+
+    /** \brief Returns the fraction of requests served from the cache
+     **/
+    double get_hit_ratio() const {
+        size_t n = nhits + nmisses;
+        return n == 0 ? 0.0 : double(nhits) / double(n);
+    }
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_DIRECT_BLOCK_CACHE_H
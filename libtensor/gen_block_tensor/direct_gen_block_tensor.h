@@ -1,9 +1,12 @@
 #ifndef LIBTENSOR_DIRECT_GEN_BLOCK_TENSOR_H
 #define LIBTENSOR_DIRECT_GEN_BLOCK_TENSOR_H
 
+#include <map>
+#include <set>
 #include <libutil/threads/mutex.h>
 #include <libutil/threads/cond_map.h>
 #include "block_map.h"
+#include "direct_block_cache.h"
 #include "direct_gen_block_tensor_base.h"
 
 namespace libtensor {
@@ -13,6 +16,18 @@ namespace libtensor {
     \tparam N Tensor order.
     \tparam BtTraits Block tensor traits.
 
+    Blocks are computed by the operation when requested. Several threads
+    requesting the same block share one computation, and the block is kept
+    while it is in use.
+
+    Optionally, released blocks are kept in a cache with a byte budget
+    (see direct_block_cache_policy). A block requested again is then taken
+    from the cache instead of being recomputed. The cache assumes that the
+    result of the operation does not change. If the arguments of the
+    operation are modified, the cache must be cleared by clear_cache().
+    The numbers of cache hits and misses and the time spent computing and
+    recomputing blocks are available from get_cache_stats().
+
     \ingroup libtensor_gen_block_tensor
  **/
 template<size_t N, typename BtTraits>
@@ -41,6 +56,22 @@ public:
     //! Type of block %tensor operation
     typedef typename base_t::operation_t operation_t;
 
+private:
+    struct cache_entry {
+        size_t nuse; //!< Number of times the block was requested
+        size_t ncomputed; //!< Number of times the block was computed
+        size_t last; //!< Time of last use
+        size_t bytes; //!< Size of the block in bytes
+        bool cached; //!< Whether the block is in the cache
+
+        cache_entry() :
+            nuse(0), ncomputed(0), last(0), bytes(0), cached(false)
+        { }
+    };
+
+    //! Key in the order of eviction: (time or frequency, time), block
+    typedef std::pair< std::pair<size_t, size_t>, size_t > evict_key_t;
+
 private:
     dimensions<N> m_bidims; //!< Block %index dims
     libutil::mutex m_lock; //!< Mutex lock
@@ -48,6 +79,11 @@ private:
     std::map<size_t, size_t> m_count; //!< Block count
     std::set<size_t> m_inprogress; //!< Computations in progress
     libutil::cond_map<size_t, size_t> m_cond; //!< Conditionals
+    direct_block_cache_policy m_cpolicy; //!< Cache policy
+    direct_block_cache_stats m_cstats; //!< Cache statistics
+    size_t m_tick; //!< Use counter
+    std::map<size_t, cache_entry> m_cache; //!< Use history of blocks
+    std::set<evict_key_t> m_evict; //!< Cached blocks in order of eviction
 
 public:
     //!    \name Construction and destruction
@@ -60,6 +96,31 @@ public:
 
     using direct_gen_block_tensor_base<N, bti_traits>::get_bis;
 
+    //!    \name Block cache
+    //@{
+
+    /** \brief Sets the cache policy, discards blocks that no longer fit
+     **/
+    void set_cache_policy(const direct_block_cache_policy &p);
+
+    /** \brief Returns the cache policy
+     **/
+    direct_block_cache_policy get_cache_policy();
+
+    /** \brief Discards all cached blocks
+     **/
+    void clear_cache();
+
+    /** \brief Returns the cache statistics
+     **/
+    direct_block_cache_stats get_cache_stats();
+
+    /** \brief Resets the cache statistics (except the size of the cache)
+     **/
+    void reset_cache_stats();
+
+    //@}
+
 protected:
     //!    \name Implementation of libtensor::gen_block_tensor_rd_i<N, bti_traits>
     //@{
@@ -71,6 +132,9 @@ protected:
     virtual void on_req_nonzero_blocks(std::vector<size_t> &nzlst);
     virtual rd_block_type &on_req_const_block(const index<N> &idx);
     virtual void on_ret_const_block(const index<N> &idx);
+    virtual block_metadata<element_type> on_req_block_metadata(
+        const index<N> &idx);
+    virtual size_t on_req_structure_version();
 
     //@}
 
@@ -79,6 +143,15 @@ protected:
 private:
     //! \brief Performs calculation of the given block
     void perform(const index<N>& idx);
+
+    //! \brief Returns the key of a cached block in the order of eviction
+    evict_key_t evict_key(size_t aidx, const cache_entry &ce) const;
+
+    //! \brief Keeps a released block in the cache if it fits the budget
+    bool cache_block(size_t aidx, const index<N> &idx);
+
+    //! \brief Discards cached blocks until the cache fits the budget
+    void evict(size_t max_bytes);
 };
 
 
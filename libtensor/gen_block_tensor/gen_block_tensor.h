@@ -1,11 +1,14 @@
 #ifndef LIBTENSOR_GEN_BLOCK_TENSOR_H
 #define LIBTENSOR_GEN_BLOCK_TENSOR_H
 
+#include <atomic>
 #include <libutil/threads/mutex.h>
+#include <libtensor/core/block_compression.h>
 #include <libtensor/core/block_index_space.h>
 #include <libtensor/core/immutable.h>
 #include <libtensor/core/noncopyable.h>
 #include "block_map.h"
+#include "block_structure_version.h"
 #include "gen_block_tensor_i.h"
 
 namespace libtensor {
@@ -55,6 +58,15 @@ namespace libtensor {
 	elements. Overall only non-zero blocks which are unique with respect to
 	symmetry are stored.
 
+	Blocks are created under the compression policy of the block %tensor
+	(\sa block_compression), which allocators that write blocks to disk
+	apply to them. The policy is taken from the calling thread when the
+	block %tensor is constructed and can be changed with set_compression().
+
+	Requests for existing blocks and for their cached metadata are served by
+	lock-free lookups in the block map. Only the creation and removal of
+	blocks and the first computation of metadata take the lock.
+
 	<b>Operations on block %tensor</b>
 
 	No mathematical operations on block tensors are implemented by this class.
@@ -86,7 +98,9 @@ public:
     dimensions<N> m_bidims; //!< Block index dimensions
     symmetry<N, element_type> m_symmetry; //!< Block tensor symmetry
     block_map<N, BtTraits> m_map; //!< Block map
-    libutil::mutex m_lock; //!< Read-write lock
+    libutil::mutex m_lock; //!< Lock for block creation and removal
+    std::atomic<size_t> m_sversion; //!< Version of the block structure
+    block_compression_policy m_cpolicy; //!< Compression of new blocks
 
 public:
     //!    \name Construction and destruction
@@ -100,6 +114,18 @@ public:
     virtual const block_index_space<N> &get_bis() const;
     //@}
 
+    /** \brief Sets the compression policy for blocks created from now on
+     **/
+    void set_compression(const block_compression_policy &p) {
+        m_cpolicy = p;
+    }
+
+    /** \brief Returns the compression policy
+     **/
+    const block_compression_policy &get_compression() const {
+        return m_cpolicy;
+    }
+
 protected:
     //!    \name Implementation of libtensor::gen_block_tensor_i<N, bti_traits>
     //@{
@@ -111,6 +137,9 @@ protected:
     virtual void on_ret_block(const index<N> &idx);
     virtual bool on_req_is_zero_block(const index<N> &idx);
     virtual void on_req_nonzero_blocks(std::vector<size_t> &nzlst);
+    virtual block_metadata<element_type> on_req_block_metadata(
+        const index<N> &idx);
+    virtual size_t on_req_structure_version();
     virtual void on_req_zero_block(const index<N> &idx);
     virtual void on_req_zero_all_blocks();
     //@}
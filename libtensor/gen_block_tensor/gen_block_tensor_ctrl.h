@@ -101,6 +101,21 @@ public:
         m_bt.on_req_nonzero_blocks(nzlst);
     }
 
+    /** \brief Returns the metadata (norm, largest absolute element, zero
+            flag) of a canonical block
+        \param idx Index of the block.
+     **/
+    block_metadata<element_type> req_block_metadata(const index<N> &idx) {
+        return m_bt.on_req_block_metadata(idx);
+    }
+
+    /** \brief Returns the version of the block structure (symmetry and set
+            of non-zero canonical blocks), zero if not tracked
+     **/
+    size_t req_structure_version() {
+        return m_bt.on_req_structure_version();
+    }
+
 };
 
 
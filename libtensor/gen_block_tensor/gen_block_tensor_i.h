@@ -5,6 +5,7 @@
 #include <vector>
 #include <libtensor/core/block_index_space.h>
 #include <libtensor/core/symmetry.h>
+#include "block_metadata.h"
 
 namespace libtensor {
 
@@ -108,6 +109,21 @@ protected:
      **/
     virtual void on_req_nonzero_blocks(std::vector<size_t> &nzlst) = 0;
 
+    /** \brief Invoked to obtain the metadata of a canonical block
+        \param idx Index of the block.
+        \return Metadata of the block (zero metadata if the block is zero).
+     **/
+    virtual block_metadata<element_type> on_req_block_metadata(
+        const index<N> &idx) = 0;
+
+    /** \brief Invoked to obtain the version of the block structure (symmetry
+            and set of non-zero canonical blocks)
+        \return Version that changes whenever the structure may have changed
+            and is never shared with another tensor, or zero if the structure
+            is not tracked.
+     **/
+    virtual size_t on_req_structure_version() = 0;
+
 };
 
 
@@ -39,6 +39,8 @@
     - template<N> to_compare_type::type -- Type of tensor comparison
     - template<N, M, K> to_contract2_type::type -- Type of tensor operation
         for contraction of two tensors
+    - template<N, M, K> to_contract2_type::batch_type -- Type of tensor
+        operation for grouped contractions into several tensors
     - template<N> to_copy_type::type -- Type of tensor operation for copy
     - template<N, M> to_diag_type::type -- Type of tensor operation for
         taking a generalized diagonal
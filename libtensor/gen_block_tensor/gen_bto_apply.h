@@ -42,6 +42,10 @@ namespace libtensor {
         \f$ f\left(\hat{T} x\right) = \hat{T}' f(x) \f$ (\f$\hat{T}\f$, if
         argument is true).
 
+    The functor is applied to the blocks by to_apply, which may use
+    an optional function to apply the functor to arrays of elements
+    (\sa tod_apply).
+
     The symmetry of the result tensor is determined by the symmetry operation
     so_apply. The use of this symmetry operation can result in the need to
     construct %tensor blocks from forbidden input %tensor blocks. Forbidden
@@ -1,6 +1,7 @@
 #ifndef LIBTENSOR_GEN_BTO_AUX_DOTPROD_H
 #define LIBTENSOR_GEN_BTO_AUX_DOTPROD_H
 
+#include <map>
 #include <libutil/threads/mutex.h>
 #include "gen_block_stream_i.h"
 #include "gen_block_tensor_i.h"
@@ -14,6 +15,11 @@ namespace libtensor {
     \tparam Traits Block tensor operation traits.
     \tparam Timed Timed implementation.
 
+    Blocks of B may arrive in any order and from several threads at once.
+    The contribution of each block is kept separately and the contributions
+    are summed in ascending order of block indexes in close(), so the result
+    does not depend on the number of threads.
+
     \ingroup libtensor_gen_bto
  **/
 template<size_t N, typename Traits>
@@ -42,6 +48,7 @@ private:
     block_index_space<N> m_bisb; //!< Block index space of second argument (B)
     symmetry<N, element_type> m_symb; //!< Symmetry of B
     symmetry<N, element_type> m_symc; //!< Symmetry of A*B
+    std::map<size_t, element_type> m_parts; //!< Partial sums
     element_type m_d; //!< Dot product
     libutil::mutex m_mtx; //!< Mutex
 
@@ -61,7 +68,8 @@ public:
      **/
     virtual void open();
 
-    /** \brief Implements gen_block_stream_i::close()
+    /** \brief Implements gen_block_stream_i::close(). Sums up the
+            contributions of all blocks
      **/
     virtual void close();
 
@@ -73,7 +81,7 @@ public:
         rd_block_type &blk,
         const tensor_transf<N, element_type> &tr);
 
-    /** \brief Returns the accumulated dot product
+    /** \brief Returns the accumulated dot product (valid after close())
      **/
     const element_type &get_d() const {
         return m_d;
@@ -2,6 +2,9 @@
 #define LIBTENSOR_GEN_BTO_AUX_SYMMETRIZE_H
 
 #include <list>
+#include <map>
+#include <vector>
+#include <libutil/threads/mutex.h>
 #include <libtensor/core/orbit_list.h>
 #include "gen_block_stream_i.h"
 
@@ -21,7 +24,14 @@ namespace libtensor {
     contributions into one target block, the output stream must process
     blocks under addition.
 
-    \sa gen_block_stream_i, gen_bto_aux_add
+    When reproducible_reductions is enabled at open(), the transformed
+    contributions are not relayed immediately. Instead, each input block is
+    copied and the contributions are relayed upon close(), grouped by target
+    block and ordered by the index of the input block, so each target block
+    is accumulated in the same order regardless of how tasks are scheduled.
+    Blocks with the same index must then not be put concurrently.
+
+    \sa gen_block_stream_i, gen_bto_aux_add, reproducible_reductions
 
     \ingroup libtensor_gen_bto
  **/
@@ -51,12 +61,42 @@ public:
     //! Type of tensor transformation
     typedef tensor_transf<N, element_type> tensor_transf_type;
 
+    //! Type of temporary block
+    typedef typename Traits::template temp_block_type<N>::type
+        temp_block_type;
+
+private:
+    /** \brief Buffered contribution to a target block
+     **/
+    struct contribution {
+        size_t aidxa; //!< Absolute index of input block
+        size_t n; //!< Number of input block among those with the same index
+        tensor_transf_type tr; //!< Transformation of input block
+
+        contribution(size_t aidxa_, size_t n_, const tensor_transf_type &tr_) :
+            aidxa(aidxa_), n(n_), tr(tr_) { }
+
+        bool operator<(const contribution &other) const {
+            return aidxa < other.aidxa ||
+                (aidxa == other.aidxa && n < other.n);
+        }
+    };
+
+    typedef std::map< size_t, std::vector<temp_block_type*> > block_map_type;
+    typedef std::map< size_t, std::vector<contribution> > contrib_map_type;
+
+    class relay_blocks; //!< Relays buffered contributions in parallel
+
 private:
     symmetry_type m_syma; //!< Initial symmetry
     symmetry_type m_symb; //!< Target (symmetrized) symmetry
     std::list<tensor_transf_type> m_trlst; //!< List of transformations
     gen_block_stream_i<N, bti_traits> &m_out; //!< Output stream
     bool m_open; //!< Open state
+    bool m_repro; //!< Buffer contributions (reproducible mode)
+    libutil::mutex m_mtx; //!< Protects buffers
+    block_map_type m_blks; //!< Copies of input blocks
+    contrib_map_type m_contrib; //!< Buffered contributions by target block
 
 public:
     /** \brief Constructs the operation
@@ -94,6 +134,15 @@ public:
         rd_block_type &blk,
         const tensor_transf_type &tr);
 
+private:
+    /** \brief Relays all buffered contributions to the output stream
+     **/
+    void relay();
+
+    /** \brief Deletes the copies of input blocks
+     **/
+    void clear_buffers();
+
 };
 
 
@@ -149,6 +149,9 @@ public:
      **/
     void tostr(std::string &s);
 
+private:
+    class compare_data_blocks; //!< Compares canonical blocks in parallel
+
 private:
     /** \brief Checks that two orbits have the same canonical %index
      **/
@@ -162,11 +165,12 @@ private:
         orbit<N, element_type> &o1, transf_list<N, element_type> &trl1,
         orbit<N, element_type> &o2, transf_list<N, element_type> &trl2);
 
-    /** \brief Compares two canonical blocks identified by an %index
+    /** \brief Compares two canonical blocks identified by an %index,
+            records the difference in d (thread-safe)
      **/
     bool compare_data(const abs_index<N> &aidx,
         gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl1,
-        gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl2);
+        gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl2, diff &d);
 };
 
 
@@ -4,10 +4,10 @@
 #include <libtensor/timings.h>
 #include <libtensor/core/contraction2.h>
 #include <libtensor/core/noncopyable.h>
-#include "impl/gen_bto_contract2_sym.h"
 #include "assignment_schedule.h"
 #include "gen_block_stream_i.h"
 #include "gen_block_tensor_i.h"
+#include "gen_bto_contract2_plan.h"
 
 namespace libtensor {
 
@@ -32,6 +32,11 @@ namespace libtensor {
       A=\sum_i A_i \mbox{ and } B=\sum_i B_i
     \f]
 
+    All the steps up to the computation of the batches depend only on
+    the block structure of the arguments. They are kept in a plan
+    (\sa gen_bto_contract2_plan), which can be given to the operation to
+    reuse them in repeated contractions of the same structure.
+
     TODO: Improve the way the batches are determined.
 
     The traits class has to provide definitions for
@@ -44,6 +49,8 @@ namespace libtensor {
             operation to_contract2
     - \c template to_contract2_type<N, M, K>::clst_optimize_type -- Type of
             contraction pair list optimizer (\sa gen_bto_contract2_clst_builder)
+    - \c template to_contract2_type<N, M, K>::batch_type -- Type of tensor
+            operation to_contract2_batch
 
     \ingroup libtensor_gen_bto
  **/
@@ -82,8 +89,8 @@ private:
     gen_block_tensor_rd_i<NB, bti_traits> &m_btb; //!< Second argument (B)
     scalar_transf<element_type> m_kb; //!< Scalar transform of B.
     scalar_transf<element_type> m_kc; //!< Scalar transform of the result.
-    gen_bto_contract2_sym<N, M, K, Traits> m_symc; //!< Symmetry of the result
-    assignment_schedule<NC, element_type> m_sch; //!< Assignment schedule
+    gen_bto_contract2_plan<N, M, K, Traits> m_own_plan; //!< Plan if none given
+    gen_bto_contract2_plan<N, M, K, Traits> &m_plan; //!< Plan
 
 public:
     /** \brief Initializes the contraction operation
@@ -102,25 +109,51 @@ public:
         const scalar_transf<element_type> &kb,
         const scalar_transf<element_type> &kc);
 
+    /** \brief Initializes the contraction operation using a plan prepared
+            by an earlier operation (rebuilt if not valid)
+        \param contr Contraction.
+        \param bta Block %tensor A (first argument).
+        \param ka Scalar transform of A.
+        \param btb Block %tensor B (second argument).
+        \param kb Scalar transform of B.
+        \param kc Scalar transform of the result (C).
+        \param plan Plan of the contraction.
+    **/
+    gen_bto_contract2(
+        const contraction2<N, M, K> &contr,
+        gen_block_tensor_rd_i<NA, bti_traits> &bta,
+        const scalar_transf<element_type> &ka,
+        gen_block_tensor_rd_i<NB, bti_traits> &btb,
+        const scalar_transf<element_type> &kb,
+        const scalar_transf<element_type> &kc,
+        gen_bto_contract2_plan<N, M, K, Traits> &plan);
+
     /** \brief Returns the block index space of the result
      **/
     const block_index_space<NC> &get_bis() const {
 
-        return m_symc.get_bis();
+        return m_plan.get_symc().get_bis();
     }
 
     /** \brief Returns the symmetry of the result
      **/
     const symmetry<N + M, element_type> &get_symmetry() const {
 
-        return m_symc.get_symmetry();
+        return m_plan.get_symc().get_symmetry();
     }
 
     /** \brief Returns the list of canonical non-zero blocks of the result
      **/
     const assignment_schedule<N + M, element_type> &get_schedule() const {
 
-        return m_sch;
+        return m_plan.get_schedule();
+    }
+
+    /** \brief Returns the plan of the contraction
+     **/
+    gen_bto_contract2_plan<N, M, K, Traits> &get_plan() {
+
+        return m_plan;
     }
 
     /** \brief Computes the contraction into an output stream
@@ -144,6 +177,7 @@ public:
 
 private:
     void make_schedule();
+    void make_batches();
 };
 
 
@@ -0,0 +1,230 @@
+#ifndef LIBTENSOR_GEN_BTO_CONTRACT2_PLAN_H
+#define LIBTENSOR_GEN_BTO_CONTRACT2_PLAN_H
+
+#include <list>
+#include <vector>
+#include <libtensor/core/contraction2.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/permutation.h>
+#include "impl/gen_bto_contract2_clst_cache.h"
+#include "impl/gen_bto_contract2_sym.h"
+#include "addition_schedule.h"
+#include "assignment_schedule.h"
+#include "gen_block_tensor_i.h"
+
+namespace libtensor {
+
+
+/** \brief Structural part of the contraction of two general block tensors,
+        prepared once and reused
+    \tparam N Order of first tensor less degree of contraction.
+    \tparam M Order of second tensor less degree of contraction.
+    \tparam K Order of contraction.
+    \tparam Traits Traits class.
+
+    Before any numbers are computed, gen_bto_contract2 works out the symmetry
+    of the result, the list of its non-zero canonical blocks, the batches of
+    blocks of the arguments and the result, and the lists of block
+    contractions in every batch. None of this depends on the values of
+    the tensor elements, only on the block structure (symmetry and non-zero
+    blocks) of the arguments.
+
+    A plan given to the operation keeps these results. The next operation
+    using the same plan checks the structure versions of the arguments
+    (\sa gen_block_tensor_rd_i::on_req_structure_version) and the contraction
+    and, if they are unchanged, only runs the numerical part. Otherwise the
+    plan is rebuilt. Arguments whose structure is not tracked (version zero,
+    like direct block tensors) always cause a rebuild. The same holds for
+    the addition schedule used to add the result to an existing tensor.
+
+    \code
+    gen_bto_contract2_plan<2, 2, 2, Traits> plan;
+    while(!converged) {
+        // ...
+        gen_bto_contract2<2, 2, 2, Traits, Timed>(contr, t2, ka, ints, kb, kc,
+            plan).perform(out);
+    }
+    \endcode
+
+    The lists of block contractions can be large. They are kept unless
+    the plan is created with keep_clst set to false. A plan must not be
+    shared by operations running at the same time.
+
+    \sa gen_bto_contract2
+
+    \ingroup libtensor_gen_bto
+ **/
+template<size_t N, size_t M, size_t K, typename Traits>
+class gen_bto_contract2_plan : public noncopyable {
+public:
+    enum {
+        NA = N + K, //!< Order of first argument (A)
+        NB = M + K, //!< Order of second argument (B)
+        NC = N + M //!< Order of result (C)
+    };
+
+public:
+    //! Type of tensor elements
+    typedef typename Traits::element_type element_type;
+
+    //! Block tensor interface traits
+    typedef typename Traits::bti_traits bti_traits;
+
+    //! Type of list of batches
+    typedef std::list< std::vector<size_t> > batch_list_type;
+
+    //! Type of cache of block contraction lists
+    typedef gen_bto_contract2_clst_cache<N, M, K, Traits> clst_cache_type;
+
+    /** \brief Batches of blocks of the arguments and the result
+     **/
+    struct batches {
+        size_t nblka; //!< Number of non-zero canonical blocks in A
+        size_t nblkb; //!< Number of non-zero canonical blocks in B
+        permutation<NA> perma; //!< Permutation of A for the contraction
+        permutation<NB> permb; //!< Permutation of B for the contraction
+        permutation<NC> permc; //!< Permutation of C for the contraction
+        batch_list_type batchesa; //!< Batches of permuted A
+        batch_list_type fbatchesa; //!< Batches of A
+        batch_list_type batchesb; //!< Batches of permuted B
+        batch_list_type fbatchesb; //!< Batches of B
+        batch_list_type batchesc; //!< Batches of permuted C
+
+        batches() : nblka(0), nblkb(0) { }
+    };
+
+private:
+    bool m_keep_clst; //!< Whether to keep block contraction lists
+    contraction2<N, M, K> m_contr; //!< Contraction
+    size_t m_vera; //!< Structure version of A
+    size_t m_verb; //!< Structure version of B
+    size_t m_verc; //!< Structure version of C for the addition schedule
+    gen_bto_contract2_sym<N, M, K, Traits> *m_symc; //!< Symmetry of C
+    assignment_schedule<NC, element_type> *m_sch; //!< Non-zero blocks of C
+    addition_schedule<NC, Traits> *m_asch; //!< Addition schedule
+    batches *m_batches; //!< Batches
+    std::vector<clst_cache_type*> m_clst; //!< Block contraction lists
+    size_t m_nbuild; //!< Number of times the plan was built
+    size_t m_nreuse; //!< Number of times the plan was reused
+
+public:
+    /** \brief Initializes an empty plan
+        \param keep_clst Whether to keep the lists of block contractions.
+     **/
+    gen_bto_contract2_plan(bool keep_clst = true) :
+        m_keep_clst(keep_clst), m_vera(0), m_verb(0), m_verc(0), m_symc(0),
+        m_sch(0), m_asch(0), m_batches(0), m_nbuild(0), m_nreuse(0)
+    { }
+
+    /** \brief Destroys the plan
+     **/
+    ~gen_bto_contract2_plan() {
+        clear();
+    }
+
+    /** \brief Discards the plan, the next operation will rebuild it
+     **/
+    void invalidate() {
+        clear();
+    }
+
+    /** \brief Returns the number of times the plan was built
+     **/
+    size_t get_nbuild() const {
+        return m_nbuild;
+    }
+
+    /** \brief Returns the number of times the plan was reused
+     **/
+    size_t get_nreuse() const {
+        return m_nreuse;
+    }
+
+    //! \name Interface for gen_bto_contract2
+    //@{
+
+    /** \brief Makes the plan ready for a contraction, rebuilds the symmetry
+            of the result unless the plan is valid for the arguments
+        \param contr Contraction.
+        \param bta First argument (A).
+        \param btb Second argument (B).
+        \return True if the plan was rebuilt and the schedule of the result
+            needs to be filled in.
+     **/
+    bool prepare(
+        const contraction2<N, M, K> &contr,
+        gen_block_tensor_rd_i<NA, bti_traits> &bta,
+        gen_block_tensor_rd_i<NB, bti_traits> &btb);
+
+    /** \brief Returns true if the structure of the arguments has not changed
+            since the plan was built
+     **/
+    bool is_current(
+        gen_block_tensor_rd_i<NA, bti_traits> &bta,
+        gen_block_tensor_rd_i<NB, bti_traits> &btb);
+
+    /** \brief Returns the symmetry of the result
+     **/
+    const gen_bto_contract2_sym<N, M, K, Traits> &get_symc() const {
+        return *m_symc;
+    }
+
+    /** \brief Returns the list of non-zero canonical blocks of the result
+     **/
+    assignment_schedule<NC, element_type> &get_schedule() {
+        return *m_sch;
+    }
+
+    /** \brief Returns the list of non-zero canonical blocks of the result
+     **/
+    const assignment_schedule<NC, element_type> &get_schedule() const {
+        return *m_sch;
+    }
+
+    /** \brief Returns the batches or null if they need to be built
+     **/
+    batches *get_batches() {
+        return m_batches;
+    }
+
+    /** \brief Creates an empty set of batches, discarding the old ones
+     **/
+    batches &make_batches();
+
+    /** \brief Returns the cache of block contraction lists of a batch or
+            null if the lists are not kept
+        \param iba Number of batch of A.
+        \param ibb Number of batch of B.
+        \param ibc Number of batch of C.
+     **/
+    clst_cache_type *get_clst_cache(size_t iba, size_t ibb, size_t ibc);
+
+    /** \brief Returns the schedule for adding the result to a tensor
+        \param btc Result tensor (C).
+     **/
+    const addition_schedule<N + M, Traits> &req_addition_schedule(
+        gen_block_tensor_rd_i<NC, bti_traits> &btc);
+
+    //@}
+
+private:
+    void clear() {
+        clear_batches();
+        delete m_asch; m_asch = 0;
+        delete m_sch; m_sch = 0;
+        delete m_symc; m_symc = 0;
+        m_vera = m_verb = m_verc = 0;
+    }
+
+    void clear_batches() {
+        for(size_t i = 0; i < m_clst.size(); i++) delete m_clst[i];
+        m_clst.clear();
+        delete m_batches; m_batches = 0;
+    }
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_GEN_BTO_CONTRACT2_PLAN_H
@@ -33,6 +33,8 @@ namespace libtensor {
             operation to_contract2
     - \c template to_contract2_type<N, M, K>::clst_optimize_type -- Type of
             contraction pair list optimizer (\sa gen_bto_contract2_clst_builder)
+    - \c template to_contract2_type<N, M, K>::batch_type -- Type of tensor
+            operation to_contract2_batch
 
     \sa gen_bto_contract2
 
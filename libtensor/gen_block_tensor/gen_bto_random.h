@@ -16,6 +16,10 @@ namespace libtensor {
     Fills a block %tensor with random data without affecting its
     symmetry.
 
+    Each call takes a new stream of counter_rng and the random numbers of
+    every block come from the substream given by the absolute block index.
+    The result is therefore the same for any number of threads.
+
     <b>Traits</b>
 
     The traits class has to provide definitions for
@@ -24,7 +28,9 @@ namespace libtensor {
     - \c template temp_block_type<N>::type -- Type of temporary tensor block
     - \c template to_add_type<N>::type -- Type of tensor operation to_copy
     - \c template to_copy_type<N>::type -- Type of tensor operation to_add
-    - \c template to_random_type<N>::type -- Type of tensor operation to_random
+    - \c template to_random_type<N>::type -- Type of tensor operation
+            to_random, constructible from the scalar transformation,
+            the stream and the substream of random numbers
 
     \ingroup libtensor_gen_bto
  **/
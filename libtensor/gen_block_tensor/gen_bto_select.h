@@ -56,6 +56,10 @@ class gen_bto_select : public noncopyable {
 public:
     static const char *k_clazz; //!< Class name
 
+    enum {
+        k_max_chunks = 64 //!< Max number of chunks of orbits (parallel tasks)
+    };
+
 public:
     //! Type of tensor elements
     typedef typename Traits::element_type element_type;
@@ -118,6 +122,9 @@ public:
     void perform(list_type &li, size_t n);
 
 
+private:
+    class select_blocks; //!< Selects elements from blocks in parallel
+
 private:
     /** \brief Minimizes the list of tensor elements according to the list of
      		block transformations
@@ -132,6 +139,11 @@ private:
     void merge_lists(list_type &to, const index<N> &bidx,
             const to_list_type &from, size_t n);
 
+    /** \brief Merges two ordered lists of block tensor elements, keeps at
+            most n elements
+     **/
+    void merge_lists(list_type &to, const list_type &from, size_t n);
+
 };
 
 
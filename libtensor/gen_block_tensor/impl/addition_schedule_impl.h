@@ -10,6 +10,7 @@
 #include <libtensor/core/abs_index.h>
 #include <libtensor/core/block_index_space_product_builder.h>
 #include <libtensor/core/combined_orbits.h>
+#include <libtensor/core/compiled_symmetry.h>
 #include <libtensor/core/orbit.h>
 #include <libtensor/core/short_orbit.h>
 #include <libtensor/core/subgroup_orbits.h>
@@ -77,6 +78,8 @@ private:
     std::vector<size_t> m_nzorb;
     const symmetry<N, element_type> &m_syma;
     const symmetry<N, element_type> &m_symb;
+    const compiled_symmetry<N, element_type> &m_csyma;
+    const compiled_symmetry<N, element_type> &m_csymb;
     std::map<size_t, book_node> &m_booka;
     libutil::spinlock &m_lock;
 
@@ -84,9 +87,12 @@ public:
     addition_schedule_task_1(
         std::vector<size_t> &nzorb, const symmetry<N, element_type> &syma,
         const symmetry<N, element_type> &symb,
+        const compiled_symmetry<N, element_type> &csyma,
+        const compiled_symmetry<N, element_type> &csymb,
         std::map<size_t, book_node> &booka, libutil::spinlock &lock) :
 
-        m_syma(syma), m_symb(symb), m_booka(booka), m_lock(lock) {
+        m_syma(syma), m_symb(symb), m_csyma(csyma), m_csymb(csymb),
+        m_booka(booka), m_lock(lock) {
 
         std::swap(nzorb, m_nzorb);
     }
@@ -97,6 +103,11 @@ public:
 
     virtual void perform() {
 
+        if(m_csyma.is_tabulated() && m_csymb.is_tabulated()) {
+            perform_tabulated();
+            return;
+        }
+
         std::map<size_t, book_node> booka;
 
         for(size_t i = 0; i < m_nzorb.size(); i++) {
@@ -121,6 +132,34 @@ public:
         }
     }
 
+private:
+    void perform_tabulated() {
+
+        std::map<size_t, book_node> booka;
+        std::vector<size_t> orb;
+
+        //  Orbits of the subgroup are represented by their canonical blocks
+        for(size_t i = 0; i < m_nzorb.size(); i++) {
+            size_t acia = m_nzorb[i];
+            m_csyma.get_orbit(acia, orb);
+            for(size_t j = 0; j < orb.size(); j++) {
+
+                size_t acic = orb[j];
+                if(!m_csymb.is_canonical(acic)) continue;
+                book_node n;
+                n.cidx = acia;
+                n.tr = m_csyma.get_transf(acic);
+                n.visited = false;
+                booka[acic] = n;
+            }
+        }
+
+        {
+            libutil::auto_lock<libutil::spinlock> lock(m_lock);
+            m_booka.insert(booka.begin(), booka.end());
+        }
+    }
+
 };
 
 
@@ -136,6 +175,8 @@ private:
     Iterator m_iend;
     const symmetry<N, element_type> &m_syma;
     const symmetry<N, element_type> &m_symb;
+    const compiled_symmetry<N, element_type> &m_csyma;
+    const compiled_symmetry<N, element_type> &m_csymb;
     std::map<size_t, book_node> &m_booka;
     libutil::spinlock m_lock;
 
@@ -144,10 +185,12 @@ public:
         const Iterator &ibegin, const Iterator &iend,
         const symmetry<N, element_type> &syma,
         const symmetry<N, element_type> &symb,
+        const compiled_symmetry<N, element_type> &csyma,
+        const compiled_symmetry<N, element_type> &csymb,
         std::map<size_t, book_node> &booka) :
 
         m_ibegin(ibegin), m_iend(iend), m_syma(syma), m_symb(symb),
-        m_booka(booka) {
+        m_csyma(csyma), m_csymb(csymb), m_booka(booka) {
 
     }
 
@@ -170,7 +213,7 @@ public:
         }
 
         return new addition_schedule_task_1<N, Traits>(nzorb, m_syma, m_symb,
-            m_booka, m_lock);
+            m_csyma, m_csymb, m_booka, m_lock);
     }
 
 };
@@ -382,10 +425,13 @@ void addition_schedule<N, Traits>::build(
 
         std::map<size_t, book_node> booka, bookb;
 
+        compiled_symmetry<N, element_type> csyma(m_syma), csymb(m_symb),
+            csymc(m_symc);
+
         {
             typedef typename assignment_schedule_type::iterator iterator_type;
             addition_schedule_task_iterator_1<N, Traits, iterator_type> ti(
-                asch.begin(), asch.end(), m_syma, m_symc, booka);
+                asch.begin(), asch.end(), m_syma, m_symc, csyma, csymc, booka);
             addition_schedule_task_observer<N, Traits> to;
             libutil::thread_pool::submit(ti, to);
         }
@@ -393,7 +439,8 @@ void addition_schedule<N, Traits>::build(
         {
             typedef typename std::vector<size_t>::const_iterator iterator_type;
             addition_schedule_task_iterator_1<N, Traits, iterator_type> ti(
-                nzlstb.begin(), nzlstb.end(), m_symb, m_symc, bookb);
+                nzlstb.begin(), nzlstb.end(), m_symb, m_symc, csymb, csymc,
+                bookb);
             addition_schedule_task_observer<N, Traits> to;
             libutil::thread_pool::submit(ti, to);
         }
@@ -15,6 +15,11 @@ template<size_t N, typename BtTraits>
 block_map<N, BtTraits>::~block_map() {
 
     do_clear();
+
+    std::vector<size_t> keys;
+    std::vector<block_node*> nodes;
+    m_retired.get_all(keys, &nodes);
+    for(size_t i = 0; i < nodes.size(); i++) delete nodes[i];
 }
 
 
@@ -28,15 +33,29 @@ void block_map<N, BtTraits>::create(const index<N> &idx) {
             "this");
     }
 
-    block_type *ptr = m_bf.create_block(idx);
     size_t aidx = abs_index<N>::get_abs_index(idx, m_bidims);
-    typename map_type::iterator i = m_map.find(aidx);
-    if(i == m_map.end()) {
-        m_map.insert(std::make_pair(aidx, ptr));
-    } else {
-        m_bf.destroy_block(i->second);
-        i->second = ptr;
+    block_type *blk = m_bf.create_block(idx);
+
+    //  Reuse the node of the same block if the block existed before,
+    //  so concurrent lookups of this index never see a foreign node
+
+    block_node *node = m_map.find(aidx);
+    if(node != 0) {
+        block_type *old = node->blk.exchange(blk);
+        node->version.store(++m_version);
+        m_bf.destroy_block(old);
+        m_dirty_cache = true;
+        return;
+    }
+
+    node = m_retired.erase(aidx);
+    if(node == 0) {
+        node = new block_node;
+        node->mdversion.store(0);
     }
+    node->blk.store(blk);
+    node->version.store(++m_version);
+    m_map.insert(aidx, node);
     m_dirty_cache = true;
 }
 
@@ -52,11 +71,8 @@ void block_map<N, BtTraits>::remove(const index<N> &idx) {
     }
 
     size_t aidx = abs_index<N>::get_abs_index(idx, m_bidims);
-    typename map_type::iterator i = m_map.find(aidx);
-    if(i != m_map.end()) {
-        m_bf.destroy_block(i->second);
-        m_map.erase(i);
-    }
+    block_node *node = m_map.erase(aidx);
+    if(node != 0) retire(aidx, node);
     m_dirty_cache = true;
 }
 
@@ -65,7 +81,7 @@ template<size_t N, typename BtTraits>
 bool block_map<N, BtTraits>::contains(const index<N> &idx) const {
 
     size_t aidx = abs_index<N>::get_abs_index(idx, m_bidims);
-    return m_map.find(aidx) != m_map.end();
+    return m_map.find(aidx) != 0;
 }
 
 
@@ -73,31 +89,30 @@ template<size_t N, typename BtTraits>
 void block_map<N, BtTraits>::get_all(std::vector<size_t> &blst) const {
 
     if(m_dirty_cache) {
-        m_cached_blst.clear();
-        m_cached_blst.reserve(m_map.size());
-        for(typename map_type::const_iterator i = m_map.begin();
-            i != m_map.end(); ++i) {
-            m_cached_blst.push_back(i->first);
-        }
+        m_map.get_all(m_cached_blst);
+        m_dirty_cache = false;
     }
     blst = m_cached_blst;
 }
 
 
+template<size_t N, typename BtTraits>
+typename block_map<N, BtTraits>::block_type*
+block_map<N, BtTraits>::find(const index<N> &idx) const {
+
+    size_t aidx = abs_index<N>::get_abs_index(idx, m_bidims);
+    block_node *node = m_map.find(aidx);
+    return node == 0 ? 0 : node->blk.load();
+}
+
+
 template<size_t N, typename BtTraits>
 typename block_map<N, BtTraits>::block_type&
 block_map<N, BtTraits>::get(const index<N> &idx) {
 
     static const char *method = "get(const index<N>&)";
 
-    size_t aidx = abs_index<N>::get_abs_index(idx, m_bidims);
-    typename map_type::iterator i = m_map.find(aidx);
-    if(i == m_map.end()) {
-        throw block_not_found(g_ns, k_clazz, method, __FILE__, __LINE__,
-            "Requested block cannot be located.");
-    }
-
-    return *(i->second);
+    return *get_node(idx, method)->blk.load();
 }
 
 
@@ -115,27 +130,120 @@ void block_map<N, BtTraits>::clear() {
 }
 
 
+template<size_t N, typename BtTraits>
+bool block_map<N, BtTraits>::get_metadata(const index<N> &idx,
+    metadata_type &md, size_t &version) const {
+
+    static const char *method =
+        "get_metadata(const index<N>&, metadata_type&, size_t&)";
+
+    block_node *node = get_node(idx, method);
+    version = node->version.load(std::memory_order_acquire);
+
+    //  Sequence lock read: the metadata are consistent if the version of
+    //  the cached metadata is the same before and after reading them
+    size_t mdv = node->mdversion.load(std::memory_order_acquire);
+    if(mdv != version) return false;
+    element_type norm = node->mdnorm.load(std::memory_order_relaxed);
+    element_type maxabs = node->mdmaxabs.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(node->mdversion.load(std::memory_order_relaxed) != mdv) return false;
+
+    md = metadata_type(norm, maxabs);
+    return true;
+}
+
+
+template<size_t N, typename BtTraits>
+void block_map<N, BtTraits>::set_metadata(const index<N> &idx,
+    const metadata_type &md, size_t version) {
+
+    size_t aidx = abs_index<N>::get_abs_index(idx, m_bidims);
+    block_node *node = m_map.find(aidx);
+    if(node == 0 || node->version.load() != version) return;
+
+    //  Sequence lock write: mark the cached metadata busy, update them,
+    //  then publish the version. Concurrent writers give up
+    size_t mdv = node->mdversion.load();
+    if(mdv == k_busy || !node->mdversion.compare_exchange_strong(mdv, k_busy)) {
+        return;
+    }
+    node->mdnorm.store(md.norm, std::memory_order_relaxed);
+    node->mdmaxabs.store(md.maxabs, std::memory_order_relaxed);
+    node->mdversion.store(version, std::memory_order_release);
+}
+
+
+template<size_t N, typename BtTraits>
+void block_map<N, BtTraits>::invalidate_metadata(const index<N> &idx) {
+
+    size_t aidx = abs_index<N>::get_abs_index(idx, m_bidims);
+    block_node *node = m_map.find(aidx);
+    if(node != 0) node->version.store(++m_version);
+}
+
+
+template<size_t N, typename BtTraits>
+typename block_map<N, BtTraits>::metadata_type
+block_map<N, BtTraits>::compute_metadata(rd_block_type &blk) {
+
+    typedef typename BtTraits::template block_norm_type<N>::type norm_type;
+
+    element_type norm, maxabs;
+    norm_type().perform(blk, norm, maxabs);
+    return metadata_type(norm, maxabs);
+}
+
+
 template<size_t N, typename BtTraits>
 void block_map<N, BtTraits>::on_set_immutable() {
 
-    for(typename map_type::iterator i = m_map.begin(); i != m_map.end(); ++i) {
-        i->second->set_immutable();
+    std::vector<size_t> keys;
+    std::vector<block_node*> nodes;
+    m_map.get_all(keys, &nodes);
+    for(size_t i = 0; i < nodes.size(); i++) {
+        nodes[i]->blk.load()->set_immutable();
     }
 }
 
 
 template<size_t N, typename BtTraits>
-void block_map<N, BtTraits>::do_clear() {
+typename block_map<N, BtTraits>::block_node*
+block_map<N, BtTraits>::get_node(const index<N> &idx,
+    const char *method) const {
 
-    for(typename map_type::iterator i = m_map.begin(); i != m_map.end(); ++i) {
-        m_bf.destroy_block(i->second);
-        i->second = 0;
+    size_t aidx = abs_index<N>::get_abs_index(idx, m_bidims);
+    block_node *node = m_map.find(aidx);
+    if(node == 0) {
+        throw block_not_found(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "Requested block cannot be located.");
     }
+    return node;
+}
+
+
+template<size_t N, typename BtTraits>
+void block_map<N, BtTraits>::do_clear() {
+
+    std::vector<size_t> keys;
+    std::vector<block_node*> nodes;
+    m_map.get_all(keys, &nodes);
     m_map.clear();
+    for(size_t i = 0; i < nodes.size(); i++) retire(keys[i], nodes[i]);
     m_dirty_cache = true;
 }
 
 
+template<size_t N, typename BtTraits>
+void block_map<N, BtTraits>::retire(size_t aidx, block_node *node) {
+
+    block_type *blk = node->blk.exchange(0);
+    node->version.store(++m_version);
+    m_bf.destroy_block(blk);
+    m_retired.insert(aidx, node);
+}
+
+
 } // namespace libtensor
 
 #endif // LIBTENSOR_BLOCK_MAP_IMPL_H
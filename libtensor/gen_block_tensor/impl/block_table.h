@@ -0,0 +1,280 @@
+#ifndef LIBTENSOR_BLOCK_TABLE_H
+#define LIBTENSOR_BLOCK_TABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <libutil/threads/auto_lock.h>
+#include <libutil/threads/mutex.h>
+#include <libtensor/core/noncopyable.h>
+
+namespace libtensor {
+
+
+/** \brief Concurrent table of pointers keyed by absolute block index
+    \tparam T Type of stored objects.
+
+    The table maps absolute block indexes to pointers. If the total number of
+    blocks in the block grid does not exceed k_max_dense, the table is a dense
+    array of pointers indexed directly by the absolute index. Otherwise it is
+    an open addressing hash table with linear probing. The storage is only
+    allocated with the first insertion, so empty tables (such as temporary
+    block tensors that are never written) cost nothing.
+
+    Lookups (find()) are lock-free and can proceed concurrently with each other
+    and with insertions and removals. Insertions and removals are serialized by
+    an internal mutex. When the hash table grows, the old storage is retired,
+    but not released until the table is destroyed, so concurrent lookups never
+    touch freed memory. Removal leaves the key in place (tombstone), tombstones
+    are dropped on the next rehash.
+
+    The table does not own the objects.
+
+    \ingroup libtensor_gen_block_tensor
+ **/
+template<typename T>
+class block_table : public noncopyable {
+public:
+    enum {
+        k_max_dense = 4096, //!< Largest block grid stored as dense array
+        k_initial_cap = 1024 //!< Initial capacity of hash tables
+    };
+
+private:
+    struct storage {
+        size_t cap; //!< Capacity (power of two for hash tables)
+        std::atomic<size_t> *keys; //!< Keys (null for dense arrays)
+        std::atomic<T*> *vals; //!< Values
+
+        storage(size_t cap_, bool dense) : cap(cap_), keys(0), vals(0) {
+            vals = new std::atomic<T*>[cap];
+            for(size_t i = 0; i < cap; i++) vals[i].store(0);
+            if(!dense) {
+                keys = new std::atomic<size_t>[cap];
+                for(size_t i = 0; i < cap; i++) keys[i].store(k_empty);
+            }
+        }
+
+        ~storage() {
+            delete [] keys;
+            delete [] vals;
+        }
+    };
+
+    static const size_t k_empty = size_t(-1); //!< Marker of empty slots
+
+private:
+    size_t m_nkeys; //!< Total number of keys
+    bool m_dense; //!< Whether the table is a dense array
+    std::atomic<storage*> m_st; //!< Current storage (null until first insert)
+    std::vector<storage*> m_retired; //!< Retired storage
+    size_t m_nused; //!< Number of used slots (including tombstones)
+    size_t m_nlive; //!< Number of stored objects
+    libutil::mutex m_lock; //!< Insertion lock
+
+public:
+    /** \brief Creates an empty table
+        \param nkeys Total number of keys (size of the block grid).
+     **/
+    block_table(size_t nkeys) :
+        m_nkeys(nkeys), m_dense(nkeys <= k_max_dense), m_st(0), m_nused(0),
+        m_nlive(0) {
+
+    }
+
+    /** \brief Destroys the table (does not destroy the objects)
+     **/
+    ~block_table() {
+        delete m_st.load();
+        for(size_t i = 0; i < m_retired.size(); i++) delete m_retired[i];
+    }
+
+    /** \brief Returns whether the table is a dense array
+     **/
+    bool is_dense() const {
+        return m_dense;
+    }
+
+    /** \brief Returns the number of stored objects
+     **/
+    size_t get_size() const {
+        return m_nlive;
+    }
+
+    /** \brief Returns the object with the given key or null if there is none
+            (lock-free)
+        \param key Key.
+     **/
+    T *find(size_t key) const {
+
+        storage *st = m_st.load(std::memory_order_acquire);
+        if(st == 0) return 0;
+        if(m_dense) return st->vals[key].load(std::memory_order_acquire);
+
+        size_t mask = st->cap - 1;
+        for(size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+            size_t k = st->keys[i].load(std::memory_order_acquire);
+            if(k == key) return st->vals[i].load(std::memory_order_acquire);
+            if(k == k_empty) return 0;
+        }
+    }
+
+    /** \brief Stores an object with the given key
+        \param key Key.
+        \param ptr Pointer to the object (not null).
+        \return Pointer previously stored with the key or null.
+     **/
+    T *insert(size_t key, T *ptr) {
+
+        libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+        storage *st = m_st.load(std::memory_order_relaxed);
+        if(st == 0) {
+            st = new storage(m_dense ? m_nkeys : size_t(k_initial_cap),
+                m_dense);
+            m_st.store(st, std::memory_order_release);
+        }
+        if(m_dense) {
+            T *old = st->vals[key].exchange(ptr, std::memory_order_acq_rel);
+            if(old == 0) m_nlive++;
+            return old;
+        }
+
+        if(2 * (m_nused + 1) > st->cap) {
+            st = rehash(m_nlive + 1);
+        }
+
+        size_t mask = st->cap - 1;
+        for(size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+            size_t k = st->keys[i].load(std::memory_order_relaxed);
+            if(k == key) {
+                T *old = st->vals[i].exchange(ptr, std::memory_order_acq_rel);
+                if(old == 0) m_nlive++;
+                return old;
+            }
+            if(k == k_empty) {
+                //  Publish the value before the key, so readers that
+                //  see the key also see the value
+                st->vals[i].store(ptr, std::memory_order_relaxed);
+                st->keys[i].store(key, std::memory_order_release);
+                m_nused++;
+                m_nlive++;
+                return 0;
+            }
+        }
+    }
+
+    /** \brief Removes the object with the given key
+        \param key Key.
+        \return Pointer to the removed object or null if there was none.
+     **/
+    T *erase(size_t key) {
+
+        libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+        storage *st = m_st.load(std::memory_order_relaxed);
+        T *old = 0;
+        if(st == 0) {
+            return 0;
+        } else if(m_dense) {
+            old = st->vals[key].exchange(0, std::memory_order_acq_rel);
+        } else {
+            size_t mask = st->cap - 1;
+            for(size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+                size_t k = st->keys[i].load(std::memory_order_relaxed);
+                if(k == key) {
+                    old = st->vals[i].exchange(0, std::memory_order_acq_rel);
+                    break;
+                }
+                if(k == k_empty) break;
+            }
+        }
+        if(old != 0) m_nlive--;
+        return old;
+    }
+
+    /** \brief Returns the keys and objects of all stored objects in
+            ascending order of keys (requires external synchronization with
+            insert() and erase())
+        \param[out] keys Keys.
+        \param[out] ptrs Objects (optional).
+     **/
+    void get_all(std::vector<size_t> &keys,
+        std::vector<T*> *ptrs = 0) const {
+
+        storage *st = m_st.load(std::memory_order_acquire);
+        std::vector< std::pair<size_t, T*> > all;
+        all.reserve(m_nlive);
+        for(size_t i = 0; st != 0 && i < st->cap; i++) {
+            T *p = st->vals[i].load(std::memory_order_acquire);
+            if(p == 0) continue;
+            all.push_back(std::make_pair(m_dense ? i :
+                st->keys[i].load(std::memory_order_relaxed), p));
+        }
+        if(!m_dense) std::sort(all.begin(), all.end());
+
+        keys.resize(all.size());
+        if(ptrs) ptrs->resize(all.size());
+        for(size_t i = 0; i < all.size(); i++) {
+            keys[i] = all[i].first;
+            if(ptrs) (*ptrs)[i] = all[i].second;
+        }
+    }
+
+    /** \brief Removes all objects (requires external synchronization with
+            lookups)
+     **/
+    void clear() {
+
+        libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+        storage *st = m_st.load(std::memory_order_relaxed);
+        for(size_t i = 0; st != 0 && i < st->cap; i++) {
+            st->vals[i].store(0, std::memory_order_relaxed);
+            if(!m_dense) st->keys[i].store(k_empty, std::memory_order_relaxed);
+        }
+        m_nused = 0;
+        m_nlive = 0;
+    }
+
+private:
+    static size_t hash(size_t key) {
+        //  Fibonacci hashing spreads neighboring block indexes
+        return (key * size_t(11400714819323198485ULL)) >> 17;
+    }
+
+    /** \brief Moves live entries to new storage large enough for n objects
+            and publishes it (must be called with the lock held)
+     **/
+    storage *rehash(size_t n) {
+
+        storage *st = m_st.load(std::memory_order_relaxed);
+        size_t cap = st->cap;
+        while(4 * n > cap) cap <<= 1;
+
+        storage *st2 = new storage(cap, false);
+        size_t mask = cap - 1;
+        for(size_t j = 0; j < st->cap; j++) {
+            T *p = st->vals[j].load(std::memory_order_relaxed);
+            if(p == 0) continue;
+            size_t key = st->keys[j].load(std::memory_order_relaxed);
+            size_t i = hash(key) & mask;
+            while(st2->keys[i].load(std::memory_order_relaxed) != k_empty) {
+                i = (i + 1) & mask;
+            }
+            st2->vals[i].store(p, std::memory_order_relaxed);
+            st2->keys[i].store(key, std::memory_order_relaxed);
+        }
+        m_nused = m_nlive;
+
+        m_st.store(st2, std::memory_order_release);
+        m_retired.push_back(st);
+        return st2;
+    }
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BLOCK_TABLE_H
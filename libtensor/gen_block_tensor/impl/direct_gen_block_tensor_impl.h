@@ -1,6 +1,7 @@
 #ifndef LIBTENSOR_DIRECT_GEN_BLOCK_TENSOR_IMPL_H
 #define LIBTENSOR_DIRECT_GEN_BLOCK_TENSOR_IMPL_H
 
+#include <chrono>
 #include <libutil/threads/auto_lock.h>
 #include <libutil/thread_pool/thread_pool.h>
 #include <libtensor/core/abs_index.h>
@@ -75,7 +76,8 @@ const char *direct_gen_block_tensor<N, BtTraits>::k_clazz =
 template<size_t N, typename BtTraits>
 direct_gen_block_tensor<N, BtTraits>::direct_gen_block_tensor(operation_t &op) :
 
-    base_t(op), m_bidims(get_bis().get_block_index_dims()), m_map(get_bis()) {
+    base_t(op), m_bidims(get_bis().get_block_index_dims()), m_map(get_bis()),
+    m_tick(0) {
 
 }
 
@@ -124,36 +126,59 @@ direct_gen_block_tensor<N, BtTraits>::on_req_const_block(
 #endif // LIBTENSOR_DEBUG
 
     abs_index<N> aidx(idx, m_bidims);
+    size_t a = aidx.get_abs_index();
     typename std::map<size_t, size_t>::iterator icnt =
-        m_count.insert(std::make_pair(aidx.get_abs_index(), size_t(0))).first;
+        m_count.insert(std::make_pair(a, size_t(0))).first;
     bool newblock = icnt->second++ == 0;
-    bool inprogress = m_inprogress.count(aidx.get_abs_index()) > 0;
+    bool inprogress = m_inprogress.count(a) > 0;
+    bool compute = false;
 
     if(newblock) {
-        m_map.create(idx);
+        cache_entry &ce = m_cache[a];
+        if(ce.cached) {
+            m_evict.erase(evict_key(a, ce));
+            m_cstats.cached_bytes -= ce.bytes;
+            ce.cached = false;
+            m_cstats.nhits++;
+        } else {
+            m_map.create(idx);
+            m_cstats.nmisses++;
+            compute = true;
+        }
+        ce.nuse++;
+        ce.last = ++m_tick;
     }
 
     block_type &blk = m_map.get(idx);
 
-    if(newblock) {
+    if(compute) {
 
-        std::set<size_t>::iterator i =
-                m_inprogress.insert(aidx.get_abs_index()).first;
+        std::set<size_t>::iterator i = m_inprogress.insert(a).first;
         m_lock.unlock();
+        std::chrono::steady_clock::time_point t0 =
+            std::chrono::steady_clock::now();
         try {
             get_op().compute_block(idx, blk);
         } catch(...) {
             m_lock.lock();
             throw;
         }
+        double t = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - t0).count();
         m_lock.lock();
         m_inprogress.erase(i);
-        m_cond.signal(aidx.get_abs_index());
+        cache_entry &ce = m_cache[a];
+        if(ce.ncomputed++ > 0) {
+            m_cstats.nrecomputed++;
+            m_cstats.recompute_time += t;
+        }
+        m_cstats.compute_time += t;
+        m_cond.signal(a);
 
     } else if(inprogress) {
 
         libutil::loaded_cond<size_t> cond(0);
-        m_cond.insert(aidx.get_abs_index(), &cond);
+        m_cond.insert(a, &cond);
         m_lock.unlock();
         try {
             libutil::thread_pool::release_cpu();
@@ -164,7 +189,7 @@ direct_gen_block_tensor<N, BtTraits>::on_req_const_block(
             throw;
         }
         m_lock.lock();
-        m_cond.erase(aidx.get_abs_index(), &cond);
+        m_cond.erase(a, &cond);
     }
 
     return blk;
@@ -187,8 +212,148 @@ void direct_gen_block_tensor<N, BtTraits>::on_ret_const_block(
     }
 
     if(--icnt->second == 0) {
-        m_map.remove(idx);
         m_count.erase(icnt);
+        if(!cache_block(aidx.get_abs_index(), idx)) m_map.remove(idx);
+    }
+}
+
+
+template<size_t N, typename BtTraits>
+block_metadata<typename BtTraits::element_type>
+direct_gen_block_tensor<N, BtTraits>::on_req_block_metadata(
+    const index<N> &idx) {
+
+    {
+        libutil::auto_lock<libutil::mutex> lock(m_lock);
+        if(!get_op().get_schedule().contains(idx)) {
+            return block_metadata<element_type>();
+        }
+    }
+
+    //  Direct blocks are not stored, so the metadata are computed from
+    //  a freshly obtained block every time
+
+    rd_block_type &blk = on_req_const_block(idx);
+    block_metadata<element_type> md;
+    try {
+        md = block_map<N, BtTraits>::compute_metadata(blk);
+    } catch(...) {
+        on_ret_const_block(idx);
+        throw;
+    }
+    on_ret_const_block(idx);
+
+    return md;
+}
+
+
+template<size_t N, typename BtTraits>
+size_t direct_gen_block_tensor<N, BtTraits>::on_req_structure_version() {
+
+    //  Blocks are computed on demand, there is no structure to track
+    return 0;
+}
+
+
+template<size_t N, typename BtTraits>
+void direct_gen_block_tensor<N, BtTraits>::set_cache_policy(
+    const direct_block_cache_policy &p) {
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+    //  Keys depend on the mode, so the cache is emptied when it changes
+    if(p.mode != m_cpolicy.mode) evict(0);
+    m_cpolicy = p;
+    evict(p.mode == direct_block_cache_policy::NONE ? 0 : p.max_bytes);
+}
+
+
+template<size_t N, typename BtTraits>
+direct_block_cache_policy
+direct_gen_block_tensor<N, BtTraits>::get_cache_policy() {
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+    return m_cpolicy;
+}
+
+
+template<size_t N, typename BtTraits>
+void direct_gen_block_tensor<N, BtTraits>::clear_cache() {
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+    evict(0);
+}
+
+
+template<size_t N, typename BtTraits>
+direct_block_cache_stats
+direct_gen_block_tensor<N, BtTraits>::get_cache_stats() {
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+    return m_cstats;
+}
+
+
+template<size_t N, typename BtTraits>
+void direct_gen_block_tensor<N, BtTraits>::reset_cache_stats() {
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+    size_t cached_bytes = m_cstats.cached_bytes;
+    m_cstats = direct_block_cache_stats();
+    m_cstats.cached_bytes = cached_bytes;
+}
+
+
+template<size_t N, typename BtTraits>
+typename direct_gen_block_tensor<N, BtTraits>::evict_key_t
+direct_gen_block_tensor<N, BtTraits>::evict_key(size_t aidx,
+    const cache_entry &ce) const {
+
+    if(m_cpolicy.mode == direct_block_cache_policy::LFU) {
+        return evict_key_t(std::make_pair(ce.nuse, ce.last), aidx);
+    } else {
+        return evict_key_t(std::make_pair(ce.last, size_t(0)), aidx);
+    }
+}
+
+
+template<size_t N, typename BtTraits>
+bool direct_gen_block_tensor<N, BtTraits>::cache_block(size_t aidx,
+    const index<N> &idx) {
+
+    if(m_cpolicy.mode == direct_block_cache_policy::NONE) return false;
+
+    size_t bytes = get_bis().get_block_dims(idx).get_size() *
+        sizeof(element_type);
+    if(bytes > m_cpolicy.max_bytes) return false;
+
+    cache_entry &ce = m_cache[aidx];
+    ce.last = ++m_tick;
+    ce.bytes = bytes;
+    ce.cached = true;
+    m_evict.insert(evict_key(aidx, ce));
+    m_cstats.cached_bytes += bytes;
+    evict(m_cpolicy.max_bytes);
+    return true;
+}
+
+
+template<size_t N, typename BtTraits>
+void direct_gen_block_tensor<N, BtTraits>::evict(size_t max_bytes) {
+
+    while(m_cstats.cached_bytes > max_bytes && !m_evict.empty()) {
+        size_t aidx = m_evict.begin()->second;
+        m_evict.erase(m_evict.begin());
+        cache_entry &ce = m_cache[aidx];
+        ce.cached = false;
+        m_cstats.cached_bytes -= ce.bytes;
+        m_cstats.nevicted++;
+        abs_index<N> ai(aidx, m_bidims);
+        m_map.remove(ai.get_index());
     }
 }
 
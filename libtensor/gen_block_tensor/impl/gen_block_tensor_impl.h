@@ -20,7 +20,9 @@ gen_block_tensor<N, BtTraits>::gen_block_tensor(
     m_bis(bis),
     m_bidims(bis.get_block_index_dims()),
     m_symmetry(m_bis),
-    m_map(m_bis) {
+    m_map(m_bis),
+    m_sversion(block_structure_version::next()),
+    m_cpolicy(block_compression::get_policy()) {
 
 }
 
@@ -59,6 +61,9 @@ gen_block_tensor<N, BtTraits>::on_req_symmetry() {
             "symmetry");
     }
 
+    //  The symmetry is modified through the returned reference
+    m_sversion.store(block_structure_version::next());
+
     return m_symmetry;
 }
 
@@ -74,7 +79,6 @@ gen_block_tensor<N, BtTraits>::on_req_const_block(const index<N> &idx) {
 template<size_t N, typename BtTraits>
 void gen_block_tensor<N, BtTraits>::on_ret_const_block(const index<N> &idx) {
 
-    on_ret_block(idx);
 }
 
 
@@ -89,6 +93,7 @@ gen_block_tensor<N, BtTraits>::on_req_block(const index<N> &idx) {
 template<size_t N, typename BtTraits>
 void gen_block_tensor<N, BtTraits>::on_ret_block(const index<N> &idx) {
 
+    m_map.invalidate_metadata(idx);
 }
 
 
@@ -97,6 +102,10 @@ bool gen_block_tensor<N, BtTraits>::on_req_is_zero_block(const index<N> &idx) {
 
     static const char method[] = "on_req_is_zero_block(const index<N>&)";
 
+#ifndef LIBTENSOR_DEBUG
+    if(m_map.contains(idx)) return false;
+#endif // LIBTENSOR_DEBUG
+
     libutil::auto_lock<libutil::mutex> lock(m_lock);
 
     if(!check_canonical_block(idx)) {
@@ -118,6 +127,54 @@ void gen_block_tensor<N, BtTraits>::on_req_nonzero_blocks(
 }
 
 
+template<size_t N, typename BtTraits>
+block_metadata<typename BtTraits::element_type>
+gen_block_tensor<N, BtTraits>::on_req_block_metadata(const index<N> &idx) {
+
+    static const char method[] = "on_req_block_metadata(const index<N>&)";
+
+    block_metadata<element_type> md;
+    block_type *blk = 0;
+    size_t version = 0;
+
+#ifndef LIBTENSOR_DEBUG
+    //  Existing blocks are canonical, so up-to-date cached metadata can be
+    //  returned without taking the lock
+    if(m_map.contains(idx) && m_map.get_metadata(idx, md, version)) {
+        return md;
+    }
+#endif // LIBTENSOR_DEBUG
+
+    {
+        libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+        if(!check_canonical_block(idx)) {
+            throw symmetry_violation(g_ns, k_clazz, method, __FILE__,
+                __LINE__, "Index does not correspond to a canonical block.");
+        }
+
+        if(!m_map.contains(idx)) return md;
+        if(m_map.get_metadata(idx, md, version)) return md;
+        blk = &m_map.get(idx);
+    }
+
+    //  Scan the block without holding the lock. If the block is modified
+    //  in the meantime, the version changes and the result is not cached
+
+    md = block_map<N, BtTraits>::compute_metadata(*blk);
+    m_map.set_metadata(idx, md, version);
+
+    return md;
+}
+
+
+template<size_t N, typename BtTraits>
+size_t gen_block_tensor<N, BtTraits>::on_req_structure_version() {
+
+    return m_sversion.load();
+}
+
+
 template<size_t N, typename BtTraits>
 void gen_block_tensor<N, BtTraits>::on_req_zero_block(const index<N> &idx) {
 
@@ -135,7 +192,10 @@ void gen_block_tensor<N, BtTraits>::on_req_zero_block(const index<N> &idx) {
             "Index does not correspond to a canonical block.");
     }
 
-    m_map.remove(idx);
+    if(m_map.contains(idx)) {
+        m_map.remove(idx);
+        m_sversion.store(block_structure_version::next());
+    }
 }
 
 
@@ -151,6 +211,7 @@ void gen_block_tensor<N, BtTraits>::on_req_zero_all_blocks() {
             "Immutable object cannot be modified.");
     }
     m_map.clear();
+    m_sversion.store(block_structure_version::next());
 }
 
 
@@ -183,6 +244,16 @@ gen_block_tensor<N, BtTraits>::get_block(const index<N> &idx, bool create) {
 
     static const char method[] = "get_block(const index<N>&, bool)";
 
+#ifndef LIBTENSOR_DEBUG
+    //  Existing blocks are canonical, so they can be returned without
+    //  taking the lock
+    block_type *blk = m_map.find(idx);
+    if(blk != 0) {
+        if(create) m_map.invalidate_metadata(idx);
+        return *blk;
+    }
+#endif // LIBTENSOR_DEBUG
+
     libutil::auto_lock<libutil::mutex> lock(m_lock);
 
     if(!check_canonical_block(idx)) {
@@ -192,11 +263,15 @@ gen_block_tensor<N, BtTraits>::get_block(const index<N> &idx, bool create) {
 
     if(!m_map.contains(idx)) {
         if(create) {
+            block_compression::scope cscope(m_cpolicy);
             m_map.create(idx);
+            m_sversion.store(block_structure_version::next());
         } else {
             throw symmetry_violation(g_ns, k_clazz, method, __FILE__, __LINE__,
                 "Block does not exist.");
         }
+    } else if(create) {
+        m_map.invalidate_metadata(idx);
     }
     return m_map.get(idx);
 }
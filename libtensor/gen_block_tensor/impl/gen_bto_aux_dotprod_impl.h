@@ -75,6 +75,7 @@ gen_bto_aux_dotprod<N, Traits>::~gen_bto_aux_dotprod() {
 template<size_t N, typename Traits>
 void gen_bto_aux_dotprod<N, Traits>::open() {
 
+    m_parts.clear();
     m_d = Traits::zero();
 }
 
@@ -82,6 +83,11 @@ void gen_bto_aux_dotprod<N, Traits>::open() {
 template<size_t N, typename Traits>
 void gen_bto_aux_dotprod<N, Traits>::close() {
 
+    //  Fixed order of summation makes the result reproducible
+    m_d = Traits::zero();
+    for(typename std::map<size_t, element_type>::const_iterator i =
+        m_parts.begin(); i != m_parts.end(); ++i) m_d += i->second;
+    m_parts.clear();
 }
 
 
@@ -104,6 +110,8 @@ void gen_bto_aux_dotprod<N, Traits>::put(
     dimensions<N> bidimsb = m_bisb.get_block_index_dims();
     size_t aidxb = abs_index<N>::get_abs_index(idxb, bidimsb);
     subgroup_orbits<N, element_type> sgo(m_symb, m_symc, aidxb);
+    element_type dsum = Traits::zero();
+    bool nonzero = false;
     for(typename subgroup_orbits<N, element_type>::iterator i = sgo.begin();
         i != sgo.end(); ++i) {
 
@@ -133,10 +141,13 @@ void gen_bto_aux_dotprod<N, Traits>::put(
         ca.ret_const_block(oa.get_cindex());
 
         sum.apply(d);
-        {
-            libutil::auto_lock<libutil::mutex> lock(m_mtx);
-            m_d += d;
-        }
+        dsum += d;
+        nonzero = true;
+    }
+
+    if(nonzero) {
+        libutil::auto_lock<libutil::mutex> lock(m_mtx);
+        m_parts[aidxb] += dsum;
     }
 }
 
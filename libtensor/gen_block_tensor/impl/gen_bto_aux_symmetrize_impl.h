@@ -1,10 +1,14 @@
 #ifndef LIBTENSOR_GEN_BTO_AUX_SYMMETRIZE_IMPL_H
 #define LIBTENSOR_GEN_BTO_AUX_SYMMETRIZE_IMPL_H
 
+#include <algorithm>
+#include <libutil/threads/auto_lock.h>
 #include <libtensor/core/orbit.h>
+#include <libtensor/core/reproducible_reductions.h>
 #include <libtensor/symmetry/so_copy.h>
 #include "../block_stream_exception.h"
 #include "../gen_bto_aux_symmetrize.h"
+#include "gen_bto_parallel_for.h"
 
 namespace libtensor {
 
@@ -21,7 +25,7 @@ gen_bto_aux_symmetrize<N, Traits>::gen_bto_aux_symmetrize(
     gen_block_stream_i<N, bti_traits> &out) :
 
     m_syma(syma.get_bis()), m_symb(symb.get_bis()), m_out(out),
-    m_open(false) {
+    m_open(false), m_repro(false) {
 
     so_copy<N, element_type>(syma).perform(m_syma);
     so_copy<N, element_type>(symb).perform(m_symb);
@@ -31,6 +35,8 @@ gen_bto_aux_symmetrize<N, Traits>::gen_bto_aux_symmetrize(
 template<size_t N, typename Traits>
 gen_bto_aux_symmetrize<N, Traits>::~gen_bto_aux_symmetrize() {
 
+    //  Buffered contributions of a stream that was not closed are dropped
+    clear_buffers();
     if(m_open) close();
 }
 
@@ -51,6 +57,7 @@ void gen_bto_aux_symmetrize<N, Traits>::open() {
             __FILE__, __LINE__, "Stream is already open.");
     }
 
+    m_repro = reproducible_reductions::is_enabled();
     m_open = true;
 }
 
@@ -63,6 +70,16 @@ void gen_bto_aux_symmetrize<N, Traits>::close() {
             __FILE__, __LINE__, "Stream is already closed.");
     }
 
+    if(m_repro) {
+        try {
+            relay();
+        } catch(...) {
+            clear_buffers();
+            throw;
+        }
+        clear_buffers();
+    }
+
     m_trlst.clear();
     m_open = false;
 }
@@ -74,6 +91,8 @@ void gen_bto_aux_symmetrize<N, Traits>::put(
     rd_block_type &blk,
     const tensor_transf_type &tr) {
 
+    typedef typename Traits::template to_copy_type<N>::type to_copy_type;
+
     if(!m_open) {
         throw block_stream_exception(g_ns, k_clazz, "put()",
             __FILE__, __LINE__, "Stream is not ready.");
@@ -119,6 +138,9 @@ void gen_bto_aux_symmetrize<N, Traits>::put(
     typedef typename std::multimap<size_t, tensor_transf_type>::iterator
         symap_iterator;
 
+    //  Contributions to be buffered in reproducible mode
+    std::vector< std::pair<size_t, tensor_transf_type> > trlst;
+
     while(!symap.empty()) {
 
         size_t aidxb = symap.begin()->first;
@@ -145,7 +167,8 @@ void gen_bto_aux_symmetrize<N, Traits>::put(
             }
             if(!sum.is_zero()) {
                 tensor_transf<N, double> tr(perm, sum.get_transf());
-                m_out.put(idxb, blk, tr);
+                if(m_repro) trlst.push_back(std::make_pair(aidxb, tr));
+                else m_out.put(idxb, blk, tr);
             }
         }
 
@@ -155,6 +178,89 @@ void gen_bto_aux_symmetrize<N, Traits>::put(
             symap.erase(ob.get_abs_index(i));
         }
     }
+
+    if(trlst.empty()) return;
+
+    //  Keep a copy of the input block and record the contributions
+
+    temp_block_type *tblk = new temp_block_type(blk.get_dims());
+    try {
+        to_copy_type(blk).perform(true, *tblk);
+    } catch(...) {
+        delete tblk;
+        throw;
+    }
+
+    size_t aidxa = abs_index<N>::get_abs_index(idxa, bidimsa);
+
+    libutil::auto_lock<libutil::mutex> lock(m_mtx);
+
+    std::vector<temp_block_type*> &blks = m_blks[aidxa];
+    size_t n = blks.size();
+    blks.push_back(tblk);
+    for(size_t i = 0; i < trlst.size(); i++) {
+        m_contrib[trlst[i].first].push_back(
+            contribution(aidxa, n, trlst[i].second));
+    }
+}
+
+
+template<size_t N, typename Traits>
+class gen_bto_aux_symmetrize<N, Traits>::relay_blocks {
+private:
+    gen_bto_aux_symmetrize<N, Traits> &m_aux; //!< Symmetrizer
+    std::vector<typename contrib_map_type::iterator> m_targets; //!< Targets
+    dimensions<N> m_bidimsb; //!< Block index dims of target
+
+public:
+    relay_blocks(gen_bto_aux_symmetrize<N, Traits> &aux) :
+        m_aux(aux), m_bidimsb(aux.m_symb.get_bis().get_block_index_dims()) {
+
+        m_targets.reserve(m_aux.m_contrib.size());
+        for(typename contrib_map_type::iterator i = m_aux.m_contrib.begin();
+            i != m_aux.m_contrib.end(); ++i) m_targets.push_back(i);
+    }
+
+    size_t get_size() const {
+        return m_targets.size();
+    }
+
+    void perform_item(size_t i) {
+
+        index<N> idxb;
+        abs_index<N>::get_index(m_targets[i]->first, m_bidimsb, idxb);
+        std::vector<contribution> &cl = m_targets[i]->second;
+        std::sort(cl.begin(), cl.end());
+        for(size_t j = 0; j < cl.size(); j++) {
+            temp_block_type &blk =
+                *m_aux.m_blks.find(cl[j].aidxa)->second[cl[j].n];
+            m_aux.m_out.put(idxb, blk, cl[j].tr);
+        }
+    }
+
+};
+
+
+template<size_t N, typename Traits>
+void gen_bto_aux_symmetrize<N, Traits>::relay() {
+
+    //  Each target block is accumulated by one task in the order of input
+    //  blocks; different target blocks go to different blocks downstream
+
+    relay_blocks body(*this);
+    gen_bto_parallel_for(body, body.get_size());
+}
+
+
+template<size_t N, typename Traits>
+void gen_bto_aux_symmetrize<N, Traits>::clear_buffers() {
+
+    for(typename block_map_type::iterator i = m_blks.begin();
+        i != m_blks.end(); ++i) {
+        for(size_t j = 0; j < i->second.size(); j++) delete i->second[j];
+    }
+    m_blks.clear();
+    m_contrib.clear();
 }
 
 
@@ -1,9 +1,14 @@
 #ifndef LIBTENSOR_GEN_BTO_COMPARE_IMPL_H
 #define LIBTENSOR_GEN_BTO_COMPARE_IMPL_H
 
+#include <atomic>
+#include <vector>
+#include <libutil/threads/auto_lock.h>
+#include <libutil/threads/mutex.h>
 #include <libtensor/core/orbit_list.h>
 #include <libtensor/core/bad_block_index_space.h>
 #include "../gen_bto_compare.h"
+#include "gen_bto_parallel_for.h"
 
 namespace libtensor {
 
@@ -12,6 +17,58 @@ template<size_t N, typename Traits>
 const char gen_bto_compare<N, Traits>::k_clazz[] = "gen_bto_compare<N, Traits>";
 
 
+template<size_t N, typename Traits>
+class gen_bto_compare<N, Traits>::compare_data_blocks {
+private:
+    gen_bto_compare<N, Traits> &m_op;
+    gen_block_tensor_rd_ctrl<N, bti_traits> &m_ctrl1;
+    gen_block_tensor_rd_ctrl<N, bti_traits> &m_ctrl2;
+    const std::vector<size_t> &m_blst;
+    dimensions<N> m_bidims;
+    const diff &m_diff0; //!< Initial difference structure
+    std::atomic<size_t> m_first; //!< First failing item (or number of items)
+    diff m_diff; //!< Difference found in the first failing item
+    libutil::mutex m_mtx; //!< Protects m_diff
+
+public:
+    compare_data_blocks(gen_bto_compare<N, Traits> &op,
+        gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl1,
+        gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl2,
+        const std::vector<size_t> &blst, const dimensions<N> &bidims,
+        const diff &d) :
+        m_op(op), m_ctrl1(ctrl1), m_ctrl2(ctrl2), m_blst(blst),
+        m_bidims(bidims), m_diff0(d), m_first(blst.size()), m_diff(d) { }
+
+    /** \brief Returns the position of the first differing block in the
+            list or the size of the list if there are no differences
+     **/
+    size_t get_first() const {
+        return m_first.load();
+    }
+
+    const diff &get_diff() const {
+        return m_diff;
+    }
+
+    void perform_item(size_t i) {
+
+        //  Blocks past the first known difference need not be compared
+        if(i > m_first.load(std::memory_order_relaxed)) return;
+
+        diff d(m_diff0);
+        abs_index<N> ai(m_blst[i], m_bidims);
+        if(m_op.compare_data(ai, m_ctrl1, m_ctrl2, d)) return;
+
+        libutil::auto_lock<libutil::mutex> lock(m_mtx);
+        if(i < m_first.load(std::memory_order_relaxed)) {
+            m_diff = d;
+            m_first.store(i);
+        }
+    }
+
+};
+
+
 template<size_t N, typename Traits>
 gen_bto_compare<N, Traits>::gen_bto_compare(
     gen_block_tensor_rd_i<N, bti_traits> &bt1,
@@ -105,13 +162,22 @@ bool gen_bto_compare<N, Traits>::compare() {
         }
     }
 
-    //  Compare actual data
+    //  Compare actual data, report the first difference in the order of
+    //  orbits regardless of the order in which blocks were compared
 
+    std::vector<size_t> blst;
+    blst.reserve(ol1.get_size());
     for(typename orbit_list<N, element_type>::iterator io1 = ol1.begin();
         io1 != ol1.end(); ++io1) {
+        blst.push_back(ol1.get_abs_index(io1));
+    }
 
-        abs_index<N> ai(ol1.get_abs_index(io1), bidims);
-        if(!compare_data(ai, ctrl1, ctrl2)) return false;
+    compare_data_blocks body(*this, ctrl1, ctrl2, blst, bidims, m_diff);
+    gen_bto_parallel_for(body, blst.size());
+
+    if(body.get_first() < blst.size()) {
+        m_diff = body.get_diff();
+        return false;
     }
 
     return true;
@@ -168,7 +234,7 @@ bool gen_bto_compare<N, Traits>::compare_transf(const abs_index<N> &aidx,
 template<size_t N, typename Traits>
 bool gen_bto_compare<N, Traits>::compare_data(const abs_index<N> &aidx,
     gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl1,
-    gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl2) {
+    gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl2, diff &d) {
 
     typedef typename Traits::template temp_block_tensor_type<N>::type
             temp_block_tensor_type;
@@ -186,10 +252,10 @@ bool gen_bto_compare<N, Traits>::compare_data(const abs_index<N> &aidx,
 
         if(m_strict) {
 
-            m_diff.kind = diff::DIFF_DATA;
-            m_diff.bidx = idx;
-            m_diff.zero1 = zero1;
-            m_diff.zero2 = zero2;
+            d.kind = diff::DIFF_DATA;
+            d.bidx = idx;
+            d.zero1 = zero1;
+            d.zero2 = zero2;
             return false;
 
         } else {
@@ -224,15 +290,15 @@ bool gen_bto_compare<N, Traits>::compare_data(const abs_index<N> &aidx,
             }
 
             if(!z) {
-                m_diff.kind = diff::DIFF_DATA;
-                m_diff.bidx = idx;
-                m_diff.zero1 = false;
-                m_diff.zero2 = false;
+                d.kind = diff::DIFF_DATA;
+                d.bidx = idx;
+                d.zero1 = false;
+                d.zero2 = false;
                 if(zero1) {
-                    m_diff.data2 = m_diff.data1;
-                    m_diff.data1 = Traits::zero();
+                    d.data2 = d.data1;
+                    d.data1 = Traits::zero();
                 } else {
-                    m_diff.data2 = Traits::zero();
+                    d.data2 = Traits::zero();
                 }
                 return false;
             }
@@ -249,15 +315,15 @@ bool gen_bto_compare<N, Traits>::compare_data(const abs_index<N> &aidx,
     to_compare cmp(t1, t2, m_thresh);
     if(cmp.compare()) return true;
 
-    m_diff.kind = diff::DIFF_DATA;
-    m_diff.bidx = idx;
-    m_diff.idx = cmp.get_diff_index();
-    m_diff.can1 = true;
-    m_diff.can2 = true;
-    m_diff.zero1 = false;
-    m_diff.zero2 = false;
-    m_diff.data1 = cmp.get_diff_elem_1();
-    m_diff.data2 = cmp.get_diff_elem_2();
+    d.kind = diff::DIFF_DATA;
+    d.bidx = idx;
+    d.idx = cmp.get_diff_index();
+    d.can1 = true;
+    d.can2 = true;
+    d.zero1 = false;
+    d.zero2 = false;
+    d.data1 = cmp.get_diff_elem_1();
+    d.data2 = cmp.get_diff_elem_2();
 
     return false;
 }
@@ -8,6 +8,7 @@
 #include "../gen_block_stream_i.h"
 #include "../gen_block_tensor_i.h"
 #include "gen_bto_contract2_block_list.h"
+#include "gen_bto_contract2_clst_cache.h"
 
 namespace libtensor {
 
@@ -97,10 +98,13 @@ public:
     /** \brief Computes and writes the blocks of the result to an output stream
         \param blst List of absolute indexes of canonical blocks to be computed.
         \param out Output stream.
+        \param cache Lists of block contractions of the batch, built if not
+            ready and reused otherwise (optional).
      **/
     void perform(
         const std::vector<size_t> &blst,
-        gen_block_stream_i<NC, bti_traits> &out);
+        gen_block_stream_i<NC, bti_traits> &out,
+        gen_bto_contract2_clst_cache<N, M, K, Traits> *cache = 0);
 };
 
 
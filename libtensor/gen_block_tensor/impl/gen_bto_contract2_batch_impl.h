@@ -4,6 +4,9 @@
 #include <algorithm>
 #include <utility>
 #include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/core/blas_threading_policy.h>
+#include <libtensor/core/grouped_contractions.h>
+#include <libtensor/linalg/BlasSequential.h>
 #include <libtensor/symmetry/so_permute.h>
 #include "../gen_block_tensor_ctrl.h"
 #include "../gen_bto_aux_copy.h"
@@ -103,6 +106,52 @@ public:
 };
 
 
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+class gen_bto_contract2_group_task : public libutil::task_i {
+public:
+    typedef typename Traits::element_type element_type;
+    typedef typename Traits::bti_traits bti_traits;
+    typedef typename Traits::template temp_block_tensor_type<N + M>::type
+        temp_block_tensor_c_type;
+    typedef typename gen_bto_contract2_clst<N, M, K, element_type>::list_type
+        contr_list_type;
+
+private:
+    gen_bto_contract2_block<N, M, K, Traits, Timed> &m_bto;
+    std::vector<const contr_list_type*> m_clst;
+    temp_block_tensor_c_type &m_btc;
+    std::vector< index<N + M> > m_idxc;
+    gen_block_stream_i<N + M, bti_traits> &m_out;
+    unsigned long m_cost;
+
+public:
+    gen_bto_contract2_group_task(
+        gen_bto_contract2_block<N, M, K, Traits, Timed> &bto,
+        temp_block_tensor_c_type &btc,
+        gen_block_stream_i<N + M, bti_traits> &out) :
+
+        m_bto(bto), m_btc(btc), m_out(out), m_cost(0)
+    { }
+
+    virtual ~gen_bto_contract2_group_task() { }
+    virtual unsigned long get_cost() const { return m_cost; }
+    virtual void perform();
+
+    void add_block(const contr_list_type &clst, const index<N + M> &idxc,
+        unsigned long cost) {
+
+        m_clst.push_back(&clst);
+        m_idxc.push_back(idxc);
+        m_cost += cost;
+    }
+
+    size_t get_nblocks() const {
+        return m_clst.size();
+    }
+
+};
+
+
 template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
 class gen_bto_contract2_task_iterator : public libutil::task_iterator_i {
 public:
@@ -120,6 +169,9 @@ private:
     dimensions<N + M> m_bidimsc;
     gen_block_stream_i<N + M, bti_traits> &m_out;
     typename std::vector<clst_pair_type>::const_iterator m_i;
+    bool m_grouped; //!< Group small blocks (\sa grouped_contractions)
+    unsigned long m_max_cost; //!< Maximum cost of grouped block
+    size_t m_max_blocks; //!< Maximum number of blocks in group
 
 public:
     gen_bto_contract2_task_iterator(
@@ -176,7 +228,8 @@ gen_bto_contract2_batch<N, M, K, Traits, Timed>::gen_bto_contract2_batch(
 template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
 void gen_bto_contract2_batch<N, M, K, Traits, Timed>::perform(
     const std::vector<size_t> &blst,
-    gen_block_stream_i<NC, bti_traits> &out) {
+    gen_block_stream_i<NC, bti_traits> &out,
+    gen_bto_contract2_clst_cache<N, M, K, Traits> *cache) {
 
     typedef typename Traits::template temp_block_tensor_type<NC>::type
         temp_block_tensor_c_type;
@@ -226,29 +279,39 @@ void gen_bto_contract2_batch<N, M, K, Traits, Timed>::perform(
         block_list<NA> bla(bidimsa, blsta);
         block_list<NB> blb(bidimsb, blstb);
 
-        gen_bto_contract2_block_list<N, M, K> cbl(m_contr, bidimsa, m_blax,
-            bidimsb, m_blbx);
-
         blsta.clear();
         blstb.clear();
 
-        std::vector<clst_pair_type> clstb;
-        clstb.reserve(blst.size());
-        for(typename std::vector<size_t>::const_iterator i = blst.begin();
-            i != blst.end(); ++i) {
-
-            index<NC> idxc;
-            abs_index<NC>::get_index(*i, bidimsc, idxc);
-            gen_bto_contract2_clst_builder<N, M, K, Traits> *clstop =
-                new gen_bto_contract2_clst_builder<N, M, K, Traits>(m_contr,
-                    syma2, symb2, m_blax, m_blbx, bidimsc, idxc);
-            clstb.push_back(std::make_pair(*i, clstop));
-        }
-        {
-            gen_bto_contract2_prepare_clst_task_iterator<N, M, K, Traits> ti(
-                cbl, clstb);
-            gen_bto_contract2_task_observer<N, M, K> to;
-            libutil::thread_pool::submit(ti, to);
+        //  Lists of contractions only depend on the block structure,
+        //  a ready cache holds the lists from an earlier run
+
+        std::vector<clst_pair_type> clstb0;
+        std::vector<clst_pair_type> &clstb = cache ? cache->get_lists() : clstb0;
+        if(cache == 0 || !cache->is_ready()) {
+
+            if(cache) cache->clear();
+
+            gen_bto_contract2_block_list<N, M, K> cbl(m_contr, bidimsa, m_blax,
+                bidimsb, m_blbx);
+
+            clstb.reserve(blst.size());
+            for(typename std::vector<size_t>::const_iterator i = blst.begin();
+                i != blst.end(); ++i) {
+
+                index<NC> idxc;
+                abs_index<NC>::get_index(*i, bidimsc, idxc);
+                gen_bto_contract2_clst_builder<N, M, K, Traits> *clstop =
+                    new gen_bto_contract2_clst_builder<N, M, K, Traits>(m_contr,
+                        syma2, symb2, m_blax, m_blbx, bidimsc, idxc);
+                clstb.push_back(std::make_pair(*i, clstop));
+            }
+            {
+                gen_bto_contract2_prepare_clst_task_iterator<N, M, K, Traits>
+                    ti(cbl, clstb);
+                gen_bto_contract2_task_observer<N, M, K> to;
+                libutil::thread_pool::submit(ti, to);
+            }
+            if(cache) cache->set_ready();
         }
         for(typename std::vector<clst_pair_type>::iterator i = clstb.begin();
             i != clstb.end(); ++i) {
@@ -270,17 +333,55 @@ void gen_bto_contract2_batch<N, M, K, Traits, Timed>::perform(
         gen_bto_contract2_block<N, M, K, Traits, Timed> bto(m_contr,
             m_bta, m_bta2, syma2, bla, m_ka, m_btb, m_btb2, symb2, blb, m_kb,
             m_bisc, m_kc);
-        gen_bto_contract2_task_iterator<N, M, K, Traits, Timed> ti(bto, clstb,
-            btc, out);
+
+        //  Huge contractions run first with threaded BLAS, the rest with
+        //  one BLAS thread per pool thread (see blas_threading_policy)
+
+        std::vector<clst_pair_type> clstb_huge, clstb_small;
+        size_t nblas = 0, ncpus = libutil::thread_pool::get_ncpus();
+        bool hybrid = ncpus > 1 && blas_threading_policy::is_enabled();
+        if(hybrid) {
+            std::vector<unsigned long> costs(clstb.size());
+            for(size_t i = 0; i < clstb.size(); i++) {
+                index<NC> idxc;
+                abs_index<NC>::get_index(clstb[i].first, bidimsc, idxc);
+                costs[i] = bto.get_cost(clstb[i].second->get_clst(),
+                    btc.get_bis(), idxc);
+            }
+            std::vector<bool> huge;
+            nblas = blas_threading_policy::plan(costs, ncpus, huge);
+            for(size_t i = 0; i < clstb.size(); i++) {
+                if(huge[i]) clstb_huge.push_back(clstb[i]);
+                else clstb_small.push_back(clstb[i]);
+            }
+        }
+
         gen_bto_contract2_task_observer<N, M, K> to;
-        libutil::thread_pool::submit(ti, to);
+        if(hybrid) {
+            if(!clstb_huge.empty()) {
+                BlasThreads blas(int(nblas));
+                gen_bto_contract2_task_iterator<N, M, K, Traits, Timed> ti(bto,
+                    clstb_huge, btc, out);
+                libutil::thread_pool::submit(ti, to);
+            }
+            BlasThreads blas(1);
+            gen_bto_contract2_task_iterator<N, M, K, Traits, Timed> ti(bto,
+                clstb_small, btc, out);
+            libutil::thread_pool::submit(ti, to);
+        } else {
+            gen_bto_contract2_task_iterator<N, M, K, Traits, Timed> ti(bto,
+                clstb, btc, out);
+            libutil::thread_pool::submit(ti, to);
+        }
 
-        for(typename std::vector<clst_pair_type>::iterator i = clstb.begin();
-            i != clstb.end(); ++i) {
-            delete i->second;
-            i->second = 0;
+        if(cache == 0) {
+            for(typename std::vector<clst_pair_type>::iterator i =
+                clstb.begin(); i != clstb.end(); ++i) {
+                delete i->second;
+                i->second = 0;
+            }
+            clstb.clear();
         }
-        clstb.clear();
 
     } catch(...) {
         gen_bto_contract2_batch::stop_timer();
@@ -362,6 +463,35 @@ void gen_bto_contract2_task<N, M, K, Traits, Timed>::perform() {
 }
 
 
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+void gen_bto_contract2_group_task<N, M, K, Traits, Timed>::perform() {
+
+    typedef typename bti_traits::template rd_block_type<N + M>::type
+        rd_block_type;
+    typedef typename bti_traits::template wr_block_type<N + M>::type
+        wr_block_type;
+
+    tensor_transf<N + M, element_type> tr0;
+    gen_block_tensor_ctrl<N + M, bti_traits> cc(m_btc);
+
+    {
+        std::vector<wr_block_type*> blkc(m_idxc.size());
+        for(size_t i = 0; i < m_idxc.size(); i++) {
+            blkc[i] = &cc.req_block(m_idxc[i]);
+        }
+        m_bto.compute_blocks(m_clst, true, tr0, blkc);
+        for(size_t i = 0; i < m_idxc.size(); i++) cc.ret_block(m_idxc[i]);
+    }
+
+    for(size_t i = 0; i < m_idxc.size(); i++) {
+        rd_block_type &blkc = cc.req_const_block(m_idxc[i]);
+        m_out.put(m_idxc[i], blkc, tr0);
+        cc.ret_const_block(m_idxc[i]);
+        cc.req_zero_block(m_idxc[i]);
+    }
+}
+
+
 template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
 gen_bto_contract2_task_iterator<N, M, K, Traits, Timed>::
 gen_bto_contract2_task_iterator(
@@ -372,7 +502,10 @@ gen_bto_contract2_task_iterator(
 
     m_bto(bto), m_clstb(clstb), m_btc(btc),
     m_bidimsc(m_btc.get_bis().get_block_index_dims()),
-    m_out(out), m_i(m_clstb.begin()) {
+    m_out(out), m_i(m_clstb.begin()),
+    m_grouped(grouped_contractions::is_enabled()),
+    m_max_cost(grouped_contractions::get_max_cost()),
+    m_max_blocks(grouped_contractions::get_max_blocks()) {
 
 }
 
@@ -388,6 +521,26 @@ template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
 libutil::task_i *
 gen_bto_contract2_task_iterator<N, M, K, Traits, Timed>::get_next() {
 
+    //  Gather consecutive small blocks into one task
+
+    if(m_grouped) {
+        gen_bto_contract2_group_task<N, M, K, Traits, Timed> *t = 0;
+        while(m_i != m_clstb.end() &&
+            (t == 0 || t->get_nblocks() < m_max_blocks)) {
+            abs_index<N + M> aidxc(m_i->first, m_bidimsc);
+            unsigned long cost = m_bto.get_cost(m_i->second->get_clst(),
+                m_btc.get_bis(), aidxc.get_index());
+            if(cost > m_max_cost) break;
+            if(t == 0) {
+                t = new gen_bto_contract2_group_task<N, M, K, Traits, Timed>(
+                    m_bto, m_btc, m_out);
+            }
+            t->add_block(m_i->second->get_clst(), aidxc.get_index(), cost);
+            ++m_i;
+        }
+        if(t != 0) return t;
+    }
+
     abs_index<N + M> aidxc(m_i->first, m_bidimsc);
     gen_bto_contract2_task<N, M, K, Traits, Timed> *t =
         new gen_bto_contract2_task<N, M, K, Traits, Timed>(m_bto,
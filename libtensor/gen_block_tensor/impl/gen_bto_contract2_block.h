@@ -1,6 +1,8 @@
 #ifndef LIBTENSOR_GEN_BTO_CONTRACT2_BLOCK_H
 #define LIBTENSOR_GEN_BTO_CONTRACT2_BLOCK_H
 
+#include <map>
+#include <vector>
 #include <libtensor/timings.h>
 #include <libtensor/core/contraction2.h>
 #include <libtensor/core/noncopyable.h>
@@ -30,6 +32,9 @@ namespace libtensor {
             operation to_contract2
     - \c template to_contract2_type<N, M, K>::clst_optimize_type -- Type of
             contraction pair list optimizer (\sa gen_bto_contract2_clst_builder)
+    - \c template to_contract2_type<N, M, K>::batch_type -- Type of tensor
+            operation to_contract2_batch (grouped contractions of several
+            blocks, \sa grouped_contractions)
 
     \sa gen_bto_contract2
 
@@ -67,6 +72,10 @@ public:
     typedef typename gen_bto_contract2_clst<N, M, K, element_type>::list_type
         contr_list_type;
 
+    //! Type of a contraction pair
+    typedef typename gen_bto_contract2_clst<N, M, K, element_type>::pair_type
+        contr_pair_type;
+
 private:
     contraction2<N, M, K> m_contr; //!< Contraction
     gen_block_tensor_rd_i<NA, bti_traits> &m_bta; //!< First block tensor (A)
@@ -146,6 +155,38 @@ public:
         const tensor_transf<NC, element_type> &trc,
         wr_block_c_type &blkc);
 
+    /** \brief Computes several blocks at once, grouping the block
+            contractions by shape (\sa grouped_contractions)
+        \param clst Lists of contractions, one per block.
+        \param zero Zero the blocks before computing.
+        \param trc Transformation of result blocks.
+        \param blkc Result blocks.
+     **/
+    void compute_blocks(
+        const std::vector<const contr_list_type*> &clst,
+        bool zero,
+        const tensor_transf<NC, element_type> &trc,
+        const std::vector<wr_block_c_type*> &blkc);
+
+private:
+    rd_block_a_type &req_block_a(
+        const contr_pair_type &cp,
+        gen_block_tensor_rd_ctrl<NA, bti_traits> &ca,
+        std::map<size_t, rd_block_a_type*> &coba);
+
+    rd_block_b_type &req_block_b(
+        const contr_pair_type &cp,
+        gen_block_tensor_rd_ctrl<NB, bti_traits> &cb,
+        std::map<size_t, rd_block_b_type*> &cobb);
+
+    void prepare_pair(
+        const contr_pair_type &cp,
+        const tensor_transf<NC, element_type> &trc,
+        contraction2<N, M, K> &contr,
+        scalar_transf<element_type> &ka,
+        scalar_transf<element_type> &kb,
+        scalar_transf<element_type> &kc);
+
 };
 
 
@@ -124,57 +124,11 @@ void gen_bto_contract2_block<N, M, K, Traits, Timed>::compute_block(
     for(typename contr_list_type::const_iterator i = clst.begin();
         i != clst.end(); ++i) {
 
-        size_t aia, aib;
-        index<NA> ia;
-        index<NB> ib;
-
-        if(m_use_broken_sym) {
-            aia = i->get_aindex_a();
-            aib = i->get_aindex_b();
-        } else {
-            aia = i->get_acindex_a();
-            aib = i->get_acindex_b();
-        }
-        abs_index<NA>::get_index(aia, m_bidimsa, ia);
-        abs_index<NB>::get_index(aib, m_bidimsb, ib);
-
-        if(coba.find(aia) == coba.end()) {
-            rd_block_a_type &blka = ca2.req_const_block(ia);
-            coba[aia] = &blka;
-        }
-        if(cobb.find(aib) == cobb.end()) {
-            rd_block_b_type &blkb = cb2.req_const_block(ib);
-            cobb[aib] = &blkb;
-        }
-        rd_block_a_type &blka = *coba[aia];
-        rd_block_b_type &blkb = *cobb[aib];
-
-        tensor_transf<NA, element_type> tra;
-        tensor_transf<NB, element_type> trb;
-
-        if(m_use_broken_sym) {
-            orbit<NA, element_type> oa(m_syma, aia);
-            orbit<NB, element_type> ob(m_symb, aib);
-            tra.transform(tensor_transf<NA, element_type>(
-                oa.get_transf(aia), true));
-            trb.transform(tensor_transf<NB, element_type>(
-                ob.get_transf(aib), true));
-        }
-        tra.transform(i->get_transf_a());
-        trb.transform(i->get_transf_b());
-
         contraction2<N, M, K> contr(m_contr);
-        contr.permute_a(permutation<NA>(tra.get_perm(), true));
-        contr.permute_b(permutation<NB>(trb.get_perm(), true));
-        contr.permute_c(trc.get_perm());
-
-        scalar_transf<element_type> ka(tra.get_scalar_tr());
-        scalar_transf<element_type> kb(trb.get_scalar_tr());
-        scalar_transf<element_type> kc(m_kc);
-
-        ka.transform(m_ka);
-        kb.transform(m_kb);
-        kc.transform(trc.get_scalar_tr());
+        scalar_transf<element_type> ka, kb, kc;
+        rd_block_a_type &blka = req_block_a(*i, ca2, coba);
+        rd_block_b_type &blkb = req_block_b(*i, cb2, cobb);
+        prepare_pair(*i, trc, contr, ka, kb, kc);
 
         if(op.get() == 0) {
             op = std::auto_ptr<to_contract2>(
@@ -205,6 +159,133 @@ void gen_bto_contract2_block<N, M, K, Traits, Timed>::compute_block(
 }
 
 
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+void gen_bto_contract2_block<N, M, K, Traits, Timed>::compute_blocks(
+    const std::vector<const contr_list_type*> &clst,
+    bool zero,
+    const tensor_transf<NC, element_type> &trc,
+    const std::vector<wr_block_c_type*> &blkc) {
+
+    typedef typename Traits::template to_contract2_type<N, M, K>::batch_type
+        to_contract2_batch;
+
+    gen_block_tensor_rd_ctrl<NA, bti_traits> ca2(m_bta2);
+    gen_block_tensor_rd_ctrl<NB, bti_traits> cb2(m_btb2);
+
+    //  Keep track of checked out blocks
+    typedef std::map<size_t, rd_block_a_type*> coba_map;
+    typedef std::map<size_t, rd_block_b_type*> cobb_map;
+    coba_map coba;
+    cobb_map cobb;
+
+    //  Gather the block contractions for all the result blocks
+    to_contract2_batch op;
+    for(size_t j = 0; j < clst.size(); j++) {
+
+        size_t ic = op.add_result(*blkc[j]);
+        for(typename contr_list_type::const_iterator i = clst[j]->begin();
+            i != clst[j]->end(); ++i) {
+
+            contraction2<N, M, K> contr(m_contr);
+            scalar_transf<element_type> ka, kb, kc;
+            rd_block_a_type &blka = req_block_a(*i, ca2, coba);
+            rd_block_b_type &blkb = req_block_b(*i, cb2, cobb);
+            prepare_pair(*i, trc, contr, ka, kb, kc);
+            op.add_args(contr, blka, ka, blkb, kb, kc, ic);
+        }
+    }
+
+    //  Execute the contractions
+    op.perform(zero);
+
+    //  Return input blocks
+    for(typename coba_map::iterator i = coba.begin(); i != coba.end(); ++i) {
+        index<NA> ia;
+        abs_index<NA>::get_index(i->first, m_bidimsa, ia);
+        ca2.ret_const_block(ia);
+    }
+    for(typename cobb_map::iterator i = cobb.begin(); i != cobb.end(); ++i) {
+        index<NB> ib;
+        abs_index<NB>::get_index(i->first, m_bidimsb, ib);
+        cb2.ret_const_block(ib);
+    }
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+typename gen_bto_contract2_block<N, M, K, Traits, Timed>::rd_block_a_type &
+gen_bto_contract2_block<N, M, K, Traits, Timed>::req_block_a(
+    const contr_pair_type &cp,
+    gen_block_tensor_rd_ctrl<NA, bti_traits> &ca,
+    std::map<size_t, rd_block_a_type*> &coba) {
+
+    size_t aia = m_use_broken_sym ? cp.get_aindex_a() : cp.get_acindex_a();
+    typename std::map<size_t, rd_block_a_type*>::iterator i = coba.find(aia);
+    if(i == coba.end()) {
+        index<NA> ia;
+        abs_index<NA>::get_index(aia, m_bidimsa, ia);
+        i = coba.insert(std::make_pair(aia, &ca.req_const_block(ia))).first;
+    }
+    return *i->second;
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+typename gen_bto_contract2_block<N, M, K, Traits, Timed>::rd_block_b_type &
+gen_bto_contract2_block<N, M, K, Traits, Timed>::req_block_b(
+    const contr_pair_type &cp,
+    gen_block_tensor_rd_ctrl<NB, bti_traits> &cb,
+    std::map<size_t, rd_block_b_type*> &cobb) {
+
+    size_t aib = m_use_broken_sym ? cp.get_aindex_b() : cp.get_acindex_b();
+    typename std::map<size_t, rd_block_b_type*>::iterator i = cobb.find(aib);
+    if(i == cobb.end()) {
+        index<NB> ib;
+        abs_index<NB>::get_index(aib, m_bidimsb, ib);
+        i = cobb.insert(std::make_pair(aib, &cb.req_const_block(ib))).first;
+    }
+    return *i->second;
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+void gen_bto_contract2_block<N, M, K, Traits, Timed>::prepare_pair(
+    const contr_pair_type &cp,
+    const tensor_transf<NC, element_type> &trc,
+    contraction2<N, M, K> &contr,
+    scalar_transf<element_type> &ka,
+    scalar_transf<element_type> &kb,
+    scalar_transf<element_type> &kc) {
+
+    tensor_transf<NA, element_type> tra;
+    tensor_transf<NB, element_type> trb;
+
+    if(m_use_broken_sym) {
+        size_t aia = cp.get_aindex_a(), aib = cp.get_aindex_b();
+        orbit<NA, element_type> oa(m_syma, aia);
+        orbit<NB, element_type> ob(m_symb, aib);
+        tra.transform(tensor_transf<NA, element_type>(
+            oa.get_transf(aia), true));
+        trb.transform(tensor_transf<NB, element_type>(
+            ob.get_transf(aib), true));
+    }
+    tra.transform(cp.get_transf_a());
+    trb.transform(cp.get_transf_b());
+
+    contr.permute_a(permutation<NA>(tra.get_perm(), true));
+    contr.permute_b(permutation<NB>(trb.get_perm(), true));
+    contr.permute_c(trc.get_perm());
+
+    ka = tra.get_scalar_tr();
+    kb = trb.get_scalar_tr();
+    kc = m_kc;
+
+    ka.transform(m_ka);
+    kb.transform(m_kb);
+    kc.transform(trc.get_scalar_tr());
+}
+
+
 } // namespace libtensor
 
 #endif // LIBTENSOR_GEN_BTO_CONTRACT2_BLOCK_IMPL_H
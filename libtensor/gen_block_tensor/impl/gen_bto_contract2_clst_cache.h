@@ -0,0 +1,79 @@
+#ifndef LIBTENSOR_GEN_BTO_CONTRACT2_CLST_CACHE_H
+#define LIBTENSOR_GEN_BTO_CONTRACT2_CLST_CACHE_H
+
+#include <utility>
+#include <vector>
+#include <libtensor/core/noncopyable.h>
+#include "gen_bto_contract2_clst_builder.h"
+
+namespace libtensor {
+
+
+/** \brief Keeps the lists of block contractions of one batch of
+        a contraction for reuse
+    \tparam N Order of first tensor less degree of contraction.
+    \tparam M Order of second tensor less degree of contraction.
+    \tparam K Order of contraction.
+    \tparam Traits Traits class.
+
+    The lists only depend on the block structure of the arguments, so they
+    can be reused as long as the structure is unchanged (\sa
+    gen_bto_contract2_plan).
+
+    \sa gen_bto_contract2_batch
+
+    \ingroup libtensor_gen_bto
+ **/
+template<size_t N, size_t M, size_t K, typename Traits>
+class gen_bto_contract2_clst_cache : public noncopyable {
+public:
+    typedef gen_bto_contract2_clst_builder<N, M, K, Traits> clst_builder_type;
+    typedef std::pair<size_t, clst_builder_type*> clst_pair_type;
+
+private:
+    std::vector<clst_pair_type> m_clstb; //!< Lists by block of the result
+    bool m_ready; //!< Whether the lists are complete
+
+public:
+    /** \brief Initializes an empty cache
+     **/
+    gen_bto_contract2_clst_cache() : m_ready(false) { }
+
+    /** \brief Destroys the cache
+     **/
+    ~gen_bto_contract2_clst_cache() {
+        clear();
+    }
+
+    /** \brief Returns true if the lists have been built
+     **/
+    bool is_ready() const {
+        return m_ready;
+    }
+
+    /** \brief Marks the lists as complete
+     **/
+    void set_ready() {
+        m_ready = true;
+    }
+
+    /** \brief Returns the lists of contractions by block of the result
+     **/
+    std::vector<clst_pair_type> &get_lists() {
+        return m_clstb;
+    }
+
+    /** \brief Discards the lists
+     **/
+    void clear() {
+        for(size_t i = 0; i < m_clstb.size(); i++) delete m_clstb[i].second;
+        m_clstb.clear();
+        m_ready = false;
+    }
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_GEN_BTO_CONTRACT2_CLST_CACHE_H
@@ -8,9 +8,9 @@
 #include <libutil/threads/auto_lock.h>
 #include <libutil/thread_pool/thread_pool.h>
 #include <libtensor/core/abs_index.h>
+#include <libtensor/core/compiled_symmetry.h>
 #include <libtensor/core/orbit.h>
 #include <libtensor/core/orbit_list.h>
-#include <libtensor/core/short_orbit.h>
 #include <libtensor/symmetry/so_copy.h>
 #include "../gen_block_tensor_ctrl.h"
 #include "gen_bto_contract2_block_list.h"
@@ -42,6 +42,7 @@ public:
     const symmetry<NA, element_type> &m_syma;
     const symmetry<NB, element_type> &m_symb;
     const symmetry<NC, element_type> &m_symc;
+    const compiled_symmetry<NC, element_type> &m_csymc;
     dimensions<NA> m_bidimsa;
     dimensions<NB> m_bidimsb;
     dimensions<NC> m_bidimsc;
@@ -59,6 +60,7 @@ public:
         const symmetry<NA, element_type> &syma,
         const symmetry<NB, element_type> &symb,
         const symmetry<NC, element_type> &symc,
+        const compiled_symmetry<NC, element_type> &csymc,
         const block_list<NA> &blsta,
         const block_list<NB> &blstb,
         const gen_bto_contract2_block_list<N, M, K> &cbl,
@@ -68,6 +70,7 @@ public:
         libutil::mutex &nz_mtx) :
 
         m_contr(contr), m_syma(syma), m_symb(symb), m_symc(symc),
+        m_csymc(csymc),
         m_bidimsa(syma.get_bis().get_block_index_dims()),
         m_bidimsb(symb.get_bis().get_block_index_dims()),
         m_bidimsc(symc.get_bis().get_block_index_dims()),
@@ -364,10 +367,13 @@ void gen_bto_contract2_nzorb<N, M, K, Traits>::build() {
     gen_bto_contract2_block_list<N, M, K> cbl(m_contr, bidimsa, blstax,
         bidimsb, blstbx);
 
+    //  Canonical blocks of the result are looked up for every pair of blocks
+    compiled_symmetry<NC, element_type> csymc(m_symc);
+
     std::vector<size_t> blstc, vis;
     libutil::mutex blstc_mtx, vis_mtx;
     gen_bto_contract2_nzorb_task_ctx<N, M, K, Traits> tctx(m_contr,
-        m_syma, m_symb, m_symc, blstax, blstbx, cbl, vis, blstc, vis_mtx,
+        m_syma, m_symb, m_symc, csymc, blstax, blstbx, cbl, vis, blstc, vis_mtx,
         blstc_mtx);
 
     gen_bto_contract2_nzorb_task_iterator<N, M, K, Traits> ti(tctx);
@@ -425,8 +431,8 @@ void gen_bto_contract2_nzorb_task<N, M, K, Traits>::perform() {
             for(size_t i = 0; i < NC; i++) ic[i] = ici[i] + icj[i];
             ic.permute(permc);
             size_t aic = abs_index<NC>::get_abs_index(ic, m_ctx.m_bidimsc);
-            short_orbit<NC, element_type> soc(m_ctx.m_symc, aic, true);
-            if(soc.is_allowed() && soc.get_acindex() == aic) {
+            if(m_ctx.m_csymc.is_canonical(aic) &&
+                m_ctx.m_csymc.is_allowed(aic)) {
                 candidates.push_back(aic);
             }
             ++ib1;
@@ -514,8 +520,9 @@ void gen_bto_contract2_nzorb_task<N, M, 0, Traits>::perform() {
         for(size_t i = 0; i < NC; i++) ic[i] = ici[i] + icj[i];
         ic.permute(permc);
         size_t aic = abs_index<NC>::get_abs_index(ic, m_ctx.m_bidimsc);
-        short_orbit<NC, element_type> soc(m_ctx.m_symc, aic, true);
-        if(soc.is_allowed() && soc.get_acindex() == aic) nonzero.push_back(aic);
+        if(m_ctx.m_csymc.is_canonical(aic) && m_ctx.m_csymc.is_allowed(aic)) {
+            nonzero.push_back(aic);
+        }
         ++ib;
     }
     std::sort(nonzero.begin(), nonzero.end());
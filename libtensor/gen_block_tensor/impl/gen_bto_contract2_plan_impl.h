@@ -0,0 +1,119 @@
+#ifndef LIBTENSOR_GEN_BTO_CONTRACT2_PLAN_IMPL_H
+#define LIBTENSOR_GEN_BTO_CONTRACT2_PLAN_IMPL_H
+
+#include "../gen_block_tensor_ctrl.h"
+#include "../gen_bto_contract2_plan.h"
+#include "gen_bto_contract2_sym_impl.h"
+
+namespace libtensor {
+
+
+template<size_t N, size_t M, size_t K, typename Traits>
+bool gen_bto_contract2_plan<N, M, K, Traits>::prepare(
+    const contraction2<N, M, K> &contr,
+    gen_block_tensor_rd_i<NA, bti_traits> &bta,
+    gen_block_tensor_rd_i<NB, bti_traits> &btb) {
+
+    //  The stored contraction is only complete once a plan has been made
+
+    bool same_contr = m_symc != 0;
+    if(same_contr) {
+        const sequence<2 * (N + M + K), size_t> &conn1 = m_contr.get_conn(),
+            &conn2 = contr.get_conn();
+        for(size_t i = 0; same_contr && i < 2 * (N + M + K); i++) {
+            if(conn1[i] != conn2[i]) same_contr = false;
+        }
+    }
+    if(same_contr && is_current(bta, btb)) {
+        m_nreuse++;
+        return false;
+    }
+
+    clear();
+
+    size_t vera, verb;
+    {
+        gen_block_tensor_rd_ctrl<NA, bti_traits> ca(bta);
+        gen_block_tensor_rd_ctrl<NB, bti_traits> cb(btb);
+        vera = ca.req_structure_version();
+        verb = cb.req_structure_version();
+    }
+
+    m_contr = contr;
+    m_symc = new gen_bto_contract2_sym<N, M, K, Traits>(contr, bta, btb);
+    m_sch = new assignment_schedule<NC, element_type>(
+        m_symc->get_bis().get_block_index_dims());
+    m_vera = vera;
+    m_verb = verb;
+    m_nbuild++;
+
+    return true;
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits>
+bool gen_bto_contract2_plan<N, M, K, Traits>::is_current(
+    gen_block_tensor_rd_i<NA, bti_traits> &bta,
+    gen_block_tensor_rd_i<NB, bti_traits> &btb) {
+
+    if(m_symc == 0 || m_vera == 0 || m_verb == 0) return false;
+
+    gen_block_tensor_rd_ctrl<NA, bti_traits> ca(bta);
+    gen_block_tensor_rd_ctrl<NB, bti_traits> cb(btb);
+    return ca.req_structure_version() == m_vera &&
+        cb.req_structure_version() == m_verb;
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits>
+typename gen_bto_contract2_plan<N, M, K, Traits>::batches &
+gen_bto_contract2_plan<N, M, K, Traits>::make_batches() {
+
+    clear_batches();
+    m_batches = new batches;
+    return *m_batches;
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits>
+typename gen_bto_contract2_plan<N, M, K, Traits>::clst_cache_type *
+gen_bto_contract2_plan<N, M, K, Traits>::get_clst_cache(size_t iba,
+    size_t ibb, size_t ibc) {
+
+    if(!m_keep_clst || m_batches == 0) return 0;
+
+    size_t nba = m_batches->batchesa.size(), nbb = m_batches->batchesb.size(),
+        nbc = m_batches->batchesc.size();
+    if(m_clst.empty()) m_clst.resize(nba * nbb * nbc, 0);
+
+    size_t i = (iba * nbb + ibb) * nbc + ibc;
+    if(m_clst[i] == 0) m_clst[i] = new clst_cache_type;
+    return m_clst[i];
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits>
+const addition_schedule<N + M, Traits> &
+gen_bto_contract2_plan<N, M, K, Traits>::req_addition_schedule(
+    gen_block_tensor_rd_i<NC, bti_traits> &btc) {
+
+    gen_block_tensor_rd_ctrl<NC, bti_traits> cc(btc);
+    size_t verc = cc.req_structure_version();
+    if(m_asch != 0 && verc != 0 && verc == m_verc) return *m_asch;
+
+    std::vector<size_t> nzblkc;
+    cc.req_nonzero_blocks(nzblkc);
+
+    delete m_asch; m_asch = 0;
+    m_asch = new addition_schedule<NC, Traits>(m_symc->get_symmetry(),
+        cc.req_const_symmetry());
+    m_asch->build(*m_sch, nzblkc);
+    m_verc = verc;
+
+    return *m_asch;
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_GEN_BTO_CONTRACT2_PLAN_IMPL_H
@@ -0,0 +1,106 @@
+#ifndef LIBTENSOR_GEN_BTO_PARALLEL_FOR_H
+#define LIBTENSOR_GEN_BTO_PARALLEL_FOR_H
+
+#include <libutil/thread_pool/thread_pool.h>
+
+namespace libtensor {
+
+
+/** \brief Task that performs one item of a parallel loop
+    \tparam Body Loop body type.
+
+    \sa gen_bto_parallel_for
+
+    \ingroup libtensor_gen_bto
+ **/
+template<typename Body>
+class gen_bto_parallel_for_task : public libutil::task_i {
+private:
+    Body &m_body; //!< Loop body
+    size_t m_i; //!< Item number
+
+public:
+    gen_bto_parallel_for_task(Body &body, size_t i) : m_body(body), m_i(i) { }
+
+    virtual ~gen_bto_parallel_for_task() { }
+    virtual unsigned long get_cost() const { return 0; }
+
+    virtual void perform() {
+        m_body.perform_item(m_i);
+    }
+
+};
+
+
+/** \brief Iterator over the tasks of a parallel loop
+    \tparam Body Loop body type.
+
+    \sa gen_bto_parallel_for
+
+    \ingroup libtensor_gen_bto
+ **/
+template<typename Body>
+class gen_bto_parallel_for_task_iterator : public libutil::task_iterator_i {
+private:
+    Body &m_body; //!< Loop body
+    size_t m_n; //!< Number of items
+    size_t m_i; //!< Next item
+
+public:
+    gen_bto_parallel_for_task_iterator(Body &body, size_t n) :
+        m_body(body), m_n(n), m_i(0) { }
+
+    virtual bool has_more() const {
+        return m_i < m_n;
+    }
+
+    virtual libutil::task_i *get_next() {
+        return new gen_bto_parallel_for_task<Body>(m_body, m_i++);
+    }
+
+};
+
+
+/** \brief Observer of the tasks of a parallel loop (disposes of finished
+        tasks)
+
+    \sa gen_bto_parallel_for
+
+    \ingroup libtensor_gen_bto
+ **/
+class gen_bto_parallel_for_task_observer : public libutil::task_observer_i {
+public:
+    virtual void notify_start_task(libutil::task_i *t) { }
+
+    virtual void notify_finish_task(libutil::task_i *t) {
+        delete t;
+    }
+
+};
+
+
+/** \brief Runs body.perform_item(i) for i = 0, ..., n - 1 on the thread pool
+        associated with the current thread
+    \tparam Body Loop body type.
+    \param body Loop body.
+    \param n Number of items.
+
+    Items may run in any order and concurrently. Operations that reduce over
+    the items shall store one partial result per item and combine them in
+    the order of items after this function returns, so the result does not
+    depend on the number of threads or on scheduling.
+
+    \ingroup libtensor_gen_bto
+ **/
+template<typename Body>
+void gen_bto_parallel_for(Body &body, size_t n) {
+
+    gen_bto_parallel_for_task_iterator<Body> ti(body, n);
+    gen_bto_parallel_for_task_observer to;
+    libutil::thread_pool::submit(ti, to);
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_GEN_BTO_PARALLEL_FOR_H
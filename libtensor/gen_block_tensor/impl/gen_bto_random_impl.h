@@ -5,6 +5,7 @@
 #include <map>
 #include <libutil/thread_pool/thread_pool.h>
 #include <libtensor/core/abs_index.h>
+#include <libtensor/core/counter_rng.h>
 #include <libtensor/core/orbit_list.h>
 #include "../gen_bto_random.h"
 
@@ -32,11 +33,13 @@ private:
     gen_block_tensor_wr_i<N, bti_traits> &m_bt;
     gen_block_tensor_wr_ctrl<N, bti_traits> m_ctrl;
     dimensions<N> m_bidims;
+    uint64_t m_stream; //!< Stream of random numbers
 
 public:
     gen_bto_random_block(
         gen_block_tensor_wr_i<N, bti_traits> &bt) :
-        m_bt(bt), m_ctrl(m_bt), m_bidims(m_bt.get_bis().get_block_index_dims())
+        m_bt(bt), m_ctrl(m_bt), m_bidims(m_bt.get_bis().get_block_index_dims()),
+        m_stream(counter_rng::next_stream())
     { }
 
     void make_block(const index<N> &idx);
@@ -168,7 +171,9 @@ void gen_bto_random_block<N, Traits, Timed>::make_block(const index<N> &idx) {
     const symmetry<N, element_type> &sym = m_ctrl.req_const_symmetry();
     size_t absidx = abs_index<N>::get_abs_index(idx, m_bidims);
 
-    to_random randop;
+    //  The numbers of each block are determined by the block index, so they
+    //  do not depend on the order in which the blocks are made
+    to_random randop(scalar_transf<element_type>(), m_stream, absidx);
 
     tensor_transf_type tr0;
     transf_map_t transf_map;
@@ -1,9 +1,11 @@
 #ifndef LIBTENSOR_GEN_BTO_SCALE_IMPL_H
 #define LIBTENSOR_GEN_BTO_SCALE_IMPL_H
 
+#include <vector>
 #include <libtensor/core/abs_index.h>
 #include "../gen_block_tensor_ctrl.h"
 #include "../gen_bto_scale.h"
+#include "gen_bto_parallel_for.h"
 
 namespace libtensor {
 
@@ -13,11 +15,47 @@ const char gen_bto_scale<N, Traits, Timed>::k_clazz[] =
     "gen_bto_scale<N, Traits, Timed>";
 
 
-template<size_t N, typename Traits, typename Timed>
-void gen_bto_scale<N, Traits, Timed>::perform() {
+namespace {
 
+
+template<size_t N, typename Traits>
+class gen_bto_scale_blocks {
+public:
+    typedef typename Traits::element_type element_type;
+    typedef typename Traits::bti_traits bti_traits;
+    typedef typename bti_traits::template wr_block_type<N>::type wr_block_type;
     typedef typename Traits::template to_scale_type<N>::type to_scale_type;
 
+private:
+    gen_block_tensor_ctrl<N, bti_traits> &m_ctrl;
+    const std::vector<size_t> &m_blst;
+    dimensions<N> m_bidims;
+    const scalar_transf<element_type> &m_c;
+
+public:
+    gen_bto_scale_blocks(gen_block_tensor_ctrl<N, bti_traits> &ctrl,
+        const std::vector<size_t> &blst, const dimensions<N> &bidims,
+        const scalar_transf<element_type> &c) :
+        m_ctrl(ctrl), m_blst(blst), m_bidims(bidims), m_c(c) { }
+
+    void perform_item(size_t i) {
+
+        index<N> idx;
+        abs_index<N>::get_index(m_blst[i], m_bidims, idx);
+        wr_block_type &blk = m_ctrl.req_block(idx);
+        to_scale_type(m_c).perform(blk);
+        m_ctrl.ret_block(idx);
+    }
+
+};
+
+
+} // unnamed namespace
+
+
+template<size_t N, typename Traits, typename Timed>
+void gen_bto_scale<N, Traits, Timed>::perform() {
+
     gen_bto_scale::start_timer();
 
     try {
@@ -29,18 +67,15 @@ void gen_bto_scale<N, Traits, Timed>::perform() {
         std::vector<size_t> nzblk;
         ctrl.req_nonzero_blocks(nzblk);
 
-        for(size_t i = 0; i < nzblk.size(); i++) {
-
-            index<N> idx;
-            abs_index<N>::get_index(nzblk[i], bidims, idx);
-
-            if(m_c.is_zero()) {
+        if(m_c.is_zero()) {
+            for(size_t i = 0; i < nzblk.size(); i++) {
+                index<N> idx;
+                abs_index<N>::get_index(nzblk[i], bidims, idx);
                 ctrl.req_zero_block(idx);
-            } else {
-                wr_block_type &blk = ctrl.req_block(idx);
-                to_scale_type(m_c).perform(blk);
-                ctrl.ret_block(idx);
             }
+        } else {
+            gen_bto_scale_blocks<N, Traits> body(ctrl, nzblk, bidims, m_c);
+            gen_bto_parallel_for(body, nzblk.size());
         }
 
     } catch(...) {
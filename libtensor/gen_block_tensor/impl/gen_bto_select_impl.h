@@ -1,11 +1,14 @@
 #ifndef LIBTENSOR_GEN_BTO_SELECT_IMPL_H
 #define LIBTENSOR_GEN_BTO_SELECT_IMPL_H
 
+#include <algorithm>
+#include <vector>
 #include <libtensor/core/orbit.h>
 #include <libtensor/core/orbit_list.h>
 #include <libtensor/symmetry/so_copy.h>
 #include "../gen_block_tensor_ctrl.h"
 #include "../gen_bto_select.h"
+#include "gen_bto_parallel_for.h"
 
 
 namespace libtensor {
@@ -16,6 +19,68 @@ const char *gen_bto_select<N, Traits, ComparePolicy>::k_clazz =
         "gen_bto_select<N, Traits, ComparePolicy>";
 
 
+template<size_t N, typename Traits, typename ComparePolicy>
+class gen_bto_select<N, Traits, ComparePolicy>::select_blocks {
+private:
+    gen_bto_select<N, Traits, ComparePolicy> &m_op;
+    gen_block_tensor_rd_ctrl<N, bti_traits> &m_ctrl;
+    const std::vector<size_t> &m_blst;
+    dimensions<N> m_bidims;
+    size_t m_n;
+    size_t m_nchunks;
+    std::vector<list_type> &m_lists;
+
+public:
+    select_blocks(gen_bto_select<N, Traits, ComparePolicy> &op,
+        gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl,
+        const std::vector<size_t> &blst, const dimensions<N> &bidims,
+        size_t n, std::vector<list_type> &lists) :
+        m_op(op), m_ctrl(ctrl), m_blst(blst), m_bidims(bidims), m_n(n),
+        m_nchunks(lists.size()), m_lists(lists) { }
+
+    void perform_item(size_t ichunk) {
+
+        size_t nol = m_blst.size();
+        size_t ibeg = nol * ichunk / m_nchunks;
+        size_t iend = nol * (ichunk + 1) / m_nchunks;
+        for (size_t i = ibeg; i < iend; i++) select_orbit(i, m_lists[ichunk]);
+    }
+
+private:
+    void select_orbit(size_t i, list_type &li) {
+
+        const symmetry<N, element_type> &sym = m_ctrl.req_const_symmetry();
+
+        index<N> idxa, idxa0;
+        abs_index<N>::get_index(m_blst[i], m_bidims, idxa);
+
+        orbit<N, element_type> oa(sym, idxa);
+        if (! oa.is_allowed()) return;
+
+        abs_index<N>::get_index(oa.get_acindex(), m_bidims, idxa0);
+        if (m_ctrl.req_is_zero_block(idxa0)) return;
+
+        // Obtain block
+        rd_block_type &t = m_ctrl.req_const_block(idxa0);
+
+        const tensor_transf<N, element_type> &tra = oa.get_transf(idxa);
+
+        // Create element list for canonical block (within the symmetry)
+        to_list_type tlc;
+        to_select(t, tra, m_op.m_cmp).perform(tlc, m_n);
+
+        dimensions<N> dims(t.get_dims());
+        dims.permute(tra.get_perm());
+        transf_list<N, element_type> trl(m_op.m_sym, idxa);
+        m_op.minimize_list(tlc, trl, dims);
+        m_op.merge_lists(li, idxa, tlc, m_n);
+
+        m_ctrl.ret_const_block(idxa0);
+    }
+
+};
+
+
 template<size_t N, typename Traits, typename ComparePolicy>
 gen_bto_select<N, Traits, ComparePolicy>::gen_bto_select(
         gen_block_tensor_rd_i<N, bti_traits> &bt, compare_type cmp) :
@@ -55,38 +120,27 @@ void gen_bto_select<N, Traits, ComparePolicy>::perform(
     dimensions<N> bidims(bis.get_block_index_dims());
 
     gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(m_bt);
-    const symmetry<N, element_type> &sym = ctrl.req_const_symmetry();
 
-    // Loop over all orbits of imposed symmetry
+    // Select elements from each orbit of imposed symmetry in parallel
     orbit_list<N, element_type> ol(m_sym);
+    std::vector<size_t> blst;
+    blst.reserve(ol.get_size());
     for (typename orbit_list<N, element_type>::iterator iol = ol.begin();
             iol != ol.end(); iol++) {
+        blst.push_back(ol.get_abs_index(iol));
+    }
 
-        index<N> idxa, idxa0;
-        abs_index<N>::get_index(ol.get_abs_index(iol), bidims, idxa);
-
-        orbit<N, element_type> oa(sym, idxa);
-        if (! oa.is_allowed()) continue;
-
-        abs_index<N>::get_index(oa.get_acindex(), bidims, idxa0);
-        if (ctrl.req_is_zero_block(idxa0)) continue;
-
-        // Obtain block
-        rd_block_type &t = ctrl.req_const_block(idxa0);
-
-        const tensor_transf<N, element_type> &tra = oa.get_transf(idxa);
-
-        // Create element list for canonical block (within the symmetry)
-        to_list_type tlc;
-        to_select(t, tra, m_cmp).perform(tlc, n);
-
-        dimensions<N> dims(t.get_dims());
-        dims.permute(tra.get_perm());
-        transf_list<N, element_type> trl(m_sym, idxa);
-        minimize_list(tlc, trl, dims);
-        merge_lists(li, idxa, tlc, n);
-
-        ctrl.ret_const_block(idxa0);
+    // Each chunk of orbits keeps its own list of at most n elements, the
+    // number of chunks does not depend on the number of threads
+    size_t nchunks = std::min(blst.size(), size_t(k_max_chunks));
+    std::vector<list_type> lists(nchunks);
+    select_blocks body(*this, ctrl, blst, bidims, n, lists);
+    gen_bto_parallel_for(body, nchunks);
+
+    // Merge in the order of chunks, so ties are resolved as in a serial run
+    for (size_t i = 0; i < nchunks; i++) {
+        merge_lists(li, lists[i], n);
+        lists[i].clear();
     }
 }
 
@@ -184,6 +238,30 @@ void gen_bto_select<N, Traits, ComparePolicy>::merge_lists(list_type &to,
     }
 }
 
+
+template<size_t N, typename Traits, typename ComparePolicy>
+void gen_bto_select<N, Traits, ComparePolicy>::merge_lists(list_type &to,
+        const list_type &from, size_t n) {
+
+    typename list_type::iterator ibt = to.begin();
+    for (typename list_type::const_iterator it = from.begin();
+            it != from.end(); it++) {
+
+        while (ibt != to.end()) {
+            if (m_cmp(it->get_value(), ibt->get_value())) break;
+            ibt++;
+        }
+
+        if (to.size() == n && ibt == to.end()) {
+            return;
+        }
+
+        ibt = to.insert(ibt, *it);
+        if (to.size() > n) to.pop_back();
+        ibt++;
+    }
+}
+
 } // namespace libtensor
 
 #endif // LIBTENSOR_GEN_BTO_SELECT_IMPL_H
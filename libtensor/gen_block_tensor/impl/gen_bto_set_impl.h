@@ -1,20 +1,58 @@
 #ifndef LIBTENSOR_GEN_BTO_SET_IMPL_H
 #define LIBTENSOR_GEN_BTO_SET_IMPL_H
 
+#include <vector>
+#include <libtensor/core/abs_index.h>
 #include <libtensor/core/orbit_list.h>
 #include "../gen_block_tensor_ctrl.h"
 #include "../gen_bto_set.h"
+#include "gen_bto_parallel_for.h"
 
 namespace libtensor {
 
 
-template<size_t N, typename Traits, typename Timed>
-void gen_bto_set<N, Traits, Timed>::perform(
-    gen_block_tensor_wr_i<N, bti_traits> &bta) {
+namespace {
+
 
+template<size_t N, typename Traits>
+class gen_bto_set_blocks {
+public:
+    typedef typename Traits::element_type element_type;
+    typedef typename Traits::bti_traits bti_traits;
     typedef typename bti_traits::template wr_block_type<N>::type wr_block_type;
     typedef typename Traits::template to_set_type<N>::type to_set;
 
+private:
+    gen_block_tensor_wr_ctrl<N, bti_traits> &m_ctrl;
+    const std::vector<size_t> &m_blst;
+    dimensions<N> m_bidims;
+    const element_type &m_v;
+
+public:
+    gen_bto_set_blocks(gen_block_tensor_wr_ctrl<N, bti_traits> &ctrl,
+        const std::vector<size_t> &blst, const dimensions<N> &bidims,
+        const element_type &v) :
+        m_ctrl(ctrl), m_blst(blst), m_bidims(bidims), m_v(v) { }
+
+    void perform_item(size_t i) {
+
+        index<N> bi;
+        abs_index<N>::get_index(m_blst[i], m_bidims, bi);
+        wr_block_type &blk = m_ctrl.req_block(bi);
+        to_set(m_v).perform(true, blk);
+        m_ctrl.ret_block(bi);
+    }
+
+};
+
+
+} // unnamed namespace
+
+
+template<size_t N, typename Traits, typename Timed>
+void gen_bto_set<N, Traits, Timed>::perform(
+    gen_block_tensor_wr_i<N, bti_traits> &bta) {
+
     gen_bto_set::start_timer();
 
     try {
@@ -28,16 +66,17 @@ void gen_bto_set<N, Traits, Timed>::perform(
         } else {
 
             orbit_list<N, element_type> ol(ca.req_const_symmetry());
+            std::vector<size_t> blst;
+            blst.reserve(ol.get_size());
             for(typename orbit_list<N, element_type>::iterator io = ol.begin();
                 io != ol.end(); ++io) {
-
-                index<N> bi;
-                ol.get_index(io, bi);
-                wr_block_type &blk = ca.req_block(bi);
-                to_set(m_v).perform(true, blk);
-                ca.ret_block(bi);
+                blst.push_back(ol.get_abs_index(io));
             }
 
+            gen_bto_set_blocks<N, Traits> body(ca, blst,
+                bta.get_bis().get_block_index_dims(), m_v);
+            gen_bto_parallel_for(body, blst.size());
+
         }
 
     } catch(...) {
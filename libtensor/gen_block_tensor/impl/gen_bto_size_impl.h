@@ -1,37 +1,68 @@
 #ifndef LIBTENSOR_GEN_BTO_SIZE_IMPL_H
 #define LIBTENSOR_GEN_BTO_SIZE_IMPL_H
 
+#include <vector>
 #include <libtensor/core/abs_index.h>
 #include "../gen_block_tensor_ctrl.h"
 #include "../gen_bto_size.h"
+#include "gen_bto_parallel_for.h"
 
 namespace libtensor {
 
 
-template<size_t N, typename Traits>
-size_t gen_bto_size<N, Traits>::get_size(
-    gen_block_tensor_rd_i<N, bti_traits> &bt) {
+namespace {
 
+
+template<size_t N, typename Traits>
+class gen_bto_size_blocks {
+public:
+    typedef typename Traits::bti_traits bti_traits;
     typedef typename bti_traits::template rd_block_type<N>::type rd_block_type;
     typedef typename Traits::template to_size_type<N>::type to_size;
 
+private:
+    gen_block_tensor_rd_ctrl<N, bti_traits> &m_ctrl;
+    const std::vector<size_t> &m_blst;
+    dimensions<N> m_bidims;
+    std::vector<size_t> &m_sz;
+
+public:
+    gen_bto_size_blocks(gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl,
+        const std::vector<size_t> &blst, const dimensions<N> &bidims,
+        std::vector<size_t> &sz) :
+        m_ctrl(ctrl), m_blst(blst), m_bidims(bidims), m_sz(sz) { }
+
+    void perform_item(size_t i) {
+
+        index<N> idx;
+        abs_index<N>::get_index(m_blst[i], m_bidims, idx);
+        rd_block_type &blk = m_ctrl.req_const_block(idx);
+        m_sz[i] = to_size().get_size(blk);
+        m_ctrl.ret_const_block(idx);
+    }
+
+};
+
+
+} // unnamed namespace
+
+
+template<size_t N, typename Traits>
+size_t gen_bto_size<N, Traits>::get_size(
+    gen_block_tensor_rd_i<N, bti_traits> &bt) {
+
     dimensions<N> bidims = bt.get_bis().get_block_index_dims();
     gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(bt);
 
-    size_t sz = 0;
-
     std::vector<size_t> blst;
     ctrl.req_nonzero_blocks(blst);
-    for(typename std::vector<size_t>::const_iterator i = blst.begin();
-        i != blst.end(); ++i) {
 
-        index<N> idx;
-        abs_index<N>::get_index(*i, bidims, idx);
-        rd_block_type &blk = ctrl.req_const_block(idx);
-        sz += to_size().get_size(blk);
-        ctrl.ret_const_block(idx);
-    }
+    std::vector<size_t> blsz(blst.size(), 0);
+    gen_bto_size_blocks<N, Traits> body(ctrl, blst, bidims, blsz);
+    gen_bto_parallel_for(body, blst.size());
 
+    size_t sz = 0;
+    for(size_t i = 0; i < blsz.size(); i++) sz += blsz[i];
     return sz;
 }
 
@@ -0,0 +1,194 @@
+#ifndef LIBTENSOR_KERN_APPLY_I_I_H
+#define LIBTENSOR_KERN_APPLY_I_I_H
+
+#include <algorithm>
+#include <utility>
+#include <libtensor/linalg/linalg.h>
+#include "kernel_base.h"
+
+namespace libtensor {
+
+
+/** \brief Tells whether a functor can be applied to arrays of elements
+
+    The value is true if the functor provides
+    \code
+        void Functor::apply_batch(size_t n, double c1, const double *a,
+            double c2, double *b, bool add);
+    \endcode
+    which computes \f$ b_i = c_2 f(c_1 a_i) \f$ (or adds it to \f$ b_i \f$
+    if add is true) for n consecutive elements.
+
+    \ingroup libtensor_kernels
+ **/
+template<typename Functor>
+class is_batch_functor {
+private:
+    template<typename F>
+    static char test(int, decltype(std::declval<F&>().apply_batch(
+        size_t(0), 0.0, (const double*)0, 0.0, (double*)0, false)) * = 0);
+
+    template<typename F>
+    static long test(...);
+
+public:
+    enum {
+        value = (sizeof(test<Functor>(0)) == sizeof(char))
+    };
+};
+
+
+/** \brief Function application kernel for functors that work on arrays
+        (double)
+    \tparam Functor Functor.
+    \tparam Batch Whether the functor provides apply_batch().
+
+    This kernel takes over one loop of the function application
+    \f[
+        b_i = c_2 f(c_1 a_i) \qquad b_i = b_i + c_2 f(c_1 a_i)
+    \f]
+    and passes the whole loop to Functor::apply_batch() (\sa
+    is_batch_functor), so the functor can vectorize its function. The loop
+    with unit steps in both arrays is preferred. Otherwise the elements are
+    gathered into (and scattered from) a small buffer in chunks.
+
+    For functors without apply_batch() the kernel does not match.
+
+    \ingroup libtensor_kernels
+ **/
+template<typename Functor, bool Batch = is_batch_functor<Functor>::value>
+class kern_apply_i_i : public kernel_base<linalg, 1, 1> {
+public:
+    static const char *k_clazz; //!< Kernel name
+
+private:
+    enum {
+        k_chunk = 256 //!< Number of elements in gather buffer
+    };
+
+private:
+    Functor *m_fn; //!< Functor
+    double m_c1, m_c2;
+    bool m_add; //!< Add to the result
+    size_t m_ni;
+    size_t m_sia, m_sib;
+
+public:
+    virtual ~kern_apply_i_i() { }
+
+    virtual const char *get_name() const {
+        return k_clazz;
+    }
+
+    virtual void run(void *, const loop_registers<1, 1> &r);
+
+    static kernel_base<linalg, 1, 1> *match(Functor &fn,
+            double c1, double c2, bool add, list_t &in, list_t &out);
+};
+
+
+/** \brief Function application kernel for functors that work on arrays
+        (specialization for scalar functors, never matches)
+
+    \ingroup libtensor_kernels
+ **/
+template<typename Functor>
+class kern_apply_i_i<Functor, false> {
+public:
+    static kernel_base<linalg, 1, 1> *match(Functor &fn,
+            double c1, double c2, bool add,
+            kernel_base<linalg, 1, 1>::list_t &in,
+            kernel_base<linalg, 1, 1>::list_t &out) {
+
+        return 0;
+    }
+};
+
+
+template<typename Functor, bool Batch>
+const char *kern_apply_i_i<Functor, Batch>::k_clazz = "kern_apply_i_i";
+
+
+template<typename Functor, bool Batch>
+void kern_apply_i_i<Functor, Batch>::run(void *,
+    const loop_registers<1, 1> &r) {
+
+    const double *pa = r.m_ptra[0];
+    double *pb = r.m_ptrb[0];
+
+    if(m_sia == 1 && m_sib == 1) {
+        m_fn->apply_batch(m_ni, m_c1, pa, m_c2, pb, m_add);
+        return;
+    }
+
+    double bufa[k_chunk], bufb[k_chunk];
+    for(size_t i0 = 0; i0 < m_ni; i0 += k_chunk) {
+
+        size_t n = std::min(size_t(k_chunk), m_ni - i0);
+        const double *pa1 = pa + i0 * m_sia;
+        double *pb1 = pb + i0 * m_sib;
+
+        if(m_sia != 1) {
+            for(size_t i = 0; i < n; i++) bufa[i] = pa1[i * m_sia];
+            pa1 = bufa;
+        }
+        if(m_sib == 1) {
+            m_fn->apply_batch(n, m_c1, pa1, m_c2, pb1, m_add);
+            continue;
+        }
+
+        m_fn->apply_batch(n, m_c1, pa1, m_c2, bufb, false);
+        if(m_add) {
+            for(size_t i = 0; i < n; i++) pb1[i * m_sib] += bufb[i];
+        } else {
+            for(size_t i = 0; i < n; i++) pb1[i * m_sib] = bufb[i];
+        }
+    }
+}
+
+
+template<typename Functor, bool Batch>
+kernel_base<linalg, 1, 1> *kern_apply_i_i<Functor, Batch>::match(Functor &fn,
+        double c1, double c2, bool add, list_t &in, list_t &out) {
+
+    if(in.empty()) return 0;
+
+    //  Prefer the loop with unit steps in both arrays, then the loop with
+    //  unit step in the result, then the longest loop
+
+    iterator_t ii = in.end();
+    for(iterator_t i = in.begin(); i != in.end(); ++i) {
+        if(ii == in.end()) {
+            ii = i;
+            continue;
+        }
+        bool unit1 = (i->stepa(0) == 1 && i->stepb(0) == 1),
+            unit2 = (ii->stepa(0) == 1 && ii->stepb(0) == 1);
+        if(unit1 != unit2) {
+            if(unit1) ii = i;
+            continue;
+        }
+        if((i->stepb(0) == 1) != (ii->stepb(0) == 1)) {
+            if(i->stepb(0) == 1) ii = i;
+            continue;
+        }
+        if(i->weight() > ii->weight()) ii = i;
+    }
+
+    kern_apply_i_i zz;
+    zz.m_fn = &fn;
+    zz.m_c1 = c1;
+    zz.m_c2 = c2;
+    zz.m_add = add;
+    zz.m_ni = ii->weight();
+    zz.m_sia = ii->stepa(0);
+    zz.m_sib = ii->stepb(0);
+    in.splice(out.begin(), out, ii);
+
+    return new kern_apply_i_i(zz);
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_KERN_APPLY_I_I_H
@@ -0,0 +1,169 @@
+#ifndef LIBTENSOR_LOOP_PLAN_CACHE_H
+#define LIBTENSOR_LOOP_PLAN_CACHE_H
+
+#include <cstring> // for memcmp
+#include <list>
+#include <vector>
+#include <libutil/threads/tls.h>
+#include "kernel_base.h"
+#include "loop_list_node.h"
+
+namespace libtensor {
+
+
+/** \brief Key of a loop plan: a signature of fixed length and a scalar
+    \tparam L Length of the signature.
+
+    The signature is made of whatever determines the loops (dimensions,
+    permutations, contraction), the scalar is the factor baked into the
+    kernel.
+
+    \ingroup libtensor_kernels
+ **/
+template<size_t L>
+struct loop_plan_key {
+    size_t sig[L]; //!< Signature
+    double d; //!< Scalar factor
+
+    bool operator==(const loop_plan_key<L> &other) const {
+        return d == other.d && memcmp(sig, other.sig, sizeof(sig)) == 0;
+    }
+};
+
+
+/** \brief Counts hits and misses of all loop plan caches
+
+    \ingroup libtensor_kernels
+ **/
+class loop_plan_cache_stats {
+public:
+    /** \brief Returns the number of plans reused since the last reset
+     **/
+    static size_t get_nhits();
+
+    /** \brief Returns the number of plans built since the last reset
+     **/
+    static size_t get_nmisses();
+
+    /** \brief Resets the counters
+     **/
+    static void reset();
+
+    static void add_hit();
+    static void add_miss();
+};
+
+
+/** \brief Thread-local cache of matched kernels with their loop lists
+    \tparam LA Linear algebra.
+    \tparam N Number of input arrays.
+    \tparam M Number of output arrays.
+    \tparam Key Key type (\sa loop_plan_key).
+
+    Operations on blocks build a loop list and match a kernel for every
+    call, although in a block tensor operation the same signature recurs
+    for many blocks. The cache keeps the kernel and the remaining loops of
+    the most recently used signatures, so that a repeated call neither
+    builds a list nor allocates a kernel:
+
+    \code
+    typedef loop_plan_cache<linalg, 1, 1, loop_plan_key<L> > cache_t;
+    cache_t &cache = cache_t::get_instance();
+    const cache_t::plan *p = cache.find(key);
+    if(p == 0) {
+        // build loop_in, match kernel into loop_in/loop_out
+        p = &cache.insert(key, loop_in, kern);
+    }
+    loop_list_runner<linalg, 1, 1>(p->loop).run(0, r, *p->kern);
+    \endcode
+
+    Each thread has its own cache, so no locking is required. The cache
+    holds up to k_maxplans plans and evicts the least recently used one.
+
+    \ingroup libtensor_kernels
+ **/
+template<typename LA, size_t N, size_t M, typename Key>
+class loop_plan_cache {
+public:
+    enum {
+        k_maxplans = 32 //!< Maximum number of plans per thread
+    };
+
+    typedef std::list< loop_list_node<N, M> > list_t;
+
+    /** \brief Loops and kernel for one signature
+     **/
+    struct plan {
+        Key key; //!< Key
+        list_t loop; //!< Loops left after matching the kernel
+        kernel_base<LA, N, M> *kern; //!< Kernel
+    };
+
+private:
+    std::vector<plan*> m_plans; //!< Plans, most recently used first
+
+public:
+    /** \brief Returns the cache of the calling thread
+     **/
+    static loop_plan_cache &get_instance() {
+        return libutil::tls<loop_plan_cache>::get_instance().get();
+    }
+
+    loop_plan_cache() {
+        m_plans.reserve(k_maxplans);
+    }
+
+    ~loop_plan_cache() {
+        for(size_t i = 0; i < m_plans.size(); i++) {
+            delete m_plans[i]->kern;
+            delete m_plans[i];
+        }
+    }
+
+    /** \brief Returns the plan for the key or null if there is none
+     **/
+    const plan *find(const Key &key) {
+
+        for(size_t i = 0; i < m_plans.size(); i++) {
+            if(m_plans[i]->key == key) {
+                plan *p = m_plans[i];
+                for(size_t j = i; j > 0; j--) m_plans[j] = m_plans[j - 1];
+                m_plans[0] = p;
+                loop_plan_cache_stats::add_hit();
+                return p;
+            }
+        }
+        loop_plan_cache_stats::add_miss();
+        return 0;
+    }
+
+    /** \brief Adds a plan, takes over the loops and the kernel
+        \param key Key.
+        \param loop Loops left after matching (emptied on return).
+        \param kern Kernel (owned by the cache on return).
+     **/
+    const plan &insert(const Key &key, list_t &loop,
+        kernel_base<LA, N, M> *kern) {
+
+        plan *p;
+        if(m_plans.size() == k_maxplans) {
+            p = m_plans.back();
+            m_plans.pop_back();
+            delete p->kern;
+            p->loop.clear();
+        } else {
+            p = new plan;
+        }
+        p->key = key;
+        p->loop.splice(p->loop.end(), loop);
+        p->kern = kern;
+        m_plans.insert(m_plans.begin(), p);
+        return *p;
+    }
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_LOOP_PLAN_CACHE_H
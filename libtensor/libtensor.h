@@ -40,6 +40,7 @@
 
 #include "expr/bispace/bispace.h"
 #include "expr/btensor/btensor.h"
+#include "expr/btensor/factorized_btensor.h"
 #include "expr/iface/expr_tensor.h"
 #include "expr/operators/operators.h"
 
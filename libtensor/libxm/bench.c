@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "xm.h"
+
+/* Times a contraction of disk-backed tensors c_ijab = a_ijkl b_klab.
+ *
+ * Usage: bench [pagefile] [o] [v] [nrep]
+ *
+ * Pass a pagefile on tmpfs (e.g. /dev/shm/xmpagefile) and one on a disk to
+ * compare; "ram" keeps the data in memory. */
+
+static double
+wall_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+static xm_tensor_t *
+make_tensor(xm_allocator_t *allocator, size_t n1, size_t n2, size_t n3,
+    size_t n4)
+{
+	xm_block_space_t *bs;
+	xm_tensor_t *t;
+
+	bs = xm_block_space_create(xm_dim_4(n1, n2, n3, n4));
+	xm_block_space_autosplit(bs);
+	t = xm_tensor_create_canonical(bs, XM_SCALAR_DOUBLE, allocator);
+	xm_block_space_free(bs);
+	return t;
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *path = argc > 1 ? argv[1] : "xmpagefile";
+	size_t o = argc > 2 ? (size_t)atol(argv[2]) : 24;
+	size_t v = argc > 3 ? (size_t)atol(argv[3]) : 96;
+	int i, nrep = argc > 4 ? atoi(argv[4]) : 3;
+	xm_allocator_t *allocator;
+	xm_tensor_t *a, *b, *c;
+	double t;
+
+	allocator = xm_allocator_create(strcmp(path, "ram") ? path : NULL);
+	if (allocator == NULL)
+		return (1);
+	a = make_tensor(allocator, o, o, o, o);
+	b = make_tensor(allocator, o, o, v, v);
+	c = make_tensor(allocator, o, o, v, v);
+	xm_set(a, 1.0);
+	xm_set(b, 0.5);
+
+	t = wall_time();
+	for (i = 0; i < nrep; i++)
+		xm_contract(1.0, a, b, 0.0, c, "ijkl", "klab", "ijab");
+	t = wall_time() - t;
+	printf("%-24s o=%zu v=%zu  %10.4f s\n", path, o, v, t / nrep);
+
+	xm_tensor_free_block_data(a);
+	xm_tensor_free_block_data(b);
+	xm_tensor_free_block_data(c);
+	xm_tensor_free(a);
+	xm_tensor_free(b);
+	xm_tensor_free(c);
+	xm_allocator_destroy(allocator);
+	return (0);
+}
@@ -47,6 +47,7 @@ struct xm_allocator {
 	int mpirank;
 	char *path;
 	size_t file_bytes;
+	size_t first_free;
 	unsigned char *pages;
 #ifdef _OPENMP
 	omp_lock_t mutex;
@@ -108,10 +109,12 @@ find_pages(xm_allocator_t *allocator, size_t n_pages)
 
 	assert(n_pages > 0);
 
+	/* Pages below first_free are all in use, skip them. */
 	n_total = allocator->file_bytes / XM_PAGE_SIZE;
-	for (start = 0; start < n_total; start++)
+	for (start = allocator->first_free; start < n_total; start++)
 		if (!bitmap_test(allocator->pages, start))
 			break;
+	allocator->first_free = start;
 	if (start == n_total)
 		return (XM_NULL_PTR);
 	for (i = start, n_free = 0; i < n_total; i++) {
@@ -121,6 +124,8 @@ find_pages(xm_allocator_t *allocator, size_t n_pages)
 			for (offset = i + 1 - n_free; offset <= i; offset++)
 				bitmap_set(allocator->pages, offset);
 			offset = (uint64_t)(i + 1 - n_free);
+			if (offset == start)
+				allocator->first_free = i + 1;
 			return make_data_ptr(offset, n_pages);
 		}
 	}
@@ -249,6 +254,23 @@ xm_allocator_allocate(xm_allocator_t *allocator, size_t size_bytes)
 /* Maximum size for single pread/pwrite. */
 #define MAXSIZE (1<<30)
 
+/* Reads and writes go to disjoint file ranges with pread/pwrite and need no
+ * locking: threads only serialize on allocate and deallocate. */
+
+void
+xm_allocator_prefetch(xm_allocator_t *allocator, uint64_t data_ptr,
+    size_t size_bytes)
+{
+	if (data_ptr == XM_NULL_PTR || allocator->path == NULL)
+		return;
+#ifdef POSIX_FADV_WILLNEED
+	(void)posix_fadvise(allocator->fd, (off_t)get_block_offset(data_ptr),
+	    (off_t)size_bytes, POSIX_FADV_WILLNEED);
+#else
+	(void)size_bytes;
+#endif
+}
+
 void
 xm_allocator_read(xm_allocator_t *allocator, uint64_t data_ptr,
     void *mem, size_t size_bytes)
@@ -317,6 +339,8 @@ xm_allocator_deallocate(xm_allocator_t *allocator, uint64_t data_ptr)
 		start = offset / XM_PAGE_SIZE;
 		for (i = 0; i < npages; i++)
 			bitmap_clear(allocator->pages, start + i);
+		if (start < allocator->first_free)
+			allocator->first_free = start;
 	} else {
 		free((void *)data_ptr);
 	}
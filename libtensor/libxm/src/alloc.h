@@ -54,7 +54,8 @@ uint64_t xm_allocator_allocate(xm_allocator_t *allocator,
     size_t size_bytes);
 
 /** Read data from the \p data_ptr into memory. The size argument must match
- *  the size of the corresponding allocation.
+ *  the size of the corresponding allocation. Reads and writes of different
+ *  allocations can proceed concurrently from several threads.
  *  \param allocator An allocator.
  *  \param data_ptr Data pointer.
  *  \param mem Pointer to memory.
@@ -71,6 +72,16 @@ void xm_allocator_read(xm_allocator_t *allocator, uint64_t data_ptr,
 void xm_allocator_write(xm_allocator_t *allocator, uint64_t data_ptr,
     const void *mem, size_t size_bytes);
 
+/** Hint that data at the \p data_ptr will be read soon. For disk-backed
+ *  allocators the operating system starts reading the data in the
+ *  background; the call returns immediately and has no effect for
+ *  allocators backed by RAM.
+ *  \param allocator An allocator.
+ *  \param data_ptr Data pointer.
+ *  \param size_bytes Size of data in bytes. */
+void xm_allocator_prefetch(xm_allocator_t *allocator, uint64_t data_ptr,
+    size_t size_bytes);
+
 /** Deallocate data pointed to by the \p data_ptr.
  *  \param allocator An allocator.
  *  \param data_ptr Virtual pointer to deallocate. */
@@ -24,6 +24,9 @@
 #include "xm.h"
 #include "util.h"
 
+/* Number of block pairs read ahead of the one being computed. */
+#define XM_READAHEAD 4
+
 struct blockpair {
 	xm_dim_t blkidxa, blkidxb;
 	xm_scalar_t alpha;
@@ -190,30 +193,44 @@ compute_block(xm_scalar_t alpha, const xm_tensor_t *a, const xm_tensor_t *b,
 			}
 		}
 	}
+	/* Compact the schedule to the pairs that are computed and read their
+	 * blocks ahead while the current pair is multiplied. */
+	for (i = 0, j = 0; i < nblkk; i++)
+		if (pairs[i].alpha != 0)
+			pairs[j++] = pairs[i];
+	nblkk = j;
+	for (i = 0; i < nblkk && i < XM_READAHEAD; i++) {
+		xm_tensor_prefetch_block(a, pairs[i].blkidxa);
+		xm_tensor_prefetch_block(b, pairs[i].blkidxb);
+	}
 	for (i = 0; i < nblkk; i++) {
-		if (pairs[i].alpha != 0) {
-			blkidxa = pairs[i].blkidxa;
-			blkidxb = pairs[i].blkidxb;
-			dims = xm_tensor_get_block_dims(a, blkidxa);
-			k = xm_dim_dot_mask(&dims, &cidxa);
+		if (i + XM_READAHEAD < nblkk) {
+			xm_tensor_prefetch_block(a,
+			    pairs[i + XM_READAHEAD].blkidxa);
+			xm_tensor_prefetch_block(b,
+			    pairs[i + XM_READAHEAD].blkidxb);
+		}
+		blkidxa = pairs[i].blkidxa;
+		blkidxb = pairs[i].blkidxb;
+		dims = xm_tensor_get_block_dims(a, blkidxa);
+		k = xm_dim_dot_mask(&dims, &cidxa);
 
-			xm_tensor_read_block(a, blkidxa, bufa1);
-			xm_tensor_unfold_block(a, blkidxa, cidxa,
-			    aidxa, bufa1, bufa2, k);
-			xm_tensor_read_block(b, blkidxb, bufb1);
-			xm_tensor_unfold_block(b, blkidxb, cidxb,
-			    aidxb, bufb1, bufb2, k);
+		xm_tensor_read_block(a, blkidxa, bufa1);
+		xm_tensor_unfold_block(a, blkidxa, cidxa,
+		    aidxa, bufa1, bufa2, k);
+		xm_tensor_read_block(b, blkidxb, bufb1);
+		xm_tensor_unfold_block(b, blkidxb, cidxb,
+		    aidxb, bufb1, bufb2, k);
 
-			al = xm_scalar_mul(alpha, pairs[i].alpha, type);
-			if (aidxc.n > 0 && aidxc.i[0] == 0) {
-				xgemm('T', 'N', (int)n, (int)m, (int)k, al,
-				    bufb2, (int)k, bufa2, (int)k, 1, bufc1,
-				    (int)n, type);
-			} else {
-				xgemm('T', 'N', (int)m, (int)n, (int)k, al,
-				    bufa2, (int)k, bufb2, (int)k, 1, bufc1,
-				    (int)m, type);
-			}
+		al = xm_scalar_mul(alpha, pairs[i].alpha, type);
+		if (aidxc.n > 0 && aidxc.i[0] == 0) {
+			xgemm('T', 'N', (int)n, (int)m, (int)k, al,
+			    bufb2, (int)k, bufa2, (int)k, 1, bufc1,
+			    (int)n, type);
+		} else {
+			xgemm('T', 'N', (int)m, (int)n, (int)k, al,
+			    bufa2, (int)k, bufb2, (int)k, 1, bufc1,
+			    (int)m, type);
 		}
 	}
 done:
@@ -350,6 +350,19 @@ xm_tensor_read_block(const xm_tensor_t *tensor, xm_dim_t blkidx, void *buf)
 	xm_allocator_read(tensor->allocator, data_ptr, buf, blkbytes);
 }
 
+void
+xm_tensor_prefetch_block(const xm_tensor_t *tensor, xm_dim_t blkidx)
+{
+	size_t blkbytes;
+	uint64_t data_ptr;
+
+	if (xm_tensor_get_block_type(tensor, blkidx) == XM_BLOCK_TYPE_ZERO)
+		return;
+	blkbytes = xm_tensor_get_block_bytes(tensor, blkidx);
+	data_ptr = xm_tensor_get_block_data_ptr(tensor, blkidx);
+	xm_allocator_prefetch(tensor->allocator, data_ptr, blkbytes);
+}
+
 void
 xm_tensor_write_block(xm_tensor_t *tensor, xm_dim_t blkidx, const void *buf)
 {
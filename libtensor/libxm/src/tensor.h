@@ -211,6 +211,13 @@ void xm_tensor_get_canonical_block_list(const xm_tensor_t *tensor,
 void xm_tensor_read_block(const xm_tensor_t *tensor, xm_dim_t blkidx,
     void *buf);
 
+/** Start reading tensor block data in the background so that a following
+ *  ::xm_tensor_read_block of the same block does not wait for the disk.
+ *  Zero-blocks are ignored.
+ *  \param tensor Input tensor.
+ *  \param blkidx Index of the block. */
+void xm_tensor_prefetch_block(const xm_tensor_t *tensor, xm_dim_t blkidx);
+
 /** Write tensor block data from memory buffer.
  *  \param tensor Input tensor.
  *  \param blkidx Index of the block.
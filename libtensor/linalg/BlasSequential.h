@@ -8,5 +8,17 @@ struct BlasSequential {
   int blas_num_threads;
 };
 
-}  // namespace libtensor
+/** Sets the number of threads used by BLAS for the lifetime of the object
+    and restores the previous number afterwards. The setting is global to
+    the process (OpenBLAS, MKL); without a threaded BLAS this is a no-op.
+ **/
+struct BlasThreads {
+  explicit BlasThreads(int num_threads);
+  ~BlasThreads();
+  int blas_num_threads;
 
+  /** Returns the number of threads currently used by BLAS **/
+  static int get_num_threads();
+};
+
+}  // namespace libtensor
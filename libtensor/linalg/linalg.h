@@ -50,6 +50,8 @@ using linalg_cblas_level3::mul2_ij_ip_jp_x;
 using linalg_cblas_level3::mul2_ij_ip_pj_x;
 using linalg_cblas_level3::mul2_ij_pi_jp_x;
 using linalg_cblas_level3::mul2_ij_pi_pj_x;
+using linalg_cblas_level3::mul2_ij_batch_x;
+using linalg_cblas_level3::mul2_ij_x;
 
 };
 
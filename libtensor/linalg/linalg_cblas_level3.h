@@ -29,6 +29,17 @@ class linalg_cblas_level3 : public linalg_generic_level3 {
   static void mul2_ij_pi_pj_x(void*, size_t ni, size_t nj, size_t np, const double* a,
                               size_t spa, const double* b, size_t spb, double* c,
                               size_t sic, double d);
+
+  static void mul2_ij_batch_x(void*, bool tra, bool trb, size_t ni, size_t nj,
+                              size_t np, const double* const* a, size_t sa,
+                              const double* const* b, size_t sb, double* const* c,
+                              size_t sic, double d, size_t n);
+
+  static void mul2_ij_x(void*, bool tra, bool trb, size_t ni, size_t nj,
+                        size_t np, const std::complex<double>* a, size_t sa,
+                        const std::complex<double>* b, size_t sb,
+                        std::complex<double>* c, size_t sic,
+                        const std::complex<double>& d);
 };
 
 }  // namespace libtensor
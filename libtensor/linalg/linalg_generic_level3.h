@@ -1,6 +1,7 @@
 #ifndef LIBTENSOR_LINALG_GENERIC_LEVEL3_H
 #define LIBTENSOR_LINALG_GENERIC_LEVEL3_H
 
+#include <complex>
 #include <cstdlib>  // for size_t
 
 namespace libtensor {
@@ -99,6 +100,50 @@ class linalg_generic_level3 {
   static void mul2_ij_pi_pj_x(void* ctx, size_t ni, size_t nj, size_t np, const double* a,
                               size_t spa, const double* b, size_t spb, double* c,
                               size_t sic, double d);
+
+  /** \brief Batch of \f$ c_{ij} = c_{ij} + \sum_p a_{ip} b_{jp} d \f$
+          with the same shape
+      \param ctx Context of computational device (unused for CPUs).
+      \param tra A is stored as a_{pi} instead of a_{ip}.
+      \param trb B is stored as b_{pj} instead of b_{jp}.
+      \param ni Number of elements i.
+      \param nj Number of elements j.
+      \param np Number of elements p.
+      \param a Pointers to a.
+      \param sa Leading step in a (of i, or of p if tra).
+      \param b Pointers to b.
+      \param sb Leading step in b (of j, or of p if trb).
+      \param c Pointers to c.
+      \param sic Step of i in c (sic >= nj).
+      \param d Scalar d.
+      \param n Number of products in the batch.
+   **/
+  static void mul2_ij_batch_x(void* ctx, bool tra, bool trb, size_t ni, size_t nj,
+                              size_t np, const double* const* a, size_t sa,
+                              const double* const* b, size_t sb, double* const* c,
+                              size_t sic, double d, size_t n);
+
+  /** \brief \f$ c_{ij} = c_{ij} + \sum_p a_{ip} b_{jp} d \f$ for complex
+          numbers (no conjugation)
+      \param ctx Context of computational device (unused for CPUs).
+      \param tra A is stored as a_{pi} instead of a_{ip}.
+      \param trb B is stored as b_{pj} instead of b_{jp}.
+      \param ni Number of elements i.
+      \param nj Number of elements j.
+      \param np Number of elements p.
+      \param a Pointer to a.
+      \param sa Leading step in a (of i, or of p if tra).
+      \param b Pointer to b.
+      \param sb Leading step in b (of j, or of p if trb).
+      \param c Pointer to c.
+      \param sic Step of i in c (sic >= nj).
+      \param d Scalar d.
+   **/
+  static void mul2_ij_x(void* ctx, bool tra, bool trb, size_t ni, size_t nj,
+                        size_t np, const std::complex<double>* a, size_t sa,
+                        const std::complex<double>* b, size_t sb,
+                        std::complex<double>* c, size_t sic,
+                        const std::complex<double>& d);
 };
 
 }  // namespace libtensor
@@ -0,0 +1,107 @@
+#ifndef LIBTENSOR_ER_BITSET_H
+#define LIBTENSOR_ER_BITSET_H
+
+#include <atomic>
+#include <vector>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/sequence.h>
+#include "../evaluation_rule.h"
+
+
+namespace libtensor {
+
+
+/** \brief Evaluation rule compiled into bit operations
+
+    Evaluating an evaluation rule for a block with se_label requires walking
+    the products and terms of the rule and asking the product table through
+    product_table_i::is_in_product for each term. This class does that work
+    once: products of label sets are precomputed as bit masks from
+    the product table, so that the product of the labels of a term is
+    a few OR operations and the intrinsic label is a single bit test.
+
+    Once the rule has been evaluated for as many label combinations as
+    a fraction of all the combinations of the labels in the dimensions used
+    by the rule, the outcome for every combination is stored as a bitset
+    (if it has at most 2^16 bits), which turns later evaluations into one
+    bit lookup. The invalid label is part of the combinations.
+
+    Product tables with more than 64 labels, or rules with intrinsic labels
+    outside the table, are not compiled (is_compiled() returns false), and
+    the rule needs to be evaluated the usual way.
+
+    The evaluation is thread-safe. The object does not depend on the product
+    table after construction.
+
+    \sa se_label
+
+    \ingroup libtensor_symmetry
+ **/
+template<size_t N>
+class er_bitset : public noncopyable {
+public:
+    static const char *k_clazz; //!< Class name
+
+public:
+    typedef product_table_i::label_t label_t;
+    typedef unsigned long long mask_t; //!< Bit mask of labels
+
+private:
+    struct term {
+        sequence<N, size_t> seq; //!< Sequence
+        label_t intr; //!< Intrinsic label
+    };
+
+private:
+    bool m_compiled; //!< Whether the rule was compiled
+    size_t m_nl; //!< Number of labels
+    std::vector<mask_t> m_pt; //!< Products of pairs of labels as masks
+    std::vector<term> m_terms; //!< Terms of all products
+    std::vector<size_t> m_prod; //!< Beginning of each product in m_terms
+    sequence<N, size_t> m_stride; //!< Strides in bitset (zero if unused)
+    size_t m_nbits; //!< Size of bitset (zero if too large)
+    mutable std::atomic<size_t> m_neval; //!< Number of evaluations so far
+    mutable std::atomic<const std::vector<mask_t>*> m_bits; //!< Bitset
+
+public:
+    /** \brief Compiles an evaluation rule
+        \param rule Evaluation rule.
+        \param pt Product table.
+     **/
+    er_bitset(const evaluation_rule<N> &rule, const product_table_i &pt);
+
+    /** \brief Destructor
+     **/
+    ~er_bitset();
+
+    /** \brief Returns true if the rule was compiled
+     **/
+    bool is_compiled() const {
+        return m_compiled;
+    }
+
+    /** \brief Returns the number of labels in the product table
+     **/
+    size_t get_n_labels() const {
+        return m_nl;
+    }
+
+    /** \brief Returns true if a block with the given labels is allowed
+        \param lab Labels of block along each dimension, either valid
+            labels or product_table_i::k_invalid.
+
+        Must only be called if the rule was compiled.
+     **/
+    bool is_allowed(const sequence<N, label_t> &lab) const;
+
+private:
+    bool evaluate(const sequence<N, label_t> &lab) const;
+    const std::vector<mask_t> *make_bits() const;
+
+};
+
+
+} // namespace libtensor
+
+
+#endif // LIBTENSOR_ER_BITSET_H
@@ -0,0 +1,188 @@
+#ifndef LIBTENSOR_ER_BITSET_IMPL_H
+#define LIBTENSOR_ER_BITSET_IMPL_H
+
+namespace libtensor {
+
+
+template<size_t N>
+const char *er_bitset<N>::k_clazz = "er_bitset<N>";
+
+
+template<size_t N>
+er_bitset<N>::er_bitset(const evaluation_rule<N> &rule,
+    const product_table_i &pt) :
+
+    m_compiled(false), m_nl(pt.get_n_labels()), m_stride(0), m_nbits(0),
+    m_neval(0), m_bits(0) {
+
+    if(m_nl == 0 || m_nl > 64) return;
+
+    // Flatten the rule
+    for(typename evaluation_rule<N>::iterator it = rule.begin();
+        it != rule.end(); ++it) {
+
+        const product_rule<N> &pr = rule.get_product(it);
+        m_prod.push_back(m_terms.size());
+        for(typename product_rule<N>::iterator ip = pr.begin();
+            ip != pr.end(); ++ip) {
+
+            term t;
+            t.seq = pr.get_sequence(ip);
+            t.intr = pr.get_intrinsic(ip);
+            if(t.intr != product_table_i::k_invalid && t.intr >= m_nl) {
+                m_terms.clear();
+                m_prod.clear();
+                return;
+            }
+            m_terms.push_back(t);
+        }
+    }
+    m_prod.push_back(m_terms.size());
+
+    // Products of pairs of labels
+    m_pt.resize(m_nl * m_nl, 0);
+    product_table_i::label_group_t lg(2);
+    product_table_i::label_set_t ls;
+    for(label_t l1 = 0; l1 < m_nl; l1++) {
+        lg[0] = l1;
+        for(label_t l2 = 0; l2 < m_nl; l2++) {
+            lg[1] = l2;
+            ls.clear();
+            pt.product(lg, ls);
+            mask_t m = 0;
+            for(product_table_i::label_set_t::const_iterator il = ls.begin();
+                il != ls.end(); ++il) {
+                if(*il < m_nl) m |= mask_t(1) << *il;
+            }
+            m_pt[l1 * m_nl + l2] = m;
+        }
+    }
+
+    // Layout of the bitset: dimensions used by the rule, the invalid label
+    // is stored as m_nl
+    const size_t max_bits = 1 << 16;
+    size_t nbits = 1;
+    for(size_t i = 0; i < N && nbits <= max_bits; i++) {
+        bool used = false;
+        for(size_t j = 0; j < m_terms.size() && !used; j++) {
+            used = m_terms[j].intr != product_table_i::k_invalid &&
+                m_terms[j].seq[i] != 0;
+        }
+        if(!used) continue;
+        m_stride[i] = nbits;
+        nbits *= m_nl + 1;
+    }
+    if(nbits <= max_bits) m_nbits = nbits;
+
+    m_compiled = true;
+}
+
+
+template<size_t N>
+er_bitset<N>::~er_bitset() {
+
+    delete m_bits.load();
+}
+
+
+template<size_t N>
+bool er_bitset<N>::is_allowed(const sequence<N, label_t> &lab) const {
+
+    const std::vector<mask_t> *bits = m_bits.load(std::memory_order_acquire);
+    if(bits == 0) {
+        // Tabulate only rules that are evaluated often enough
+        if(m_nbits == 0 ||
+            m_neval.fetch_add(1, std::memory_order_relaxed) < m_nbits / 16) {
+            return evaluate(lab);
+        }
+        bits = make_bits();
+    }
+
+    size_t code = 0;
+    for(size_t i = 0; i < N; i++) {
+        if(m_stride[i] == 0) continue;
+        code += m_stride[i] *
+            (lab[i] == product_table_i::k_invalid ? m_nl : lab[i]);
+    }
+    return ((*bits)[code / 64] >> (code % 64)) & 1;
+}
+
+
+template<size_t N>
+bool er_bitset<N>::evaluate(const sequence<N, label_t> &lab) const {
+
+    // Same logic as se_label<N, T>::is_allowed()
+
+    for(size_t ipr = 0; ipr + 1 < m_prod.size(); ipr++) {
+
+        size_t ib = m_prod[ipr], ie = m_prod[ipr + 1];
+        if(ib == ie) return false;
+
+        size_t it = ib;
+        for(; it < ie; it++) {
+
+            const term &t = m_terms[it];
+            if(t.intr == product_table_i::k_invalid) continue;
+
+            // Product of labels as mask, empty if no labels
+            mask_t prod = 0;
+            bool first = true;
+            size_t i = 0;
+            for(; i < N; i++) {
+                if(t.seq[i] == 0) continue;
+                label_t l = lab[i];
+                if(l == product_table_i::k_invalid) break;
+                for(size_t k = 0; k < t.seq[i]; k++) {
+                    if(first) {
+                        prod = mask_t(1) << l;
+                        first = false;
+                        continue;
+                    }
+                    mask_t prod2 = 0;
+                    for(size_t b = 0; prod != 0; b++, prod >>= 1) {
+                        if(prod & 1) prod2 |= m_pt[b * m_nl + l];
+                    }
+                    prod = prod2;
+                }
+            }
+            if(i != N) continue;
+
+            if(((prod >> t.intr) & 1) == 0) break;
+        }
+
+        if(it == ie) return true;
+    }
+
+    return false;
+}
+
+
+template<size_t N>
+const std::vector<typename er_bitset<N>::mask_t> *
+er_bitset<N>::make_bits() const {
+
+    std::vector<mask_t> *bits = new std::vector<mask_t>(m_nbits / 64 + 1, 0);
+
+    sequence<N, label_t> lab(product_table_i::k_invalid);
+    for(size_t code = 0; code < m_nbits; code++) {
+        for(size_t i = 0; i < N; i++) {
+            if(m_stride[i] == 0) continue;
+            label_t l = (code / m_stride[i]) % (m_nl + 1);
+            lab[i] = (l == m_nl) ? product_table_i::k_invalid : l;
+        }
+        if(evaluate(lab)) (*bits)[code / 64] |= mask_t(1) << (code % 64);
+    }
+
+    // Another thread may have been faster
+    const std::vector<mask_t> *expected = 0;
+    if(!m_bits.compare_exchange_strong(expected, bits)) {
+        delete bits;
+        return expected;
+    }
+    return bits;
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_ER_BITSET_IMPL_H
@@ -47,6 +47,7 @@ template<size_t N, typename T>
 void se_label<N, T>::set_rule(const label_set_t &intr) {
 
     m_rule.clear();
+    reset_bitset();
     if (intr.empty()) return;
 
     sequence<N, size_t> seq(1);
@@ -67,12 +68,48 @@ void se_label<N, T>::permute(const permutation<N> &p) {
     for (size_t i = 0; i < sl.size(); i++) {
         p.apply(sl[i]);
     }
+    reset_bitset();
 }
 
 
 template<size_t N, typename T>
 bool se_label<N, T>::is_allowed(const index<N> &idx) const {
 
+    const er_bitset<N> &bs = req_bitset();
+    if(!bs.is_compiled()) return is_allowed_rule(idx);
+
+    sequence<N, label_t> lab;
+    for(size_t i = 0; i < N; i++) {
+        label_t l = m_blk_labels.get_label(m_blk_labels.get_dim_type(i),
+            idx[i]);
+        if(l != product_table_i::k_invalid && l >= bs.get_n_labels()) {
+            return is_allowed_rule(idx);
+        }
+        lab[i] = l;
+    }
+    return bs.is_allowed(lab);
+}
+
+
+template<size_t N, typename T>
+const er_bitset<N> &se_label<N, T>::req_bitset() const {
+
+    er_bitset<N> *bs = m_bitset.load(std::memory_order_acquire);
+    if(bs != 0) return *bs;
+
+    er_bitset<N> *bs1 = new er_bitset<N>(m_rule, m_pt);
+    if(!m_bitset.compare_exchange_strong(bs, bs1)) {
+        // Another thread was faster
+        delete bs1;
+        return *bs;
+    }
+    return *bs1;
+}
+
+
+template<size_t N, typename T>
+bool se_label<N, T>::is_allowed_rule(const index<N> &idx) const {
+
     product_table_i::label_group_t &lg = se_label_buffer::get_lg();
 
     // Loop over all products in the evaluation rule
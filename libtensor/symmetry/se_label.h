@@ -1,10 +1,12 @@
 #ifndef LIBTENSOR_SE_LABEL_H
 #define LIBTENSOR_SE_LABEL_H
 
+#include <atomic>
 #include <libtensor/core/symmetry_element_i.h>
 #include "block_labeling.h"
 #include "evaluation_rule.h"
 #include "product_table_container.h"
+#include "inst/er_bitset.h"
 
 namespace libtensor {
 
@@ -29,7 +31,9 @@ namespace libtensor {
 
     The evaluation rule determines allowed blocks from the product table and
     the sequence of labels of a given block. For details please refer to the
-    documentation of \sa evaluation_rule.
+    documentation of \sa evaluation_rule. On first use the rule is compiled
+    into bit operations (\sa er_bitset), which is then used to check blocks
+    until the rule is changed.
 
     \ingroup libtensor_symmetry
  **/
@@ -47,6 +51,7 @@ private:
     evaluation_rule<N> m_rule; //!< Label evaluation rule
 
     const product_table_i &m_pt; //!< Product table
+    mutable std::atomic<er_bitset<N>*> m_bitset; //!< Compiled rule
 
 public:
     //! \name Construction and destruction
@@ -56,8 +61,9 @@ public:
         \param id Table ID
      **/
     se_label(const dimensions<N> &bidims, const std::string &id) :
-        m_blk_labels(bidims), 
-        m_pt(product_table_container::get_instance().req_const_table(id)) {
+        m_blk_labels(bidims),
+        m_pt(product_table_container::get_instance().req_const_table(id)),
+        m_bitset(0) {
     }
 
 
@@ -66,13 +72,15 @@ public:
     se_label(const se_label<N, T> &elem) :
         m_blk_labels(elem.m_blk_labels), m_rule(elem.m_rule),
         m_pt(product_table_container::get_instance().req_const_table(
-                elem.m_pt.get_id())) {
+                elem.m_pt.get_id())),
+        m_bitset(0) {
     }
 
 
     /** \brief Virtual destructor
      **/
     virtual ~se_label() {
+        delete m_bitset.load();
         product_table_container::get_instance().ret_table(m_pt.get_id());
     }
 
@@ -110,7 +118,10 @@ public:
         The function checks the validity of the given rule and replaces any
         previously given rule.
      **/
-    void set_rule(const evaluation_rule<N> &rule) { m_rule = rule; }
+    void set_rule(const evaluation_rule<N> &rule) {
+        m_rule = rule;
+        reset_bitset();
+    }
     //@}
 
     //! \name Access functions
@@ -167,6 +178,21 @@ public:
     virtual void apply(index<N> &idx, tensor_transf<N, T> &tr) const { }
     //@}
 
+private:
+    /** \brief Returns the compiled rule, compiles it if necessary
+     **/
+    const er_bitset<N> &req_bitset() const;
+
+    /** \brief Discards the compiled rule after the rule has changed
+     **/
+    void reset_bitset() {
+        delete m_bitset.exchange(0);
+    }
+
+    /** \brief Evaluates the rule for a block without the compiled rule
+     **/
+    bool is_allowed_rule(const index<N> &idx) const;
+
 };
 
 
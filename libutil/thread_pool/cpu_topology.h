@@ -0,0 +1,89 @@
+#ifndef LIBUTIL_CPU_TOPOLOGY_H
+#define LIBUTIL_CPU_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+namespace libutil {
+
+
+/** \brief Placement of logical CPUs on cores, sockets and NUMA nodes
+
+    On Linux the topology is read from sysfs (cpu/online,
+    cpuN/topology/{core_id,physical_package_id} and node/nodeM/cpulist),
+    restricted to the CPUs in the affinity mask of the process. Elsewhere,
+    or if sysfs cannot be read, all online CPUs are placed on one socket
+    and one NUMA node, each CPU on its own core.
+
+    \ingroup libutil_thread_pool
+ **/
+class cpu_topology {
+public:
+    /** \brief Logical CPU
+     **/
+    struct cpu {
+        unsigned id; //!< OS number of the CPU
+        unsigned core; //!< Core number (unique within socket)
+        unsigned package; //!< Socket number
+        unsigned node; //!< NUMA node number
+
+        cpu(unsigned id_ = 0, unsigned core_ = 0, unsigned package_ = 0,
+            unsigned node_ = 0) :
+            id(id_), core(core_), package(package_), node(node_) { }
+    };
+
+private:
+    std::vector<cpu> m_cpus; //!< CPUs sorted by OS number
+
+public:
+    /** \brief Discovers the topology of the machine
+     **/
+    cpu_topology();
+
+    /** \brief Reads the topology from the given sysfs root (e.g. "/sys")
+            without checking the affinity mask of the process
+     **/
+    explicit cpu_topology(const std::string &sysfs);
+
+    /** \brief Creates the topology from a list of CPUs
+     **/
+    explicit cpu_topology(const std::vector<cpu> &cpus);
+
+    /** \brief Returns the number of logical CPUs
+     **/
+    size_t get_ncpus() const {
+        return m_cpus.size();
+    }
+
+    /** \brief Returns the i-th logical CPU (sorted by OS number)
+     **/
+    const cpu &get_cpu(size_t i) const {
+        return m_cpus[i];
+    }
+
+    /** \brief Returns the CPU with the given OS number or 0 if unknown
+     **/
+    const cpu *find_cpu(unsigned id) const;
+
+    /** \brief Returns the number of distinct NUMA nodes
+     **/
+    size_t get_nnodes() const;
+
+    /** \brief Parses a Linux CPU list (e.g. "0-3,8,10-11")
+        \param s CPU list.
+        \param[out] ids Numbers of CPUs in ascending order.
+        \return False if the list is malformed.
+     **/
+    static bool parse_cpu_list(const std::string &s,
+        std::vector<unsigned> &ids);
+
+private:
+    void read_sysfs(const std::string &sysfs, bool use_mask);
+    void make_flat(size_t ncpus);
+
+};
+
+
+} // namespace libutil
+
+#endif // LIBUTIL_CPU_TOPOLOGY_H
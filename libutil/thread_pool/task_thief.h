@@ -12,12 +12,23 @@ namespace libutil {
 
 /** \brief Steals tasks from workers' local queues
 
+    Victims are chosen round robin, first among the queues of workers on
+    the same NUMA node as the thief, then among all other queues.
+
     \ingroup libutil_thread_pool
  **/
 class task_thief {
 private:
-    std::map< std::deque<task_info>*, spinlock* > m_queues; //!< Victims
-    std::map< std::deque<task_info>*, spinlock* >::iterator m_i;
+    struct victim {
+        spinlock *mtx; //!< Lock on the queue
+        unsigned node; //!< NUMA node of the owner
+    };
+
+    typedef std::map< std::deque<task_info>*, victim > victim_map;
+
+private:
+    victim_map m_queues; //!< Victims
+    victim_map::iterator m_i;
     spinlock m_mtx; //!< Lock
 
 public:
@@ -26,16 +37,30 @@ public:
     task_thief();
 
     /** \brief Adds a candidate victim for theft
+        \param lq Local queue.
+        \param lqmtx Lock on the local queue.
+        \param node NUMA node of the owner of the queue.
      **/
-    void register_queue(std::deque<task_info> &lq, spinlock &lqmtx);
+    void register_queue(std::deque<task_info> &lq, spinlock &lqmtx,
+        unsigned node = 0);
 
     /** \brief Removes a queue from the list of candidates
      **/
     void unregister_queue(std::deque<task_info> &lq);
 
     /** \brief Steals a task from one of the victims
+        \param[out] tinfo Stolen task (zero if none).
+        \param node NUMA node of the thief.
+        \param[out] remote Set if the task comes from another NUMA node.
      **/
-    void steal_task(task_info &tinfo);
+    void steal_task(task_info &tinfo, unsigned node, bool &remote);
+
+    /** \brief Steals a task from one of the victims (ignores NUMA nodes)
+     **/
+    void steal_task(task_info &tinfo) {
+        bool remote;
+        steal_task(tinfo, 0, remote);
+    }
 
 };
 
@@ -43,4 +68,3 @@ public:
 } // namespace libutil
 
 #endif // LIBUTIL_TASK_THIEF_H
-
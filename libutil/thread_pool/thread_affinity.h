@@ -0,0 +1,75 @@
+#ifndef LIBUTIL_THREAD_AFFINITY_H
+#define LIBUTIL_THREAD_AFFINITY_H
+
+#include <vector>
+#include "cpu_topology.h"
+
+namespace libutil {
+
+
+/** \brief Policy of pinning worker threads to CPUs
+
+    The policy maps the i-th worker of a thread pool to a logical CPU:
+     - none: workers are not pinned (default).
+     - compact: workers fill all hardware threads of a core, then the cores
+       of a socket, then the next socket (NUMA node).
+     - scatter: workers are spread round-robin over sockets first, then over
+       cores, and take the second hardware thread of a core last.
+     - explicit list: the i-th worker goes to the i-th CPU in the list.
+    If there are more workers than CPUs, the assignment wraps around.
+
+    Pinning requires pthread_setaffinity_np (Linux). Elsewhere the policy
+    only determines the NUMA node of each worker, which is still used to
+    prefer local victims when stealing tasks.
+
+    \sa thread_pool, cpu_topology
+
+    \ingroup libutil_thread_pool
+ **/
+class thread_affinity {
+public:
+    enum policy_type {
+        POLICY_NONE, POLICY_COMPACT, POLICY_SCATTER, POLICY_EXPLICIT
+    };
+
+private:
+    policy_type m_policy; //!< Policy
+    std::vector<unsigned> m_cpus; //!< Explicit list of CPUs
+
+public:
+    /** \brief Creates the default policy (no pinning)
+     **/
+    thread_affinity() : m_policy(POLICY_NONE) { }
+
+    /** \brief Creates a compact or scatter policy
+     **/
+    explicit thread_affinity(policy_type policy);
+
+    /** \brief Creates a policy with an explicit list of CPUs (OS numbers)
+     **/
+    explicit thread_affinity(const std::vector<unsigned> &cpus);
+
+    /** \brief Returns the policy type
+     **/
+    policy_type get_policy() const {
+        return m_policy;
+    }
+
+    /** \brief Returns the CPUs assigned to workers 0, 1, ... in the order
+            given by the policy (empty for no pinning)
+        \param topo CPU topology.
+        \param[out] cpus OS numbers of CPUs.
+     **/
+    void get_cpus(const cpu_topology &topo, std::vector<unsigned> &cpus) const;
+
+    /** \brief Pins the calling thread to a CPU
+        \return False if pinning is not supported or failed.
+     **/
+    static bool pin_current_thread(unsigned cpu);
+
+};
+
+
+} // namespace libutil
+
+#endif // LIBUTIL_THREAD_AFFINITY_H
@@ -10,6 +10,7 @@
 #include "task_observer_i.h"
 #include "task_source.h"
 #include "task_thief.h"
+#include "thread_affinity.h"
 #include "worker.h"
 
 namespace libutil {
@@ -17,6 +18,11 @@ namespace libutil {
 
 /** \brief Thread pool
 
+    Worker threads may be pinned to CPUs according to a thread_affinity
+    policy. Pinned workers steal tasks from workers on the same NUMA node
+    before they turn to other nodes. Per-worker statistics (tasks executed,
+    tasks stolen, idle time) are available via get_worker_stats().
+
     \ingroup libutil_thread_pool
  **/
 class thread_pool {
@@ -51,6 +57,9 @@ private:
     task_source *m_tsroot; //!< Root task source
     std::map<task_source*, ts_stats> m_tsstat; //!< Task source stats
     task_thief m_thief; //!< Task thief
+    std::vector<unsigned> m_cpus; //!< CPUs for workers (empty if not pinned)
+    std::vector<unsigned> m_nodes; //!< NUMA nodes of m_cpus
+    size_t m_nspawned; //!< Number of workers created so far
     volatile bool m_term; //!< Termination flag
     spinlock m_mtx; //!< Mutex
 
@@ -58,8 +67,10 @@ public:
     /** \brief Creates a thread pool
         \param nthreads Limit on non-idle (running + waiting) threads.
         \param ncpus Limit on number of CPUs (running threads).
+        \param aff Policy of pinning workers to CPUs.
      **/
-    thread_pool(size_t nthreads, size_t ncpus);
+    thread_pool(size_t nthreads, size_t ncpus,
+        const thread_affinity &aff = thread_affinity());
 
     /** \brief Destroys the thread pool
      **/
@@ -79,6 +90,11 @@ public:
      **/
     void dissociate();
 
+    /** \brief Returns the statistics of all workers created so far in
+            the order of creation
+     **/
+    void get_worker_stats(std::vector<worker_stats> &st);
+
     /** \brief Worker's main function (task loop)
         \param w Worker.
      **/
@@ -90,6 +106,11 @@ public:
      **/
     static void submit(task_iterator_i &ti, task_observer_i &to);
 
+    /** \brief Returns the limit on running threads of the thread pool
+            associated with the current thread (zero if there is none)
+     **/
+    static size_t get_ncpus();
+
     /** \brief Allocates a CPU for the current thread (and waits for one
             to become available if necessary)
      **/
@@ -107,7 +128,8 @@ private:
     void do_acquire_cpu(bool intask);
     void do_release_cpu(bool intask);
 
-    void enqueue_local(std::deque<task_info> &lq, size_t maxn, spinlock &lqmtx);
+    void enqueue_local(std::deque<task_info> &lq, size_t maxn, spinlock &lqmtx,
+        worker *w);
 
     void create_idle_thread();
     void activate_idle_thread();
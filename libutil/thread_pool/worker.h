@@ -1,6 +1,7 @@
 #ifndef LIBUTIL_WORKER_H
 #define LIBUTIL_WORKER_H
 
+#include <atomic>
 #include <libutil/threads/cond.h>
 #include <libutil/threads/mutex.h>
 #include <libutil/threads/thread.h>
@@ -11,6 +12,23 @@ namespace libutil {
 class thread_pool;
 
 
+/** \brief Statistics of a worker thread
+
+    \ingroup libutil_thread_pool
+ **/
+struct worker_stats {
+    int cpu; //!< CPU the worker is pinned to (-1 if not pinned)
+    unsigned node; //!< NUMA node of the worker
+    size_t ntasks; //!< Number of tasks executed
+    size_t nsteals; //!< Number of tasks stolen from other workers
+    size_t nsteals_remote; //!< Number of tasks stolen from other NUMA nodes
+    double idle_time; //!< Time spent waiting for work (seconds)
+
+    worker_stats() : cpu(-1), node(0), ntasks(0), nsteals(0),
+        nsteals_remote(0), idle_time(0.0) { }
+};
+
+
 /** \brief Worker thread
 
     \ingroup libutil_thread_pool
@@ -19,13 +37,24 @@ class worker : public thread {
 private:
     thread_pool &m_pool; //!< Thread pool
     cond *m_start_cond; //!< Start conditional
+    int m_cpu; //!< CPU to pin the thread to (-1 for none)
+    unsigned m_node; //!< NUMA node
+    std::atomic<bool> m_pinned; //!< Thread has been pinned to m_cpu
+    std::atomic<size_t> m_ntasks; //!< Number of tasks executed
+    std::atomic<size_t> m_nsteals; //!< Number of stolen tasks
+    std::atomic<size_t> m_nsteals_remote; //!< Number of remote stolen tasks
+    std::atomic<unsigned long long> m_idle_ns; //!< Idle time (ns)
 
 public:
     /** \brief Initializes the worker thread
         \param pool Thread pool to which this worker belongs.
         \param c Thread start conditional.
+        \param cpu CPU to pin the thread to (-1 for none).
+        \param node NUMA node of the thread.
      **/
-    worker(thread_pool &pool, cond *c) : m_pool(pool), m_start_cond(c)
+    worker(thread_pool &pool, cond *c, int cpu = -1, unsigned node = 0) :
+        m_pool(pool), m_start_cond(c), m_cpu(cpu), m_node(node),
+        m_pinned(false), m_ntasks(0), m_nsteals(0), m_nsteals_remote(0), m_idle_ns(0)
     { }
 
     /** \brief Runs the worker thread
@@ -36,10 +65,39 @@ public:
      **/
     void notify_ready();
 
+    /** \brief Returns the NUMA node of the worker
+     **/
+    unsigned get_node() const {
+        return m_node;
+    }
+
+    /** \brief Records one executed task
+     **/
+    void count_task() {
+        m_ntasks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** \brief Records one stolen task
+        \param remote True if the task was stolen from another NUMA node.
+     **/
+    void count_steal(bool remote) {
+        m_nsteals.fetch_add(1, std::memory_order_relaxed);
+        if(remote) m_nsteals_remote.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** \brief Records idle time
+     **/
+    void count_idle(unsigned long long ns) {
+        m_idle_ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    /** \brief Returns the statistics of the worker
+     **/
+    worker_stats get_stats() const;
+
 };
 
 
 } // namespace libutil
 
 #endif // LIBUTIL_WORKER_H
-
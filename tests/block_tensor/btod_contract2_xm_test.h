@@ -73,6 +73,8 @@ private:
     void test_batch_2();
     void test_batch_3();
 
+    void test_mirror_1();
+
 };
 
 